@@ -0,0 +1,183 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+
+#include <HXLibs/container/ThreadPool.hpp>
+
+#include <api/Api.hpp>
+#include <dao/MemoryDAOPool.hpp>
+#include <db/SQLiteBackup.hpp>
+
+#include <config/DbPath.hpp>
+#include <dao/MusicDAO.hpp>
+#include <dao/PlaylistDAO.hpp>
+#include <dao/PlaylistSongDAO.hpp>
+#include <dao/UserDAO.hpp>
+#include <pojo/vo/DbProfileVO.hpp>
+#include <interceptor/TokenInterceptor.hpp>
+#include <utils/Timestamp.hpp>
+
+#include <api/ApiMacro.hpp>
+
+namespace HX {
+
+/**
+ * @brief 管理员 (运维) 相关 API
+ */
+HX_SERVER_API_BEGIN(AdminApi) {
+    auto musicDAO
+        = dao::MemoryDAOPool::get<MusicDAO, config::MusicDbPath>();
+    auto playlistDAO
+        = dao::MemoryDAOPool::get<PlaylistDAO, config::PlaylistDbPath>();
+    auto playlistSongDAO
+        = dao::MemoryDAOPool::get<PlaylistSongDAO, config::PlaylistDbPath>();
+    auto userDAO
+        = dao::MemoryDAOPool::get<UserDAO, config::UserDbPath>();
+    // 备份的每一步与语句统计的收集在此线程中执行, 不占用 IO 线程
+    auto workPool = std::make_shared<container::ThreadPool>();
+    workPool->setFixedThreadNum(1);
+    workPool->run<container::ThreadPool::Model::FixedSizeAndNoCheck>();
+    HX_ENDPOINT_BEGIN
+        // 获取各数据库的语句统计 (调用次数/耗时/p99/扫描步数等)
+        .addEndpoint<GET>("/admin/db/profile", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                // 读取统计需要等待写线程, 在后台线程中收集, 不占用 IO 线程
+                auto vo = co_await workPool->addTask([=] {
+                    auto make = [](std::string name, auto const& src) -> DbProfileVO {
+                        return {
+                            std::move(name),
+                            src->getStmtCacheStats(),
+                            src->getStmtProfile()
+                        };
+                    };
+                    DbProfileListVO vo;
+                    vo.dbList.push_back(make("music", musicDAO));
+                    vo.dbList.push_back(make("playlist", playlistDAO));
+                    vo.dbList.push_back(make("playlistSong", playlistSongDAO));
+                    vo.dbList.push_back(make("user", userDAO));
+                    // 写组内各 DAO 的写操作在写组的连接上执行, 其统计单独列出
+                    if (auto group = dao::MemoryDAOPool::getWriteGroup()) {
+                        vo.dbList.push_back(make("group", group));
+                    }
+                    return vo;
+                }).via(req.getIO());
+                co_await api::setJsonSucceed(std::move(vo), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("获取语句统计失败", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::Administrator>{})
+        // 在线热备份: 等待回写落盘后对 用户/音乐/歌单 数据库各自固定快照 (写组在此期间暂停提交), 并推送进度
+        .addEndpoint<WS>("/admin/db/backup/ws", [=, isRunning = std::make_shared<std::atomic_bool>(false)] ENDPOINT {
+            auto ws = co_await net::WebSocketFactory::accept(req, res);
+            if (isRunning->exchange(true)) {
+                co_await api::sendTextNoTry(ws, "错误: 备份正在进行中, 不要重复开始!");
+                co_return co_await ws.close();
+            }
+            std::string dir = "./file/backup/" + std::to_string(utils::Timestamp::getTimestamp()) + "/";
+            // 先于 taskList 声明: 读快照释放之后才恢复提交
+            std::unique_ptr<dao::WriteGroup::PauseGuard> paused;
+            std::vector<std::unique_ptr<db::SQLiteBackup>> taskList;
+            std::string errMsg;
+            try {
+                // 先等待此前的修改全部落盘 (异步, 不占用 IO 线程). 不持有 DAO 的锁:
+                // 写组的 transaction 推入开始标记后可能正等待 DAO 的锁, 此时同步等待落盘会与之互相等待;
+                // 各备份任务在构造时已各自固定了读快照, 加锁并不能让它们更一致
+                co_await userDAO->flushAsync().via(req.getIO());
+                co_await musicDAO->flushAsync().via(req.getIO());
+                co_await playlistDAO->flushAsync().via(req.getIO());
+                co_await playlistSongDAO->flushAsync().via(req.getIO());
+                // 写组的库以回滚日志模式打开, 固定的读快照会阻塞其提交: 备份期间暂停写组的提交,
+                // 写操作在内存中排队. 暂停需要等待正在进行的提交, 因此在后台线程中进行
+                if (auto group = dao::MemoryDAOPool::getWriteGroup()) {
+                    paused = co_await workPool->addTask([group] {
+                        return group->pause();
+                    }).via(req.getIO());
+                }
+                std::filesystem::create_directories(dir);
+                auto add = [&](std::string_view srcPath, std::string name) {
+                    taskList.push_back(std::make_unique<db::SQLiteBackup>(
+                        std::string{srcPath}, dir + name));
+                };
+                add(meta::ToCharPack<config::UserDbPath>::view(), "user.db");
+                add(meta::ToCharPack<config::MusicDbPath>::view(), "music.db");
+                // 歌单与歌单歌曲位于同一个数据库文件
+                add(meta::ToCharPack<config::PlaylistDbPath>::view(), "playlist.db");
+            } catch (std::exception const& e) {
+                errMsg = e.what();
+                taskList.clear();
+                paused.reset();
+            }
+            if (!errMsg.empty()) [[unlikely]] {
+                co_await api::sendTextNoTry(ws, "错误: 无法开始备份: " + errMsg);
+                isRunning->store(false);
+                co_return co_await ws.close();
+            }
+            co_await api::sendTextNoTry(ws, "任务开始: 快照已固定, 备份到 " + dir);
+            // 每步约 4 MiB (按 4 KiB 每页计)
+            constexpr int PagesPerStep = 1024;
+            for (auto& task : taskList) {
+                int lastPercent = -1;
+                for (;;) {
+                    // 异常在线程池中捕获, 因为 catch 块中不能 co_await
+                    auto [isDone, stepErr] = co_await workPool->addTask([&] {
+                        try {
+                            return std::make_pair(task->step(PagesPerStep), std::string{});
+                        } catch (std::exception const& e) {
+                            return std::make_pair(false, std::string{e.what()});
+                        }
+                    }).via(req.getIO());
+                    if (!stepErr.empty()) [[unlikely]] {
+                        errMsg = task->getDstPath() + " 备份失败: " + stepErr;
+                        break;
+                    }
+                    auto [remaining, pageCnt] = task->getProgress();
+                    int percent = pageCnt > 0 ? (pageCnt - remaining) * 100 / pageCnt : 100;
+                    if (percent != lastPercent || isDone) {
+                        lastPercent = percent;
+                        co_await api::sendTextNoTry(ws,
+                            task->getDstPath() + ": " + std::to_string(pageCnt - remaining)
+                            + "/" + std::to_string(pageCnt) + " 页 (" + std::to_string(percent) + "%)");
+                    }
+                    if (isDone) {
+                        break;
+                    }
+                }
+                if (!errMsg.empty()) [[unlikely]] {
+                    break;
+                }
+            }
+            // 未完成的任务在析构时会删除其临时文件
+            taskList.clear();
+            paused.reset();
+            co_await api::sendTextNoTry(ws, errMsg.empty()
+                ? "任务结束: 备份完成"
+                : "任务结束: 备份失败: " + errMsg);
+            isRunning->store(false);
+            co_await ws.close();
+        }, TokenInterceptor<PermissionEnum::Administrator>{})
+    HX_ENDPOINT_END;
+} HX_SERVER_API_END;
+
+} // namespace HX
+
+#include <api/UnApiMacro.hpp>
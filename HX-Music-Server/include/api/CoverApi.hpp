@@ -43,7 +43,7 @@ HX_SERVER_API_BEGIN(CoverApi) {
                 reflection::fromJson(id, idStrView);
                 co_await res.useRangeTransferFile(
                     req.getRangeRequestView(),
-                    "./file/cover/" + std::to_string(id) + musicDAO->at(id).coverSuffix
+                    "./file/cover/" + std::to_string(id) + musicDAO->project<&MusicDO::coverSuffix>(id)
                 );
             }, [&] CO_FUNC {
                 co_await api::setJsonError("歌曲id不存在 或者 路径错误", res).sendRes();
@@ -63,7 +63,7 @@ HX_SERVER_API_BEGIN(LyricsApi) {
                 WsLyricsMsgVO<> msgVO;
                 co_await ws.recvJson(msgVO);
                 // 爬取歌词
-                const auto musicPath = musicDAO->at(msgVO.musicId, &MusicDO::path);
+                const auto musicPath = musicDAO->project<&MusicDO::path>(msgVO.musicId).str();
                 fs::path assPath {
                     std::filesystem::current_path()
                     / "file/lyrics/ass"
@@ -161,7 +161,7 @@ HX_SERVER_API_BEGIN(LyricsApi) {
                 std::vector<IdAndPath> path;
                 path.reserve(mp.size());
                 for (auto const& [_, v] : mp) {
-                    path.emplace_back(v.id, v.path);
+                    path.emplace_back(v.id, v.path.str());
                 }
                 return path;
             });
@@ -18,6 +18,8 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <span>
+
 #include <api/Api.hpp>
 #include <dao/MemoryDAOPool.hpp>
 
@@ -29,7 +31,13 @@
 #include <pojo/vo/MusicVO.hpp>
 #include <pojo/vo/InitUploadFileTaskVO.hpp>
 #include <pojo/vo/SelectDataVO.hpp>
+#include <pojo/vo/IdListVO.hpp>
+#include <pojo/vo/SearchVO.hpp>
+#include <pojo/vo/SuggestListVO.hpp>
+#include <pojo/vo/GroupSelectVO.hpp>
+#include <pojo/vo/MusicGroupListVO.hpp>
 #include <pojo/vo/SongListVO.hpp>
+#include <pojo/vo/ChangeListVO.hpp>
 #include <interceptor/TokenInterceptor.hpp>
 #include <pybind/ToKaRaOKAss.hpp>
 #include <utils/DirFor.hpp>
@@ -87,6 +95,103 @@ HX_SERVER_API_BEGIN(MusicApi) {
         }
         co_return dao.id;
     };
+
+    /**
+     * @brief 批量扫描音乐信息, 并且在同一个事务中保存到数据库.
+     */
+    auto saveMusicInfoMany = [=](
+        std::vector<std::string> pathList,      // 相对于 ./file/music 的路径
+        coroutine::EventLoop& loop              // 事件循环
+    ) -> coroutine::Task<std::vector<uint64_t>> {
+        std::vector<MusicDO> doList;
+        std::vector<std::optional<MusicInfo::ImgRamFile>> imgList;
+        doList.reserve(pathList.size());
+        imgList.reserve(pathList.size());
+        for (auto& path : pathList) {
+            MusicInfo info{std::filesystem::path{"./file/music"} / path};
+            auto& imgOpt = imgList.emplace_back(info.getAlbumArtAdvanced());
+            log::hxLog.info("新增歌曲:", path);
+            doList.push_back({
+                {},
+                std::move(path),
+                info.getTitle(),
+                info.getArtistList(),
+                info.getAlbum(),
+                static_cast<uint64_t>(info.getLengthInMilliseconds()),
+                imgOpt ? imgOpt->type : ""
+            });
+        }
+        auto ids = musicDAO->addMany(std::move(doList));
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            if (auto& imgOpt = imgList[i]) {
+                utils::AsyncFile file{loop};
+                co_await file.open(
+                    "./file/cover/" + std::to_string(ids[i]) + std::move(imgOpt->type)
+                );
+                co_await file.write(imgOpt->buf);
+                co_await file.close();
+            }
+        }
+        co_return ids;
+    };
+    /**
+     * @brief 以分组索引分页列出歌手 / 专辑
+     */
+    auto selectGroups = [=] <auto Ptr> (GroupSelectVO const& vo) {
+        MusicGroupListVO resVO;
+        for (auto& group : musicDAO->selectGroups<Ptr>(vo.after, vo.maxCnt)) {
+            resVO.groupList.push_back({std::move(group.key), group.cnt, group.sum});
+        }
+        return resVO;
+    };
+
+    /**
+     * @brief 按 ids 的顺序读取歌曲, 只读取这些行; 不存在的 (如取得主键后已被删除) 跳过
+     */
+    auto makeSongList = [=](std::span<uint64_t const> ids) {
+        SongListVO resVO;
+        resVO.songList.reserve(ids.size());
+        musicDAO->atMany(ids, [&](MusicDO const& musicDO) {
+            resVO.songList.emplace_back<MusicVO>({
+                musicDO.id,
+                musicDO.path.str(),
+                musicDO.musicName,
+                musicDO.singers.toStrings(),
+                musicDO.musicAlbum.str(),
+                musicDO.millisecondsLen
+            });
+        });
+        return resVO;
+    };
+
+    /**
+     * @brief 以分组索引分页列出歌手 / 专辑的歌曲
+     */
+    auto selectGroupSongs = [=] <auto Ptr> (GroupMusicSelectVO const& vo) {
+        return makeSongList(musicDAO->selectGroupIds<Ptr>(vo.name, vo.beginId, vo.maxCnt));
+    };
+
+    /**
+     * @brief 以排序索引分页查找歌曲
+     */
+    auto selectSortedSongs = [=](SelectDataVO const& vo) {
+        auto select = [&] <auto Ptr> (bool isDesc) {
+            return makeSongList(musicDAO->selectSorted<Ptr>(
+                vo.beginId, vo.offset, vo.maxCnt, isDesc, vo.beginKey));
+        };
+        if (vo.sortBy.empty() || vo.sortBy == "id") {
+            return select.template operator()<&MusicDO::id>(vo.isDesc);
+        } else if (vo.sortBy == "recent") {
+            return select.template operator()<&MusicDO::id>(!vo.isDesc);
+        } else if (vo.sortBy == "title") {
+            return select.template operator()<&MusicDO::musicName>(vo.isDesc);
+        } else if (vo.sortBy == "artist") {
+            return select.template operator()<&MusicDO::singers>(vo.isDesc);
+        } else if (vo.sortBy == "duration") {
+            return select.template operator()<&MusicDO::millisecondsLen>(vo.isDesc);
+        }
+        throw std::runtime_error{"unknown sortBy: " + vo.sortBy};
+    };
     auto musicUploadTaskMap
         = std::make_shared<utils::ThreadSafeMap<
             std::string, MusicFileTask>>();
@@ -100,7 +205,7 @@ HX_SERVER_API_BEGIN(MusicApi) {
                 reflection::fromJson(id, idStrView);
                 co_await res.useRangeTransferFile(
                      req.getRangeRequestView(),
-                     "./file/music/"s += musicDAO->at(id).path
+                     "./file/music/"s += musicDAO->project<&MusicDO::path>(id).str()
                 );
             }, [&] CO_FUNC {
                 co_await api::setJsonError("歌曲id不存在", res).sendRes();
@@ -109,22 +214,36 @@ HX_SERVER_API_BEGIN(MusicApi) {
         // 扫描服务端音乐
         .addEndpoint<WS>("/music/runScan/ws", [=] ENDPOINT {
             auto ws = co_await net::WebSocketFactory::accept(req, res);
+            // 每批次在同一个事务中提交; 批次不宜过大, 因为封面会暂存在内存中
+            constexpr std::size_t ScanBatchSize = 64;
             std::size_t cnt = 0;
+            std::vector<std::string> pathList;
+            auto flush = [&]() -> coroutine::Task<> {
+                if (pathList.empty()) {
+                    co_return;
+                }
+                auto n = (co_await saveMusicInfoMany(
+                    std::exchange(pathList, {}), res.getIO())).size();
+                cnt += n;
+                co_await api::sendTextNoTry(ws, "新增 "
+                    + std::to_string(n)
+                    + " 首, 总共 "
+                    + std::to_string(cnt)
+                    + " 首.");
+            };
             co_await api::sendTextNoTry(ws, "任务开始: 扫描服务端音乐");
             co_await utils::coTraverseDirectory("./file/music", {},
                 [&](const std::filesystem::path& relativePath) -> coroutine::Task<> {
                 std::string path = relativePath.string();
                 std::filesystem::path fullPath = std::filesystem::path{"./file/music"} / relativePath;
                 if (!std::filesystem::is_directory(fullPath) && !musicDAO->isExist(path)) {
-                    co_await saveMusicInfo(std::move(path), fullPath, res.getIO());
-                    ++cnt;
-                    co_await api::sendTextNoTry(ws, "新增 1 首: [" 
-                        + fullPath.string()
-                        + "], 总共 "
-                        + std::to_string(cnt)
-                        + " 首.");
+                    pathList.push_back(std::move(path));
+                    if (pathList.size() >= ScanBatchSize) {
+                        co_await flush();
+                    }
                 }
             });
+            co_await flush();
             co_await api::sendTextNoTry(ws,
                 "OK: 扫描完成, 新增 " + std::to_string(cnt) + " 首音乐!");
             co_await api::sendTextNoTry(ws, "任务结束: 扫描服务端音乐");
@@ -136,19 +255,32 @@ HX_SERVER_API_BEGIN(MusicApi) {
                 auto idStrView = req.getPathParam(0);
                 MusicDAO::PrimaryKeyType id{};
                 reflection::fromJson(id, idStrView);
-                auto const& musicDO = musicDAO->at(id);
+                auto musicDO = musicDAO->atPtr(id);
                 co_await api::setJsonSucceed<MusicVO>({
-                    musicDO.id,
-                    musicDO.path,
-                    musicDO.musicName,
-                    musicDO.singers,
-                    musicDO.musicAlbum,
-                    musicDO.millisecondsLen
+                    musicDO->id,
+                    musicDO->path.str(),
+                    musicDO->musicName,
+                    musicDO->singers.toStrings(),
+                    musicDO->musicAlbum.str(),
+                    musicDO->millisecondsLen
                 }, res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("歌曲 ID 不存在", res).sendRes();
             });
         }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 批量获取音乐信息: 按请求的顺序返回, 不存在的 id 跳过
+        .addEndpoint<POST>("/music/info/batch", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto [idList] = co_await api::getVO<IdListVO>(req);
+                constexpr std::size_t MaxBatchCnt = 200;
+                if (idList.size() > MaxBatchCnt) [[unlikely]] {
+                    co_return co_await api::setJsonError("一次最多获取 200 首歌曲", res).sendRes();
+                }
+                co_await api::setJsonSucceed(makeSongList(idList), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("查找数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
         // 初始化上传音乐任务
         .addEndpoint<POST>("/music/upload/init", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
@@ -264,23 +396,28 @@ HX_SERVER_API_BEGIN(MusicApi) {
             }
             co_await file.close();
         }, TokenInterceptor<PermissionEnum::RegularUser>{})
-        // 分页查找歌曲
+        // 分页查找歌曲; 可按歌名、歌手、时长等排序, 并直接跳页
         .addEndpoint<POST>("/music/select", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
-                auto [beginId, maxCnt] = co_await api::getVO<SelectDataVO>(req);
+                auto vo = co_await api::getVO<SelectDataVO>(req);
+                if (!vo.sortBy.empty() || vo.isDesc || vo.offset) {
+                    co_await api::setJsonSucceed(selectSortedSongs(vo), res).sendRes();
+                    co_return;
+                }
+                auto maxCnt = vo.maxCnt;
                 SongListVO resVO;
                 musicDAO->lockSelect([&](MusicDAO::MapType const& mp) mutable {
-                    auto it = mp.lower_bound(beginId + 1);
+                    auto it = mp.lower_bound(vo.beginId + 1);
                     if (it == mp.end())
                         return;
                     for (; maxCnt && it != mp.end(); ++it, --maxCnt) {
                         auto const& musicDO = it->second;
                         resVO.songList.emplace_back<MusicVO>({
                             musicDO.id,
-                            musicDO.path,
+                            musicDO.path.str(),
                             musicDO.musicName,
-                            musicDO.singers,
-                            musicDO.musicAlbum,
+                            musicDO.singers.toStrings(),
+                            musicDO.musicAlbum.str(),
                             musicDO.millisecondsLen
                         });
                     }
@@ -290,6 +427,115 @@ HX_SERVER_API_BEGIN(MusicApi) {
                 co_await api::setJsonError("查找数据非法", res).sendRes();
             });
         }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 搜索歌曲: 按相关度从高到低返回
+        .addEndpoint<POST>("/music/search", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto [query, maxCnt] = co_await api::getVO<SearchVO>(req);
+                constexpr uint64_t MaxSearchCnt = 200;
+                auto hits = musicDAO->search(query, std::min(maxCnt, MaxSearchCnt));
+                std::vector<uint64_t> ids;
+                ids.reserve(hits.size());
+                for (auto const& hit : hits) {
+                    ids.push_back(hit.id);
+                }
+                co_await api::setJsonSucceed(makeSongList(ids), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("搜索数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 输入提示: 以 query 为前缀的歌名、歌手、专辑, 按歌曲数从多到少
+        .addEndpoint<POST>("/music/suggest", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto [prefix, maxCnt] = co_await api::getVO<SearchVO>(req);
+                SuggestListVO resVO;
+                for (auto& item : musicDAO->suggest(prefix, maxCnt)) {
+                    resVO.suggestList.push_back({
+                        std::move(item.text),
+                        std::string{MusicDAO::IndexSetType::suggestFieldName(item.field)},
+                        item.cnt
+                    });
+                }
+                co_await api::setJsonSucceed(std::move(resVO), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("提示数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 分页列出歌手 (按名称升序), 及其歌曲数与总时长
+        .addEndpoint<POST>("/music/artists", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto vo = co_await api::getVO<GroupSelectVO>(req);
+                co_await api::setJsonSucceed(
+                    selectGroups.template operator()<&MusicDO::singers>(vo), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("查找数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 分页列出专辑 (按名称升序), 及其歌曲数与总时长
+        .addEndpoint<POST>("/music/albums", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto vo = co_await api::getVO<GroupSelectVO>(req);
+                co_await api::setJsonSucceed(
+                    selectGroups.template operator()<&MusicDO::musicAlbum>(vo), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("查找数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 分页查找歌手的歌曲 (按 id 升序)
+        .addEndpoint<POST>("/music/byArtist", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto vo = co_await api::getVO<GroupMusicSelectVO>(req);
+                co_await api::setJsonSucceed(
+                    selectGroupSongs.template operator()<&MusicDO::singers>(vo), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("查找数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 分页查找专辑的歌曲 (按 id 升序)
+        .addEndpoint<POST>("/music/byAlbum", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto vo = co_await api::getVO<GroupMusicSelectVO>(req);
+                co_await api::setJsonSucceed(
+                    selectGroupSongs.template operator()<&MusicDO::musicAlbum>(vo), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("查找数据非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 增量同步: 获取版本 since 之后变更过的歌曲
+        .addEndpoint<GET>("/music/changes/{since}", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto since = req.getPathParam(0).to<uint64_t>();
+                auto changeSet = musicDAO->getChangesSince(since);
+                MusicChangeListVO resVO{changeSet.version, changeSet.isResync, {}, {}};
+                std::vector<uint64_t> ids;
+                ids.reserve(changeSet.changes.size());
+                for (auto const& change : changeSet.changes) {
+                    ids.push_back(change.id);
+                }
+                // 取得变更记录后该行可能又被删除, 以当前数据为准: atMany 按顺序访问并跳过
+                // 不存在的主键, 两次访问之间 (以及最后一次之后) 跳过的即为已删除的行
+                std::size_t next = 0;
+                musicDAO->atMany(ids, [&](MusicDO const& musicDO) {
+                    for (; ids[next] != musicDO.id; ++next) {
+                        resVO.delIdList.push_back(ids[next]);
+                    }
+                    ++next;
+                    resVO.songList.emplace_back<MusicVO>({
+                        musicDO.id,
+                        musicDO.path.str(),
+                        musicDO.musicName,
+                        musicDO.singers.toStrings(),
+                        musicDO.musicAlbum.str(),
+                        musicDO.millisecondsLen
+                    });
+                });
+                for (; next < ids.size(); ++next) {
+                    resVO.delIdList.push_back(ids[next]);
+                }
+                co_await api::setJsonSucceed(std::move(resVO), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("版本号非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
     HX_ENDPOINT_END;
 } HX_SERVER_API_END;
 
@@ -27,9 +27,11 @@
 #include <pojo/vo/PlaylistInfoListVO.hpp>
 #include <pojo/vo/PlaylistVO.hpp>
 #include <pojo/vo/IdListVO.hpp>
+#include <pojo/vo/ChangeListVO.hpp>
 #include <interceptor/TokenInterceptor.hpp>
 #include <dao/MusicDAO.hpp>
 #include <dao/PlaylistDAO.hpp>
+#include <dao/PlaylistSongDAO.hpp>
 #include <dao/UserDAO.hpp>
 
 #include <api/ApiMacro.hpp>
@@ -44,26 +46,39 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
         = dao::MemoryDAOPool::get<MusicDAO, config::MusicDbPath>();
     auto playlistDAO 
         = dao::MemoryDAOPool::get<PlaylistDAO, config::PlaylistDbPath>();
+    auto playlistSongDAO
+        = dao::MemoryDAOPool::get<PlaylistSongDAO, config::PlaylistDbPath>();
     auto userDAO
         = dao::MemoryDAOPool::get<UserDAO, config::UserDbPath>();
+    playlistSongDAO->migrateFrom(*playlistDAO);
+    // 歌单是否由该用户创建 (只能修改创建的歌单)
+    auto isCreatedBy = [userDAO](uint64_t userId, uint64_t id) {
+        return userDAO->lockSelect([&](UserDAO::MapType const& mp) {
+            auto const& arr = mp.at(userId).createdPlaylist;
+            return std::ranges::find(arr, id) != arr.end();
+        });
+    };
     HX_ENDPOINT_BEGIN
         // 创建歌单
         .addEndpoint<POST>("/playlist/make", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto vo = co_await api::getVO<PlaylistInfoVO>(req);
-                uint64_t id = playlistDAO->add<PlaylistDO>({
-                    {},
-                    std::move(vo.name),
-                    std::move(vo.description),
-                    {}
-                }).id;
                 auto userId = getTokenData(req).userId;
-                auto createdPlaylist
-                    = userDAO->at(userId, &UserDO::createdPlaylist);
-                createdPlaylist.emplace_back(id);
-                userDAO->updateBy(userId, db::FieldPair{
-                    &UserDO::createdPlaylist,
-                    createdPlaylist
+                // 新歌单与用户的歌单列表在同一个事务中提交
+                uint64_t id = dao::MemoryDAOPool::transaction([&] {
+                    uint64_t newId = playlistDAO->add<PlaylistDO>({
+                        {},
+                        std::move(vo.name),
+                        std::move(vo.description),
+                        {}
+                    }).id;
+                    auto createdPlaylist
+                        = userDAO->at(userId, &UserDO::createdPlaylist);
+                    createdPlaylist.emplace_back(newId);
+                    userDAO->updateBy(userId, db::FieldPair<&UserDO::createdPlaylist>{
+                        createdPlaylist
+                    });
+                    return newId;
                 });
                 co_await api::setJsonSucceed(id, res).sendRes();
             }, [&] CO_FUNC {
@@ -73,10 +88,15 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
         // 编辑歌单
         .addEndpoint<POST>("/playlist/update", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
-                // @todo
-                playlistDAO->update(
-                    api::toDO<PlaylistDO>(co_await api::getVO<PlaylistVO>(req))
-                );
+                auto listDO = api::toDO<PlaylistDO>(co_await api::getVO<PlaylistVO>(req));
+                dao::MemoryDAOPool::transaction([&] {
+                    playlistDAO->updateBy<true>(listDO.id,
+                        db::FieldPair<&PlaylistDO::name>{listDO.name},
+                        db::FieldPair<&PlaylistDO::description>{listDO.description}
+                    );
+                    playlistSongDAO->replaceOrder(listDO.id, listDO.songIdList);
+                });
+                playlistDAO->touch(listDO.id);
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("编辑失败", res).sendRes();
@@ -86,14 +106,24 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
         .addEndpoint<POST, DEL>("/playlist/del/{id}", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto id = req.getPathParam(0).to<uint64_t>();
-                playlistDAO->del(id);
                 auto userId = getTokenData(req).userId;
-                auto createdPlaylist
-                    = userDAO->at(userId, &UserDO::createdPlaylist);
-                createdPlaylist.erase(std::ranges::find(createdPlaylist, id));
-                userDAO->updateBy(userId, db::FieldPair{
-                    &UserDO::createdPlaylist,
-                    createdPlaylist
+                if (!isCreatedBy(userId, id)) {
+                    co_return co_await api::setJsonError("只能删除创建的歌单", res).sendRes();
+                }
+                dao::MemoryDAOPool::transaction([&] {
+                    playlistDAO->del(id);
+                    playlistSongDAO->delPlaylist(id);
+                    auto createdPlaylist
+                        = userDAO->at(userId, &UserDO::createdPlaylist);
+                    auto it = std::ranges::find(createdPlaylist, id);
+                    if (it == createdPlaylist.end()) [[unlikely]] {
+                        // 检查之后被并发地移除了 (兜底): 抛出后事务回滚, 已删除的歌单与歌曲会被恢复
+                        throw std::runtime_error{"playlist is not created by the user"};
+                    }
+                    createdPlaylist.erase(it);
+                    userDAO->updateBy(userId, db::FieldPair<&UserDO::createdPlaylist>{
+                        createdPlaylist
+                    });
                 });
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
@@ -105,24 +135,25 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
             co_await api::coTryCatch([&] CO_FUNC {
                 uint64_t id;
                 reflection::fromJson(id, req.getPathParam(0));
-                auto const& listDO = playlistDAO->at(id);
+                auto listDO = playlistDAO->atPtr(id);
                 co_await api::setJsonSucceed<PlaylistVO>({
-                    listDO.id,
-                    listDO.name,
-                    listDO.description,
+                    listDO->id,
+                    listDO->name,
+                    listDO->description,
                     [&] {
+                        auto idList = playlistSongDAO->songIdList(listDO->id);
                         std::vector<MusicVO> songList;
-                        for (auto const id : listDO.songIdList) {
-                            auto musicDO = musicDAO->at(id);
+                        songList.reserve(idList.size());
+                        musicDAO->atMany(idList, [&](MusicDO const& musicDO) {
                             songList.emplace_back(
                                 musicDO.id,
-                                std::move(musicDO.path),
-                                std::move(musicDO.musicName),
-                                std::move(musicDO.singers),
-                                std::move(musicDO.musicAlbum),
+                                musicDO.path.str(),
+                                musicDO.musicName,
+                                musicDO.singers.toStrings(),
+                                musicDO.musicAlbum.str(),
                                 musicDO.millisecondsLen
                             );
-                        }
+                        });
                         return songList;
                     }()
                 }, res).sendRes();
@@ -133,25 +164,49 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
         // 获取全部歌单
         .addEndpoint<GET>("/playlist/selectAll", [=] ENDPOINT {
             co_await api::setJsonSucceed(
-                playlistDAO->lockSelect([](PlaylistDAO::MapType const& mp) noexcept {
+                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) {
                 PlaylistInfoListVO res;
                 for (auto const& [id, val] : mp) {
-                    res.infoList.emplace_back(id, val.name, val.description, val.songIdList.size());
+                    res.infoList.emplace_back(id, val.name, val.description, playlistSongDAO->songCnt(id));
                 }
                 return res;
             }), res).sendRes();
         }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
+        // 增量同步: 获取版本 since 之后变更过的歌单 (含歌曲列表的变化)
+        .addEndpoint<GET>("/playlist/changes/{since}", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto since = req.getPathParam(0).to<uint64_t>();
+                auto changeSet = playlistDAO->getChangesSince(since);
+                PlaylistChangeListVO resVO{changeSet.version, changeSet.isResync, {}, {}};
+                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) {
+                    for (auto const& change : changeSet.changes) {
+                        // 取得变更记录后该行可能又被删除, 以当前数据为准
+                        auto it = mp.find(change.id);
+                        if (it == mp.end()) {
+                            resVO.delIdList.push_back(change.id);
+                            continue;
+                        }
+                        auto const& val = it->second;
+                        resVO.infoList.emplace_back(
+                            change.id, val.name, val.description, playlistSongDAO->songCnt(change.id));
+                    }
+                });
+                co_await api::setJsonSucceed(std::move(resVO), res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("版本号非法", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::ReadOnlyUser>{})
         // 获取用户创建的歌单
         .addEndpoint<GET>("/playlist/selectAll/created", [=] ENDPOINT {
             auto createdList = userDAO->at(
                 getTokenData(req).userId, &UserDO::createdPlaylist
             );
             co_await api::setJsonSucceed(
-                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) noexcept {
+                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) {
                 PlaylistInfoListVO res;
                 for (auto id : createdList) {
                     auto const& val = mp.at(id);
-                    res.infoList.emplace_back(id, val.name, val.description, val.songIdList.size());
+                    res.infoList.emplace_back(id, val.name, val.description, playlistSongDAO->songCnt(id));
                 }
                 return res;
             }), res).sendRes();
@@ -162,11 +217,11 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
                 getTokenData(req).userId, &UserDO::savedPlaylist
             );
             co_await api::setJsonSucceed(
-                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) noexcept {
+                playlistDAO->lockSelect([&](PlaylistDAO::MapType const& mp) {
                 PlaylistInfoListVO res;
                 for (auto id : savedPlaylist) {
                     auto const& val = mp.at(id);
-                    res.infoList.emplace_back(id, val.name, val.description, val.songIdList.size());
+                    res.infoList.emplace_back(id, val.name, val.description, playlistSongDAO->songCnt(id));
                 }
                 return res;
             }), res).sendRes();
@@ -177,12 +232,13 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
                 uint64_t id;
                 reflection::fromJson(id, req.getPathParam(0));
                 co_await api::setJsonSucceed([&]() -> PlaylistInfoVO {
-                    auto listDO = playlistDAO->at(id);
+                    auto [name, description]
+                        = playlistDAO->project<&PlaylistDO::name, &PlaylistDO::description>(id);
                     return {
                         id,
-                        std::move(listDO.name),
-                        std::move(listDO.description),
-                        listDO.songIdList.size() // @todo 性能
+                        std::move(name),
+                        std::move(description),
+                        playlistSongDAO->songCnt(id)
                     };
                 }(), res).sendRes();
             }, [&] CO_FUNC {
@@ -193,20 +249,14 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
         .addEndpoint<POST>("/playlist/{id}/addMusic/{musicId}", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto id = req.getPathParam(0).to<uint64_t>();
-                if (userDAO->lockSelect([&](UserDAO::MapType const& mp) {
-                    auto const& arr
-                        = mp.at(getTokenData(req).userId).createdPlaylist;
-                    return std::ranges::find(arr, id) == arr.end();
-                })) {
+                if (!isCreatedBy(getTokenData(req).userId, id)) {
                     co_return co_await api::setJsonError("只能修改创建的歌单", res).sendRes();
                 }
                 auto musicId = req.getPathParam(1).to<uint64_t>();
-                auto listDO = playlistDAO->at(id);
-                if (std::ranges::find(listDO.songIdList, musicId) != listDO.songIdList.end()) {
+                if (!playlistSongDAO->append(id, musicId)) {
                     co_return co_await api::setJsonError("添加失败: 音乐已存在", res).sendRes();
                 }
-                listDO.songIdList.push_back(musicId);
-                playlistDAO->update(std::move(listDO));
+                playlistDAO->touch(id);
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("歌单添加歌曲失败", res).sendRes();
@@ -217,27 +267,46 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto id = req.getPathParam(0).to<uint64_t>(),
                      idx = req.getPathParam(1).to<uint64_t>();
-                auto playlistDO = playlistDAO->at(id);
-                if (idx >= playlistDO.songIdList.size()) [[unlikely]] {
+                if (idx >= playlistSongDAO->songCnt(id)) [[unlikely]] {
                     co_return co_await api::setJsonError("索引越界", res).sendRes();;
                 }
-                playlistDO.songIdList.erase(playlistDO.songIdList.begin() + idx);
-                playlistDAO->update(std::move(playlistDO));
+                playlistSongDAO->removeAt(id, idx);
+                playlistDAO->touch(id);
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("歌曲删除失败", res).sendRes();
             });
         }, TokenInterceptor<PermissionEnum::RegularUser>{})
+        // 移动歌单中的歌曲 (第 from 首移动到第 to 个位置)
+        .addEndpoint<POST>("/playlist/{id}/moveMusic/{from}/{to}", [=] ENDPOINT {
+            co_await api::coTryCatch([&] CO_FUNC {
+                auto id = req.getPathParam(0).to<uint64_t>(),
+                     from = req.getPathParam(1).to<uint64_t>(),
+                     to = req.getPathParam(2).to<uint64_t>();
+                if (!isCreatedBy(getTokenData(req).userId, id)) {
+                    co_return co_await api::setJsonError("只能修改创建的歌单", res).sendRes();
+                }
+                auto cnt = playlistSongDAO->songCnt(id);
+                if (from >= cnt || to >= cnt) [[unlikely]] {
+                    co_return co_await api::setJsonError("索引越界", res).sendRes();
+                }
+                playlistSongDAO->move(id, from, to);
+                playlistDAO->touch(id);
+                co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
+            }, [&] CO_FUNC {
+                co_await api::setJsonError("调整歌曲位置失败", res).sendRes();
+            });
+        }, TokenInterceptor<PermissionEnum::RegularUser>{})
         // 完整更新歌单歌曲顺序
         .addEndpoint<POST>("/playlist/updateMusicOrder/{id}", [=] ENDPOINT {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto listVO = co_await api::getVO<IdListVO>(req);
                 auto id = req.getPathParam(0).to<uint64_t>();
-                auto songIdList = playlistDAO->at(id, &PlaylistDO::songIdList);
-                if (songIdList.size() != listVO.idList.size()) [[unlikely]] {
+                if (playlistSongDAO->songCnt(id) != listVO.idList.size()) [[unlikely]] {
                     co_return co_await api::setJsonError("数据不一致, 请刷新", res).sendRes();
                 }
-                playlistDAO->updateBy(id, db::FieldPair{&PlaylistDO::songIdList, listVO.idList});
+                playlistSongDAO->replaceOrder(id, listVO.idList);
+                playlistDAO->touch(id);
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("调整歌曲位置失败", res).sendRes();
@@ -248,11 +317,11 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto listVO = co_await api::getVO<IdListVO>(req);
                 auto id = getTokenData(req).userId;
-                auto songIdList = userDAO->at(id, &UserDO::createdPlaylist);
-                if (songIdList.size() != listVO.idList.size()) [[unlikely]] {
+                auto listCnt = userDAO->project<dao::sizeOf<&UserDO::createdPlaylist>>(id);
+                if (listCnt != listVO.idList.size()) [[unlikely]] {
                     co_return co_await api::setJsonError("数据不一致, 请刷新", res).sendRes();
                 }
-                userDAO->updateBy(id, db::FieldPair{&UserDO::createdPlaylist, listVO.idList});
+                userDAO->updateBy(id, db::FieldPair<&UserDO::createdPlaylist>{listVO.idList});
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("调整歌单位置失败", res).sendRes();
@@ -263,11 +332,11 @@ HX_SERVER_API_BEGIN(PlaylistApi) {
             co_await api::coTryCatch([&] CO_FUNC {
                 auto listVO = co_await api::getVO<IdListVO>(req);
                 auto id = getTokenData(req).userId;
-                auto songIdList = userDAO->at(id, &UserDO::savedPlaylist);
-                if (songIdList.size() != listVO.idList.size()) [[unlikely]] {
+                auto listCnt = userDAO->project<dao::sizeOf<&UserDO::savedPlaylist>>(id);
+                if (listCnt != listVO.idList.size()) [[unlikely]] {
                     co_return co_await api::setJsonError("数据不一致, 请刷新", res).sendRes();
                 }
-                userDAO->updateBy(id, db::FieldPair{&UserDO::savedPlaylist, listVO.idList});
+                userDAO->updateBy(id, db::FieldPair<&UserDO::savedPlaylist>{listVO.idList});
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("调整歌单位置失败", res).sendRes();
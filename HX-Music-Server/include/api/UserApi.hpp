@@ -93,6 +93,10 @@ HX_SERVER_API_BEGIN(UserApi) {
                     {},
                     userAddVO.permissionLevel
                 });
+                // 确保新用户已经落盘再返回
+                if (userDAO->isWriteBehind()) {
+                    co_await userDAO->flushAsync().via(req.getIO());
+                }
                 co_return co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("数据非法", res).sendRes();
@@ -150,19 +154,11 @@ HX_SERVER_API_BEGIN(UserApi) {
                 // 密码加盐
                 auto newSalt = utils::Uuid::makeV4();
                 updatePwdVO.newPasswd += salt;
-                // 计算 MD5
-                auto userDO = userDAO->at(id);
-                userDAO->update<UserDO>({
-                    id,
-                    std::move(userDO.name),
-                    std::move(userDO.signature),
-                    std::move(salt),
-                    utils::md5(updatePwdVO.newPasswd ), // 计算 MD5
-                    std::move(userDO.createdPlaylist),
-                    std::move(userDO.savedPlaylist),
-                    userDO.permissionLevel,
-                    utils::Uuid::makeV4() // 重设 登录Id
-                });
+                // 只更新密码与登录Id, 不必复制整个 UserDO
+                userDAO->updateBy(id,
+                    db::FieldPair<&UserDO::password>{utils::md5(updatePwdVO.newPasswd)}, // 计算 MD5
+                    db::FieldPair<&UserDO::loggedInUuid>{utils::Uuid::makeV4()} // 重设 登录Id
+                );
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
                 co_await api::setJsonError("数据非法", res).sendRes();
@@ -178,7 +174,7 @@ HX_SERVER_API_BEGIN(UserApi) {
                 }
                 userDAO->updateBy(
                     id,
-                    db::FieldPair{&UserDO::name, strVO.data}
+                    db::FieldPair<&UserDO::name>{strVO.data}
                 );
                 co_await api::setJsonSucceed<std::string>("ok", res).sendRes();
             }, [&] CO_FUNC {
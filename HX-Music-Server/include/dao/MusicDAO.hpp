@@ -18,72 +18,27 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <set>
-
-#include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/ShardedInMemoryDAO.hpp>
 #include <pojo/do/MusicDO.hpp>
 
 namespace HX {
 
-struct MusicDAO : public dao::ThreadSafeInMemoryDAO<MusicDO> {
+// 歌曲的主键为自增 id, 持久化基数树的叶几乎是满的, 按 id 读取与分页遍历接近连续存储,
+// 且扫描入库等批量写入不必每次复制整个分片
+struct MusicDAO : public dao::ShardedInMemoryDAO<MusicDO, 16, dao::PersistentIdStorage> {
     using T = MusicDO;
-    using Base = dao::ThreadSafeInMemoryDAO<MusicDO>;
+    using Base = dao::ShardedInMemoryDAO<MusicDO, 16, dao::PersistentIdStorage>;
     using Base::Base;
 
-    MusicDAO(db::SQLiteDB db)
-        : Base{std::move(db)}
-    {
-        Base::lockSelect([&](auto const& mp) {
-            for (auto const& it: mp) {
-                _pathSet.insert(it.second.path);
-            }
-        });
-    }
-
-    template <typename U>
-    T add(U&& u) {
-        auto t = Base::add(std::forward<U>(u));
-        Base::uniqueLock([&] {
-            _pathSet.insert(std::move(t.path));
-        });
-        return t;
-    }
-
-    template <typename U>
-    T update(U&& u) {
-        std::string oldPath = Base::at(u.id).path;
-        auto t = Base::update(std::forward<U>(u));
-        Base::uniqueLock([&] {
-            if (oldPath != t.path) {
-                _pathSet.erase(oldPath);
-                _pathSet.insert(std::move(t.path));
-            }
-        });
-        return t;
-    }
-
-    void del(PrimaryKeyType id) {
-        std::string oldPath = Base::at(id).path;
-        Base::uniqueLock([&] {
-            _pathSet.erase(oldPath);
-        });
-        Base::del(id);
-    }
-
     /**
      * @brief 判断 `路径` 对应的文件是否已经记录过了 
      * @param path 相对路径
      * @return true 已经记录过了
      * @return false 未记录
      */
-    bool isExist(std::string_view path) const noexcept {
-        return Base::sharedLock([&] {
-            return _pathSet.contains(path);
-        });
+    bool isExist(std::string_view path) const {
+        return Base::findIdBy<&MusicDO::path>(path).has_value();
     }
-private:
-    // 记录路径
-    std::set<std::string, std::less<>> _pathSet;
 };
 
 } // namespace HX
@@ -18,14 +18,14 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/ShardedInMemoryDAO.hpp>
 #include <pojo/do/PlaylistDO.hpp>
 
 namespace HX {
 
-struct PlaylistDAO : public dao::ThreadSafeInMemoryDAO<PlaylistDO> {
+struct PlaylistDAO : public dao::ShardedInMemoryDAO<PlaylistDO> {
     using T = MusicDO;
-    using Base = dao::ThreadSafeInMemoryDAO<PlaylistDO>;
+    using Base = dao::ShardedInMemoryDAO<PlaylistDO>;
     using Base::Base;
 };
 
@@ -0,0 +1,332 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <HXLibs/log/Log.hpp>
+
+#include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/PlaylistDAO.hpp>
+#include <pojo/do/PlaylistSongDO.hpp>
+#include <utils/OrderStatisticTree.hpp>
+
+namespace HX {
+
+/**
+ * @brief 歌单-歌曲 关系表; 每个歌单在内存中维护一棵按 positionKey 排序的顺序统计树,
+ *        追加/按位置删除/移动均为 O(log n), 且只需写一行数据库.
+ */
+struct PlaylistSongDAO : public dao::ThreadSafeInMemoryDAO<PlaylistSongDO> {
+    using T = PlaylistSongDO;
+    using Base = dao::ThreadSafeInMemoryDAO<PlaylistSongDO>;
+
+    PlaylistSongDAO(
+        db::SQLiteDB db,
+        dao::WriteMode mode = dao::WriteMode::WriteThrough,
+        dao::SnapshotOptions const& snapshot = {},
+        std::shared_ptr<dao::WriteGroup> group = {}
+    )
+        : Base{std::move(db), mode, snapshot, std::move(group)}
+    {
+        // 排序键重复 (如旧数据或外部修改) 的行先暂存, 加载完后重排所在的歌单
+        std::unordered_map<uint64_t, std::vector<std::pair<double, Entry>>> collided;
+        for (auto const& [id, row] : _map) {
+            auto& songList = _listMap[row.playlistId];
+            if (!songList.order.insert(row.positionKey, {id, row.musicId})) [[unlikely]] {
+                collided[row.playlistId].emplace_back(row.positionKey, Entry{id, row.musicId});
+            }
+            songList.musicIdSet.insert(row.musicId);
+        }
+        for (auto& [playlistId, rows] : collided) {
+            log::hxLog.warning("歌单的排序键重复, 重排:", playlistId, "重复行数:", rows.size());
+            auto& songList = _listMap.at(playlistId);
+            songList.order.forEach([&](double key, Entry const& e) {
+                rows.emplace_back(key, e);
+            });
+            // 同一排序键按行 id 先后排列
+            std::ranges::sort(rows, [](auto const& a, auto const& b) {
+                return a.first != b.first ? a.first < b.first : a.second.rowId < b.second.rowId;
+            });
+            utils::OrderStatisticTree<double, Entry> order;
+            for (std::size_t i = 0; i < rows.size(); ++i) {
+                order.insert(static_cast<double>(i + 1), rows[i].second);
+            }
+            songList.order = std::move(order);
+            renumber(songList);
+        }
+    }
+
+    /**
+     * @brief 获取歌单的歌曲id列表 (按顺序)
+     */
+    std::vector<uint64_t> songIdList(uint64_t playlistId) const {
+        return Base::sharedLock([&] {
+            return songIdListImpl(playlistId);
+        });
+    }
+
+    /**
+     * @brief 获取歌单的歌曲数量, O(1)
+     */
+    std::size_t songCnt(uint64_t playlistId) const {
+        return Base::sharedLock([&] {
+            auto it = _listMap.find(playlistId);
+            return it == _listMap.end() ? 0 : it->second.order.size();
+        });
+    }
+
+    /**
+     * @brief 歌单中是否已有该歌曲, O(1)
+     */
+    bool contains(uint64_t playlistId, uint64_t musicId) const {
+        return Base::sharedLock([&] {
+            auto it = _listMap.find(playlistId);
+            return it != _listMap.end() && it->second.musicIdSet.contains(musicId);
+        });
+    }
+
+    /**
+     * @brief 追加歌曲到歌单末尾
+     * @return true 追加成功
+     * @return false 歌曲已存在
+     */
+    bool append(uint64_t playlistId, uint64_t musicId) {
+        return Base::uniqueLock([&] {
+            auto& songList = _listMap[playlistId];
+            if (songList.musicIdSet.contains(musicId)) {
+                return false;
+            }
+            recordUndo(playlistId);
+            double key = songList.order.empty()
+                ? 1.0
+                : songList.order.nth(songList.order.size() - 1).first + 1.0;
+            insertRow(songList, playlistId, key, musicId);
+            return true;
+        });
+    }
+
+    /**
+     * @brief 删除歌单中第 idx 首歌曲
+     * @throw std::out_of_range 索引越界
+     */
+    void removeAt(uint64_t playlistId, std::size_t idx) {
+        Base::uniqueLock([&] {
+            auto& songList = _listMap.at(playlistId);
+            auto [key, e] = songList.order.nth(idx);
+            recordUndo(playlistId);
+            Base::delImpl(e.rowId);
+            songList.order.erase(key);
+            songList.musicIdSet.erase(e.musicId);
+        });
+    }
+
+    /**
+     * @brief 把第 from 首歌曲移动到第 to 个位置, 只更新被移动的那一行;
+     *        仅当相邻排序键的浮点精度耗尽时才重排整个歌单.
+     * @throw std::out_of_range 索引越界
+     */
+    void move(uint64_t playlistId, std::size_t from, std::size_t to) {
+        Base::uniqueLock([&] {
+            auto& songList = _listMap.at(playlistId);
+            auto& order = songList.order;
+            if (to >= order.size()) [[unlikely]] {
+                throw std::out_of_range{"PlaylistSongDAO::move"};
+            }
+            auto [oldKey, e] = order.nth(from);
+            if (from == to) {
+                return;
+            }
+            recordUndo(playlistId);
+            order.erase(oldKey);
+            double key;
+            if (to == 0) {
+                key = order.nth(0).first - 1.0;
+            } else if (to == order.size()) {
+                key = order.nth(to - 1).first + 1.0;
+            } else {
+                double lo = order.nth(to - 1).first, hi = order.nth(to).first;
+                key = lo + (hi - lo) / 2;
+                if (key <= lo || key >= hi) [[unlikely]] {
+                    order.insert(oldKey, e);
+                    renumber(songList);
+                    // 重排后排序键为 1..n, 必定有空隙
+                    order.erase(order.nth(from).first);
+                    lo = order.nth(to - 1).first;
+                    hi = order.nth(to).first;
+                    key = lo + (hi - lo) / 2;
+                }
+            }
+            order.insert(key, e);
+            Base::updateByImpl(e.rowId, db::FieldPair<&T::positionKey>{key});
+        });
+    }
+
+    /**
+     * @brief 以 idList 完整替换歌单的歌曲及顺序 (重复的 id 只保留第一个)
+     */
+    void replaceOrder(uint64_t playlistId, std::vector<uint64_t> const& idList) {
+        Base::uniqueLock([&] {
+            recordUndo(playlistId);
+            delPlaylistImpl(playlistId);
+            auto& songList = _listMap[playlistId];
+            std::vector<T> rows;
+            rows.reserve(idList.size());
+            for (auto musicId : idList) {
+                if (songList.musicIdSet.insert(musicId).second) {
+                    rows.push_back({{}, playlistId, static_cast<double>(rows.size() + 1), musicId});
+                }
+            }
+            auto ids = Base::addManyImpl(rows);
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                songList.order.insert(rows[i].positionKey, {ids[i], rows[i].musicId});
+            }
+        });
+    }
+
+    /**
+     * @brief 删除歌单的所有歌曲 (删除歌单时调用)
+     */
+    void delPlaylist(uint64_t playlistId) {
+        Base::uniqueLock([&] {
+            recordUndo(playlistId);
+            delPlaylistImpl(playlistId);
+        });
+    }
+
+    /**
+     * @brief 把旧版存于 PlaylistDO::songIdList 的歌曲列表迁移到本表, 并清空该列
+     * @param playlistDAO
+     * @return std::size_t 迁移的歌单数量
+     */
+    std::size_t migrateFrom(PlaylistDAO& playlistDAO) {
+        auto legacy = playlistDAO.lockSelect([](PlaylistDAO::MapType const& mp) {
+            std::vector<std::pair<uint64_t, std::vector<uint64_t>>> res;
+            for (auto const& [id, val] : mp) {
+                if (!val.songIdList.empty()) {
+                    res.emplace_back(id, val.songIdList);
+                }
+            }
+            return res;
+        });
+        for (auto const& [id, songIdList] : legacy) {
+            // 已有新表数据的, 说明上次迁移在清空旧列前中断, 以新表为准
+            if (!songCnt(id)) {
+                replaceOrder(id, songIdList);
+            }
+            playlistDAO.updateBy(id, db::FieldPair<&PlaylistDO::songIdList>{
+                std::vector<uint64_t>{}
+            });
+        }
+        if (!legacy.empty()) {
+            log::hxLog.info("迁移歌单歌曲到 PlaylistSongDO:", legacy.size());
+        }
+        return legacy.size();
+    }
+private:
+    struct Entry {
+        uint64_t rowId;     // PlaylistSongDO::id
+        uint64_t musicId;
+    };
+
+    struct SongList {
+        utils::OrderStatisticTree<double, Entry> order;
+        std::unordered_set<uint64_t> musicIdSet;
+    };
+
+    std::vector<uint64_t> songIdListImpl(uint64_t playlistId) const {
+        std::vector<uint64_t> res;
+        auto it = _listMap.find(playlistId);
+        if (it == _listMap.end()) {
+            return res;
+        }
+        res.reserve(it->second.order.size());
+        it->second.order.forEach([&](double, Entry const& e) {
+            res.push_back(e.musicId);
+        });
+        return res;
+    }
+
+    // 处于 UndoLog 的事务中时, 登记以修改前的歌曲列表整体替换的逆操作; 需要在修改前、持有写锁时调用.
+    // 行级的 xxxImpl 不登记逆操作, 歌单以整体为单位撤销, 以免顺序统计树与行不一致
+    void recordUndo(uint64_t playlistId) {
+        if (!dao::UndoLog::isActive()) {
+            return;
+        }
+        dao::UndoLog::record([this, playlistId, old = songIdListImpl(playlistId)] {
+            replaceOrder(playlistId, old);
+        });
+    }
+
+    void insertRow(SongList& songList, uint64_t playlistId, double key, uint64_t musicId) {
+        auto row = Base::addImpl(T{{}, playlistId, key, musicId});
+        songList.order.insert(key, {row.id, musicId});
+        songList.musicIdSet.insert(musicId);
+    }
+
+    void delPlaylistImpl(uint64_t playlistId) {
+        auto it = _listMap.find(playlistId);
+        if (it == _listMap.end()) {
+            return;
+        }
+        it->second.order.forEach([&](double, Entry const& e) {
+            if (auto row = _map.find(e.rowId); row != _map.end()) {
+                _indexes.erase(row->second, e.rowId);
+                _map.erase(row);
+                Base::recordChange(e.rowId, db::ChangeOp::Delete);
+            }
+        });
+        _listMap.erase(it);
+        Base::persist([](db::SQLiteDB& db, uint64_t playlistId) {
+            db.deleteBy<T, "where playlistId=?">()
+              .template bind<true>(playlistId)
+              .execOnThrow();
+        }, playlistId);
+    }
+
+    // 把歌单的排序键重排为 1..n, 在同一个事务中写入
+    void renumber(SongList& songList) {
+        std::vector<std::pair<uint64_t, double>> keys;
+        utils::OrderStatisticTree<double, Entry> order;
+        songList.order.forEach([&](double, Entry const& e) {
+            double key = static_cast<double>(keys.size() + 1);
+            keys.emplace_back(e.rowId, key);
+            order.insert(key, e);
+            _map.at(e.rowId).positionKey = key;
+            Base::recordChange(e.rowId);
+        });
+        songList.order = std::move(order);
+        Base::persist([](db::SQLiteDB& db, std::vector<std::pair<uint64_t, double>> const& keys) {
+            db.transaction([&] {
+                for (auto const& [rowId, key] : keys) {
+                    db.updateBy<"where ", PrimaryKeyName, "=?">(db::FieldPair<&T::positionKey>{key})
+                      .template bind<true>(rowId)
+                      .execOnThrow();
+                }
+            });
+        }, keys);
+    }
+
+    std::unordered_map<uint64_t, SongList> _listMap;
+};
+
+} // namespace HX
@@ -18,96 +18,26 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/ShardedInMemoryDAO.hpp>
 #include <pojo/do/UserDO.hpp>
 
 namespace HX {
 
-struct UserDAO : public dao::ThreadSafeInMemoryDAO<UserDO> {
+struct UserDAO : public dao::ShardedInMemoryDAO<UserDO> {
     using T = UserDO;
-    using Base = dao::ThreadSafeInMemoryDAO<UserDO>;
+    using Base = dao::ShardedInMemoryDAO<UserDO>;
     using Base::Base;
 
-    UserDAO(db::SQLiteDB db)
-        : Base{std::move(db)}
-    {
-        Base::lockSelect([&](UserDAO::MapType const& mp) {
-            for (auto const& [id, data] : mp) {
-                _nameMapId.emplace(data.name, id);
-            }
-        });
-    }
-
-    template <typename U>
-    T add(U&& u) {
-        auto t = Base::add(std::forward<U>(u));
-        Base::uniqueLock([&] {
-            _nameMapId.emplace(t.name, u.id);
-        });
-        return t;
-    }
-
-    template <typename U>
-    T update(U&& u) {
-        std::string name = Base::at(u.id).name;
-        auto t = Base::update(std::forward<U>(u));
-        Base::uniqueLock([&] {
-            if (name != t.name) {
-                _nameMapId.erase(name);
-                _nameMapId.emplace(t.name, t.id);
-            }
-        });
-        return t;
-    }
-
-    template <typename... MemberPtr>
-    void updateBy(db::GetFirstPrimaryKeyType<T> id, db::FieldPair<MemberPtr>... mbPair) {
-        if constexpr ((std::is_same_v<MemberPtr, decltype(&UserDO::name)> || ...)) {
-            (([&] <typename MP> (db::FieldPair<MP> mbp) {
-                if (mbp.ptr == &UserDO::name) {
-                    std::unique_lock _{_mtx};
-                    auto& t = _map[id];
-                    if (mbp.dataView != t.name) {
-                        _nameMapId.erase(t.name);
-                        _nameMapId.emplace(mbp.dataView, t.id);
-                    }
-                    return true;
-                }
-                return false;
-            }(mbPair)) || ...);
-        }
-        Base::updateBy(id, mbPair...);
-    }
-
+    /**
+     * @brief 重设登录 Uuid; 内存与数据库一同更新, 令牌校验读取的是内存中的值
+     */
     void updateLoginUuid(uint64_t id, std::string const& loginUuid) {
-        std::unique_lock _{_mtx};
-        constexpr auto name = reflection::getMembersNames<T>()[db::GetFirstPrimaryKeyIndex<T>];
-        _db.updateBy<"where ", meta::FixedString<name.size() + 1>{name}, "=?">(
-            db::FieldPair{&UserDO::loggedInUuid, loginUuid}
-        ).bind<true>(id)
-         .execOnThrow();
-    }
-
-    void del(PrimaryKeyType id) {
-        std::string name = Base::at(id).name;
-        Base::uniqueLock([&] {
-            _nameMapId.erase(name);
-        });
-        Base::del(id);
+        Base::updateBy(id, db::FieldPair<&UserDO::loggedInUuid>{loginUuid});
     }
 
-    std::optional<uint64_t> atName(std::string_view name) {
-        return Base::sharedLock([&]() -> std::optional<uint64_t> {
-            auto it = _nameMapId.find(name);
-            if (it == _nameMapId.end()) {
-                return {};
-            }
-            return it->second;
-        });
+    std::optional<uint64_t> atName(std::string_view name) const {
+        return Base::findIdBy<&UserDO::name>(name);
     }
-private:
-    // 用户名 -> 用户 Id 映射
-    std::map<std::string, uint64_t, std::less<>> _nameMapId;
 };
 
 } // namespace HX
\ No newline at end of file
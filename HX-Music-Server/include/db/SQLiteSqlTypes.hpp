@@ -0,0 +1,90 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <db/SQLiteMeta.hpp>
+#include <db/BlobCodec.hpp>
+#include <HXLibs/reflection/json/JsonRead.hpp>
+#include <HXLibs/reflection/json/JsonWrite.hpp>
+
+// 服务端各 DO 中数组、枚举类型的列的存储方式; 需要在引入各 DAO 之前引入
+
+namespace HX::db {
+
+// 整数数组、字符串数组: 以二进制 BLOB 存储
+template <typename U>
+    requires (db::isBlobCodecVal<std::vector<U>>)
+struct SQLiteSqlType<std::vector<U>> {
+    using T = std::vector<U>;
+    static constexpr bool IsBlob = true;
+
+    static std::string bind(T const& t) {
+        return db::BlobCodec<T>::encode(t);
+    }
+
+    static T columnType(std::string_view bytes) {
+        return db::BlobCodec<T>::decode(bytes);
+    }
+
+    // 兼容旧版以 JSON 文本存储的数据
+    static T columnTypeFromText(std::string_view str) {
+        T t{};
+        reflection::fromJson(t, str);
+        return t;
+    }
+};
+
+template <typename U>
+struct SQLiteSqlType<std::vector<U>> {
+    using T = std::vector<U>;
+    static constexpr std::string bind(T const& t) noexcept {
+        std::string res;
+        reflection::toJson(t, res);
+        return res;
+    }
+
+    static constexpr T columnType(std::string_view str) {
+        T t{};
+        reflection::fromJson(t, str);
+        return t;
+    }
+};
+
+template <typename T>
+    requires (std::is_enum_v<T>)
+struct SQLiteSqlType<T> {
+    static constexpr std::string bind(T const& t) noexcept {
+        std::string res;
+        reflection::toJson(t, res);
+        return res;
+    }
+
+    static constexpr T columnType(std::string_view str) {
+        T t{};
+        reflection::fromJson(t, str);
+        return t;
+    }
+};
+
+} // namespace HX::db
@@ -66,12 +66,12 @@ struct TokenInterceptor {
             ) {
                 co_await api::setJsonError("凭证失效", res).sendRes();
                 ans = false;
-            } else if (auto const& userDO = userDAO->at(tokenData.userId);
-                userDO.permissionLevel > Permission
+            } else if (auto userDO = userDAO->atPtr(tokenData.userId);
+                userDO->permissionLevel > Permission
             ) {
                 co_await api::setJsonError("权限不足", res).sendRes();
                 ans = false;
-            } else if (userDO.loggedInUuid != tokenData.loginUuid) {
+            } else if (userDO->loggedInUuid != tokenData.loginUuid) {
                 co_await api::setJsonError("凭证失效", res).sendRes();
                 ans = false;
             }
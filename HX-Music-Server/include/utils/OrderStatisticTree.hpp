@@ -0,0 +1,218 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace HX::utils {
+
+/**
+ * @brief 顺序统计树 (以子树大小增强的 Treap): 按 Key 有序, 支持 O(log n) 的插入/删除/按名次访问/求名次
+ * @tparam Key 唯一键, 需可比较
+ * @tparam Val
+ */
+template <typename Key, typename Val>
+class OrderStatisticTree {
+    struct Node {
+        std::pair<Key, Val> kv;
+        uint32_t prio;
+        std::size_t size = 1;
+        std::unique_ptr<Node> l{}, r{};
+    };
+    using NodePtr = std::unique_ptr<Node>;
+
+    static std::size_t sizeOf(NodePtr const& t) noexcept {
+        return t ? t->size : 0;
+    }
+
+    static void pull(Node* t) noexcept {
+        t->size = 1 + sizeOf(t->l) + sizeOf(t->r);
+    }
+
+    // 把 t 分为 (< key, >= key) 两棵树
+    static std::pair<NodePtr, NodePtr> split(NodePtr t, Key const& key) {
+        if (!t) {
+            return {};
+        }
+        if (t->kv.first < key) {
+            auto [l, r] = split(std::move(t->r), key);
+            t->r = std::move(l);
+            pull(t.get());
+            return {std::move(t), std::move(r)};
+        }
+        auto [l, r] = split(std::move(t->l), key);
+        t->l = std::move(r);
+        pull(t.get());
+        return {std::move(l), std::move(t)};
+    }
+
+    // 要求 a 中所有键 < b 中所有键
+    static NodePtr merge(NodePtr a, NodePtr b) {
+        if (!a || !b) {
+            return a ? std::move(a) : std::move(b);
+        }
+        if (a->prio > b->prio) {
+            a->r = merge(std::move(a->r), std::move(b));
+            pull(a.get());
+            return a;
+        }
+        b->l = merge(std::move(a), std::move(b->l));
+        pull(b.get());
+        return b;
+    }
+
+    template <typename Func>
+    static void inorder(Node const* t, Func& func) {
+        while (t) {
+            inorder(t->l.get(), func);
+            func(t->kv.first, t->kv.second);
+            t = t->r.get();
+        }
+    }
+public:
+    OrderStatisticTree() = default;
+    OrderStatisticTree(OrderStatisticTree&&) noexcept = default;
+    OrderStatisticTree& operator=(OrderStatisticTree&&) noexcept = default;
+
+    std::size_t size() const noexcept {
+        return sizeOf(_root);
+    }
+
+    bool empty() const noexcept {
+        return !_root;
+    }
+
+    /**
+     * @brief 插入 (键已存在则不插入)
+     * @return true 插入成功
+     */
+    bool insert(Key key, Val val) {
+        if (find(key)) {
+            return false;
+        }
+        auto node = std::make_unique<Node>(Node{{std::move(key), std::move(val)}, static_cast<uint32_t>(_rng())});
+        auto [l, r] = split(std::move(_root), node->kv.first);
+        _root = merge(merge(std::move(l), std::move(node)), std::move(r));
+        return true;
+    }
+
+    /**
+     * @brief 删除键
+     * @return true 删除成功
+     */
+    bool erase(Key const& key) {
+        NodePtr* cur = &_root;
+        // 先确认存在, 再沿路径把 size 减一
+        if (!find(key)) {
+            return false;
+        }
+        while (*cur) {
+            Node* t = cur->get();
+            --t->size;
+            if (key < t->kv.first) {
+                cur = &t->l;
+            } else if (t->kv.first < key) {
+                cur = &t->r;
+            } else {
+                *cur = merge(std::move(t->l), std::move(t->r));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 查找键
+     * @return Val* 不存在时为 nullptr
+     */
+    Val* find(Key const& key) noexcept {
+        Node* t = _root.get();
+        while (t) {
+            if (key < t->kv.first) {
+                t = t->l.get();
+            } else if (t->kv.first < key) {
+                t = t->r.get();
+            } else {
+                return &t->kv.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 第 idx 小的元素 (从 0 开始)
+     * @throw std::out_of_range
+     */
+    std::pair<Key, Val> const& nth(std::size_t idx) const {
+        if (idx >= size()) [[unlikely]] {
+            throw std::out_of_range{"OrderStatisticTree::nth"};
+        }
+        Node const* t = _root.get();
+        for (;;) {
+            auto ls = sizeOf(t->l);
+            if (idx < ls) {
+                t = t->l.get();
+            } else if (idx == ls) {
+                return t->kv;
+            } else {
+                idx -= ls + 1;
+                t = t->r.get();
+            }
+        }
+    }
+
+    /**
+     * @brief 小于 key 的元素个数
+     */
+    std::size_t rank(Key const& key) const noexcept {
+        std::size_t res = 0;
+        Node const* t = _root.get();
+        while (t) {
+            if (t->kv.first < key) {
+                res += sizeOf(t->l) + 1;
+                t = t->r.get();
+            } else {
+                t = t->l.get();
+            }
+        }
+        return res;
+    }
+
+    /**
+     * @brief 按键的顺序遍历
+     * @param func 形如 `(Key const&, Val const&) -> void`
+     */
+    template <typename Func>
+    void forEach(Func&& func) const {
+        inorder(_root.get(), func);
+    }
+
+    void clear() noexcept {
+        _root.reset();
+    }
+private:
+    NodePtr _root{};
+    std::minstd_rand _rng{std::random_device{}()};
+};
+
+} // namespace HX::utils
@@ -14,53 +14,17 @@ auto hx_init = []{
     return 0;
 }();
 
-#include <db/SQLiteMeta.hpp>
-#include <HXLibs/reflection/json/JsonRead.hpp>
-#include <HXLibs/reflection/json/JsonWrite.hpp>
+// 需要先于各 DAO 引入
+#include <db/SQLiteSqlTypes.hpp>
 
 using namespace HX;
 
-namespace HX::db {
-
-template <typename U>
-struct SQLiteSqlType<std::vector<U>> {
-    using T = std::vector<U>;
-    static constexpr std::string bind(T const& t) noexcept {
-        std::string res;
-        reflection::toJson(t, res);
-        return res;
-    }
-
-    static constexpr T columnType(std::string_view str) {
-        T t{};
-        reflection::fromJson(t, str);
-        return t;
-    }
-};
-
-template <typename T>
-    requires (std::is_enum_v<T>)
-struct SQLiteSqlType<T> {
-    static constexpr std::string bind(T const& t) noexcept {
-        std::string res;
-        reflection::toJson(t, res);
-        return res;
-    }
-
-    static constexpr T columnType(std::string_view str) {
-        T t{};
-        reflection::fromJson(t, str);
-        return t;
-    }
-};
-
-} // namespace HX::db
-
 #include <api/MusicApi.hpp>
 #include <api/PlaylistApi.hpp>
 #include <api/CoverApi.hpp>
 #include <api/LyricsApi.hpp>
 #include <api/UserApi.hpp>
+#include <api/AdminApi.hpp>
 
 #include <filesystem>
 
@@ -72,6 +36,23 @@ void ininDir() {
     std::filesystem::create_directories("file/avatar");
     std::filesystem::create_directories("file/lyrics");
     std::filesystem::create_directories("file/lyrics/ass");
+    std::filesystem::create_directories("file/backup");
+
+    // 以歌单库为主库, 附加用户库与音乐库: 所有 DAO 经由同一个连接提交, 跨表的接口只需一次提交;
+    // 以回滚日志模式打开, 跨库的提交是原子的
+    dao::MemoryDAOPool::setWriteGroup(std::make_shared<dao::WriteGroup>(std::vector<std::string>{
+        std::string{meta::ToCharPack<config::PlaylistDbPath>::view()},
+        std::string{meta::ToCharPack<config::UserDbPath>::view()},
+        std::string{meta::ToCharPack<config::MusicDbPath>::view()},
+    }, db::SQLiteOpenOptions::productionGroup()));
+
+    // 并发加载所有 DAO, 之后各处的 MemoryDAOPool::get 直接取得已加载的单例
+    dao::MemoryDAOPool::bootstrap<
+        dao::DAOEntry<UserDAO, config::UserDbPath>,
+        dao::DAOEntry<MusicDAO, config::MusicDbPath>,
+        dao::DAOEntry<PlaylistDAO, config::PlaylistDbPath>,
+        dao::DAOEntry<PlaylistSongDAO, config::PlaylistDbPath>
+    >();
 
     // 初始化
     auto userDAO = dao::MemoryDAOPool::get<UserDAO, config::UserDbPath>();
@@ -92,6 +73,7 @@ void ininDir() {
             PermissionEnum::Administrator,
             utils::Uuid::makeV4()
         });
+        userDAO->flush();
     }
 }
 
@@ -108,6 +90,7 @@ int main() {
     api::addApi<CoverApi>(server);
     api::addApi<LyricsApi>(server);
     api::addApi<UserApi>(server);
+    api::addApi<AdminApi>(server);
 
     std::signal(SIGINT, [](int s) {
         if (s == SIGINT) {
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 批量按 id 取歌曲 (如变更列表): 逐个 atPtr、atMany 与在 lockSelect 中逐个查找; 10 万首歌曲中随机取 1000 首
+
+#include <random>
+
+#include <Catalog.hpp>
+
+using namespace HX;
+
+namespace {
+
+// 返回给客户端的歌曲信息
+struct TrackVO {
+    uint64_t id;
+    std::string path;
+    std::string musicName;
+    std::vector<std::string> singers;
+    std::string musicAlbum;
+    uint64_t millisecondsLen;
+};
+
+TrackVO toVO(MusicDO const& t) {
+    return {t.id, t.path.str(), t.musicName, t.singers.toStrings(),
+            t.musicAlbum.str(), t.millisecondsLen};
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t TrackCnt = 100'000;
+    constexpr std::size_t BatchSize = 1'000;
+    MusicDAO dao{db::SQLiteDB{bench::tmpDbPath("BatchLookup"), db::SQLiteOpenOptions::production()}};
+    std::vector<MusicDO> list;
+    list.reserve(TrackCnt);
+    for (std::size_t i = 0; i < TrackCnt; ++i) {
+        list.push_back(bench::makeTrack(i));
+    }
+    auto allIds = dao.addMany(std::move(list));
+    std::mt19937 rng{1};
+    std::vector<uint64_t> ids(BatchSize);
+    for (auto& id : ids) {
+        id = allIds[rng() % allIds.size()];
+    }
+
+    bench::report("1000 ids: atPtr loop", 200, [&](std::size_t) {
+        std::vector<TrackVO> res;
+        res.reserve(ids.size());
+        for (auto id : ids) {
+            res.push_back(toVO(*dao.atPtr(id)));
+        }
+        bench::consume(res.size());
+    });
+    bench::report("1000 ids: atMany", 200, [&](std::size_t) {
+        std::vector<TrackVO> res;
+        res.reserve(ids.size());
+        dao.atMany(ids, [&](MusicDO const& t) {
+            res.push_back(toVO(t));
+        });
+        bench::consume(res.size());
+    });
+    bench::report("1000 ids: lockSelect + find", 200, [&](std::size_t) {
+        std::vector<TrackVO> res;
+        res.reserve(ids.size());
+        dao.lockSelect([&](MusicDAO::MapType const& mp) {
+            for (auto id : ids) {
+                if (auto it = mp.find(id); it != mp.end()) {
+                    res.push_back(toVO(it->second));
+                }
+            }
+        });
+        bench::consume(res.size());
+    });
+}
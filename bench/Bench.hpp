@@ -0,0 +1,100 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+namespace HX::bench {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 执行 func() 的耗时 (毫秒)
+ */
+template <typename Func>
+double timeMs(Func&& func) {
+    auto t0 = Clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+/**
+ * @brief 以 func(i) 执行 n 次, 打印并返回每次的平均耗时 (微秒)
+ */
+template <typename Func>
+double report(std::string_view name, std::size_t n, Func&& func) {
+    auto ms = timeMs([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            func(i);
+        }
+    });
+    double us = ms * 1000 / static_cast<double>(n);
+    std::printf("%-48.*s %12.3f us/op  (%zu ops, %.1f ms)\n",
+                static_cast<int>(name.size()), name.data(), us, n, ms);
+    return us;
+}
+
+/**
+ * @brief 吸收计算结果, 防止被优化掉
+ */
+inline void consume(std::size_t val) noexcept {
+    static std::size_t volatile sink = 0;
+    sink = sink + val;
+}
+
+/**
+ * @brief 当前进程的常驻内存 (字节); 非 Linux 为 0
+ */
+inline std::size_t residentBytes() {
+#ifdef __linux__
+    std::ifstream file{"/proc/self/statm"};
+    std::size_t total = 0, resident = 0;
+    if (!(file >> total >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 临时目录下的数据库路径; 先删除同名的数据库及其 WAL 与快照文件
+ */
+inline std::string tmpDbPath(std::string_view name) {
+    auto path = (std::filesystem::temp_directory_path() / ("HXBench." + std::string{name} + ".db")).string();
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator{std::filesystem::temp_directory_path(), ec}) {
+        if (entry.path().string().starts_with(path)) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+    return path;
+}
+
+} // namespace HX::bench
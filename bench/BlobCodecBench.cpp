@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 向量列的编码: BLOB (db::BlobCodec) 与旧的 JSON 文本对比
+// 1. 只比较编解码: 10 万首歌的歌单 (std::vector<uint64_t>) 与 10 万个歌手名 (std::vector<std::string>)
+// 2. 经由 sqlite 读出整列再解码, 即启动加载时的路径
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include <HXLibs/reflection/json/JsonRead.hpp>
+#include <HXLibs/reflection/json/JsonWrite.hpp>
+
+#include <db/BlobCodec.hpp>
+
+#include <Bench.hpp>
+
+using namespace HX;
+
+namespace {
+
+constexpr std::size_t EntryCnt = 100'000;
+constexpr std::size_t Rounds = 50;
+
+template <typename T>
+void benchCodec(std::string_view name, T const& list) {
+    std::string json;
+    reflection::toJson(list, json);
+    auto blob = db::BlobCodec<T>::encode(list);
+    std::printf("%.*s: json %zu bytes, blob %zu bytes\n",
+                static_cast<int>(name.size()), name.data(), json.size(), blob.size());
+    bench::report(std::string{name} + " encode json", Rounds, [&](std::size_t) {
+        std::string res;
+        reflection::toJson(list, res);
+        bench::consume(res.size());
+    });
+    bench::report(std::string{name} + " encode blob", Rounds, [&](std::size_t) {
+        bench::consume(db::BlobCodec<T>::encode(list).size());
+    });
+    bench::report(std::string{name} + " decode json", Rounds, [&](std::size_t) {
+        T res{};
+        reflection::fromJson(res, json);
+        bench::consume(res.size());
+    });
+    bench::report(std::string{name} + " decode blob", Rounds, [&](std::size_t) {
+        bench::consume(db::BlobCodec<T>::decode(blob).size());
+    });
+}
+
+void exec(::sqlite3* db, char const* sql) {
+    char* err = nullptr;
+    if (::sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+        std::fprintf(stderr, "sqlite: %s\n", err);
+        ::sqlite3_free(err);
+        std::exit(1);
+    }
+}
+
+// 同一歌单分别以 TEXT (JSON) 与 BLOB 存一行, 读出并解码
+void benchSqlite(std::vector<uint64_t> const& list) {
+    auto path = bench::tmpDbPath("BlobCodec");
+    ::sqlite3* db = nullptr;
+    ::sqlite3_open(path.c_str(), &db);
+    exec(db, "CREATE TABLE t (id INTEGER PRIMARY KEY, asText TEXT, asBlob BLOB)");
+    std::string json;
+    reflection::toJson(list, json);
+    auto blob = db::BlobCodec<std::vector<uint64_t>>::encode(list);
+    ::sqlite3_stmt* ins = nullptr;
+    ::sqlite3_prepare_v2(db, "INSERT INTO t VALUES (1, ?, ?)", -1, &ins, nullptr);
+    ::sqlite3_bind_text(ins, 1, json.data(), static_cast<int>(json.size()), SQLITE_STATIC);
+    ::sqlite3_bind_blob(ins, 2, blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC);
+    ::sqlite3_step(ins);
+    ::sqlite3_finalize(ins);
+
+    auto read = [&](char const* sql, auto&& decode) {
+        ::sqlite3_stmt* stmt = nullptr;
+        ::sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+        ::sqlite3_step(stmt);
+        auto res = decode(stmt);
+        ::sqlite3_finalize(stmt);
+        return res;
+    };
+    bench::report("sqlite read + decode json", Rounds, [&](std::size_t) {
+        bench::consume(read("SELECT asText FROM t", [](::sqlite3_stmt* stmt) {
+            std::string_view text{
+                reinterpret_cast<char const*>(::sqlite3_column_text(stmt, 0)),
+                static_cast<std::size_t>(::sqlite3_column_bytes(stmt, 0))};
+            std::vector<uint64_t> res;
+            reflection::fromJson(res, text);
+            return res.size();
+        }));
+    });
+    bench::report("sqlite read + decode blob", Rounds, [&](std::size_t) {
+        bench::consume(read("SELECT asBlob FROM t", [](::sqlite3_stmt* stmt) {
+            std::string_view bytes{
+                static_cast<char const*>(::sqlite3_column_blob(stmt, 0)),
+                static_cast<std::size_t>(::sqlite3_column_bytes(stmt, 0))};
+            return db::BlobCodec<std::vector<uint64_t>>::decode(bytes).size();
+        }));
+    });
+    ::sqlite3_close(db);
+    bench::tmpDbPath("BlobCodec");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng{42};
+    std::vector<uint64_t> songIds(EntryCnt);
+    for (auto& id : songIds) {
+        id = rng() % 1'000'000 + 1;
+    }
+    std::vector<std::string> singers(EntryCnt);
+    for (auto& name : singers) {
+        name = "Artist Name " + std::to_string(rng() % 20'000);
+    }
+    benchCodec("songIdList (100k)", songIds);
+    benchCodec("singers (100k)", singers);
+    benchSqlite(songIds);
+}
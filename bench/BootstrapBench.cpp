@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 50 万首歌曲的 MusicDAO 全表加载: 按 rowid 区间并行查询的线程数 (SnapshotOptions::loadThreads)
+
+#include <optional>
+#include <thread>
+
+#include <Catalog.hpp>
+
+using namespace HX;
+
+int main() {
+    constexpr std::size_t TrackCnt = 500'000;
+    auto path = bench::makeCatalogDb("Bootstrap", TrackCnt);
+    std::printf("load %zu tracks, hardware threads: %u\n", TrackCnt, std::thread::hardware_concurrency());
+    for (std::size_t threadCnt : {1, 2, 4, 8}) {
+        std::optional<MusicDAO> dao;
+        auto ms = bench::timeMs([&] {
+            dao.emplace(db::SQLiteDB{path, db::SQLiteOpenOptions::production()},
+                        dao::WriteMode::WriteThrough, dao::SnapshotOptions{false, {}, threadCnt});
+        });
+        std::printf("loadThreads %zu %10.1f ms\n", threadCnt, ms);
+    }
+}
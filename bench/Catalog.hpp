@@ -0,0 +1,68 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <dao/MusicDAO.hpp>
+
+#include <Bench.hpp>
+
+namespace HX::bench {
+
+/**
+ * @brief 第 i 首歌曲; 2 万位歌手, 每人两张专辑, 四分之一的歌曲有合作歌手
+ */
+inline MusicDO makeTrack(std::size_t i) {
+    auto artist = (i * 7919) % 20'000;
+    auto album = artist * 2 + i % 2;
+    std::string singer = "Artist Name " + std::to_string(artist);
+    std::string albumName = "Album Title " + std::to_string(album);
+    std::vector<std::string> singers{singer};
+    if (i % 4 == 0) {
+        singers.push_back("Featured Artist " + std::to_string((i * 31) % 20'000));
+    }
+    return MusicDO{
+        {},
+        singer + "/" + albumName + "/" + std::to_string(i % 12) + " - Track Title " + std::to_string(i) + ".flac",
+        "Track Title " + std::to_string(i),
+        std::move(singers),
+        std::move(albumName),
+        120'000 + (i * 104'729) % 240'000,
+        ".jpg",
+    };
+}
+
+/**
+ * @brief 新建 `HXBench.<name>.db` 并写入 n 首歌曲, 返回数据库路径
+ */
+inline std::string makeCatalogDb(std::string_view name, std::size_t n) {
+    auto path = tmpDbPath(name);
+    MusicDAO dao{db::SQLiteDB{path, db::SQLiteOpenOptions::production()}};
+    std::vector<MusicDO> list;
+    list.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        list.push_back(makeTrack(i));
+    }
+    dao.addMany(std::move(list));
+    return path;
+}
+
+} // namespace HX::bench
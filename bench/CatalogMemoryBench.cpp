@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 50 万首歌曲的常驻内存: 旧的全 std::string 行布局与 MusicDO (路径目录、歌手、专辑驻留)
+// 每种布局在独立的子进程中测量, 互不影响; 也可以 `CatalogMemoryBench old|new` 单独运行
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pojo/do/MusicDO.hpp>
+
+#include <Bench.hpp>
+
+using namespace HX;
+
+namespace {
+
+constexpr std::size_t TrackCnt = 500'000;
+
+// 驻留之前的 MusicDO
+struct OldMusicDO {
+    db::PrimaryKey<uint64_t> id;
+    std::string path;
+    std::string musicName;
+    std::vector<std::string> singers;
+    std::string musicAlbum;
+    uint64_t millisecondsLen;
+    std::string coverSuffix;
+};
+
+template <typename T>
+void run(std::string_view name) {
+    auto before = bench::residentBytes();
+    std::vector<T> rows;
+    rows.reserve(TrackCnt);
+    std::mt19937 rng{7};
+    for (std::size_t i = 0; i < TrackCnt; ++i) {
+        auto artist = rng() % 20'000;
+        auto album = artist * 2 + rng() % 2;
+        std::string singer = "Artist Name Number " + std::to_string(artist);
+        std::string albumName = "Some Album Title Volume " + std::to_string(album);
+        std::string path = singer + "/" + albumName + "/" + std::to_string(i % 12)
+                         + " - Track Title " + std::to_string(i) + ".flac";
+        std::vector<std::string> singers{singer};
+        if (rng() % 4 == 0) {
+            singers.push_back("Featured Artist " + std::to_string(rng() % 20'000));
+        }
+        rows.push_back(T{
+            {i + 1}, std::move(path), "Track Title " + std::to_string(i),
+            std::move(singers), std::move(albumName), 180'000, ".jpg"});
+    }
+    auto used = bench::residentBytes() - before;
+    std::printf("%-12.*s %8.1f MiB  %6.1f B/track\n",
+                static_cast<int>(name.size()), name.data(),
+                static_cast<double>(used) / (1024 * 1024),
+                static_cast<double>(used) / TrackCnt);
+    bench::consume(rows.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string_view mode = argc > 1 ? argv[1] : "";
+    if (mode == "old") {
+        run<OldMusicDO>("std::string");
+    } else if (mode == "new") {
+        run<MusicDO>("MusicDO");
+    } else {
+        std::printf("resident memory of %zu tracks\n", TrackCnt);
+        std::fflush(stdout);
+        std::string self = argv[0];
+        if (std::system((self + " old").c_str()) != 0
+            || std::system((self + " new").c_str()) != 0) {
+            return 1;
+        }
+    }
+}
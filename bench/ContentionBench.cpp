@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 读写争用: 全局读写锁 (ThreadSafeInMemoryDAO) 与分片快照 (ShardedInMemoryDAO)
+// 在 1/4/16/64 个线程下的吞吐; 负载为只读, 以及 95% 读 + 5% 改 (回写模式, 不计落库)
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dao/ShardedInMemoryDAO.hpp>
+#include <dao/ThreadSafeInMemoryDAO.hpp>
+
+#include <Bench.hpp>
+
+using namespace HX;
+
+namespace {
+
+struct ContentionRow {
+    db::PrimaryKey<uint64_t> id;
+    std::string name;
+    int64_t score;
+};
+
+constexpr std::size_t RowCnt = 10'000;
+constexpr std::size_t OpsPerThread = 200'000;
+
+template <typename DAO>
+double run(DAO& dao, std::vector<uint64_t> const& ids, std::size_t threadCnt, unsigned writePct) {
+    std::atomic<bool> isStart{false};
+    std::vector<std::thread> threads;
+    threads.reserve(threadCnt);
+    for (std::size_t t = 0; t < threadCnt; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng{t + 1};
+            std::size_t sum = 0;
+            while (!isStart.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < OpsPerThread; ++i) {
+                auto id = ids[rng() % ids.size()];
+                if (rng() % 100 < writePct) {
+                    int64_t score = static_cast<int64_t>(i);
+                    dao.updateBy(id, db::FieldPair<&ContentionRow::score>{score});
+                } else {
+                    sum += static_cast<std::size_t>(dao.at(id, &ContentionRow::score));
+                }
+            }
+            bench::consume(sum);
+        });
+    }
+    auto ms = bench::timeMs([&] {
+        isStart.store(true, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+    });
+    // 百万次操作每秒
+    return static_cast<double>(threadCnt * OpsPerThread) / ms / 1000;
+}
+
+template <typename DAO>
+void benchDAO(std::string_view name) {
+    auto path = bench::tmpDbPath(std::string{"Contention."} + std::string{name});
+    DAO dao{db::SQLiteDB{path}, dao::WriteMode::WriteBehind};
+    std::vector<ContentionRow> rows;
+    rows.reserve(RowCnt);
+    for (std::size_t i = 0; i < RowCnt; ++i) {
+        rows.push_back({{}, "row " + std::to_string(i), 0});
+    }
+    auto ids = dao.addMany(std::move(rows));
+    dao.flush();
+    for (unsigned writePct : {0u, 5u}) {
+        for (std::size_t threadCnt : {1, 4, 16, 64}) {
+            auto mops = run(dao, ids, threadCnt, writePct);
+            dao.flush();
+            std::printf("%-16.*s %3u%% write %3zu threads %10.2f Mops/s\n",
+                        static_cast<int>(name.size()), name.data(), writePct, threadCnt, mops);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    benchDAO<dao::ThreadSafeInMemoryDAO<ContentionRow>>("ThreadSafe");
+    benchDAO<dao::ShardedInMemoryDAO<ContentionRow>>("Sharded");
+}
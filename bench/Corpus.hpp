@@ -0,0 +1,92 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace HX::bench {
+
+/**
+ * @brief 合成的曲库文本: 拉丁字母词与 CJK (含片假名) 单字, 取用频率近似幂律分布
+ */
+struct Corpus {
+    explicit Corpus(uint32_t seed = 42)
+        : _rng{seed}
+    {
+        constexpr char const* Syllables[] = {
+            "la", "mo", "ri", "ka", "son", "tel", "de", "vi", "na",
+            "lo", "sun", "ny", "day", "love", "night", "sky", "rain", "fire",
+        };
+        constexpr std::size_t SyllableCnt = std::size(Syllables);
+        words.reserve(20'000);
+        for (std::size_t i = 0; i < 20'000; ++i) {
+            std::string word;
+            for (auto n = 2 + _rng() % 3; n--;) {
+                word += Syllables[_rng() % SyllableCnt];
+            }
+            words.push_back(std::move(word));
+        }
+        han.reserve(3'000);
+        for (std::size_t i = 0; i < 3'000; ++i) {
+            char32_t cp = i % 4 == 0 ? 0x30A1 + _rng() % 80 : 0x4E00 + _rng() % 3'000;
+            std::string ch;
+            ch += static_cast<char>(0xE0 | (cp >> 12));
+            ch += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            ch += static_cast<char>(0x80 | (cp & 0x3F));
+            han.push_back(std::move(ch));
+        }
+    }
+
+    /**
+     * @brief [0, n) 中的下标, 越小越常见
+     */
+    std::size_t zipf(std::size_t n) {
+        auto x = static_cast<double>(_rng()) / static_cast<double>(decltype(_rng)::max());
+        return static_cast<std::size_t>(std::pow(x, 3) * static_cast<double>(n)) % n;
+    }
+
+    /**
+     * @brief n 个词 (以空格分隔) 或 n 个 CJK 字组成的短语
+     */
+    std::string phrase(std::size_t n, bool isCjk) {
+        std::string res;
+        while (n--) {
+            if (isCjk) {
+                res += han[zipf(han.size())];
+            } else {
+                res += words[zipf(words.size())];
+                res += ' ';
+            }
+        }
+        return res;
+    }
+
+    std::vector<std::string> words;
+    std::vector<std::string> han;
+
+private:
+    std::mt19937 _rng;
+};
+
+} // namespace HX::bench
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 分组索引 (utils::GroupIndex): 50 万首歌曲按歌手 (幂律分布) 与专辑分组的建立、增量加入与分页
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <utils/GroupIndex.hpp>
+
+#include <Bench.hpp>
+
+using namespace HX;
+
+int main() {
+    constexpr std::size_t TrackCnt = 500'000;
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<> uniform{0, 1};
+    std::vector<std::string> singers(TrackCnt), albums(TrackCnt);
+    for (std::size_t i = 0; i < TrackCnt; ++i) {
+        singers[i] = "artist" + std::to_string(static_cast<int>(std::pow(20'000.0, uniform(rng))));
+        albums[i] = "album" + std::to_string(rng() % 60'000);
+    }
+
+    utils::GroupIndex<uint64_t> bySinger, byAlbum;
+    auto buildMs = bench::timeMs([&] {
+        bySinger.beginBulk();
+        byAlbum.beginBulk();
+        for (std::size_t i = 0; i < TrackCnt; ++i) {
+            bySinger.add(singers[i], i + 1, 200'000);
+            byAlbum.add(albums[i], i + 1, 200'000);
+        }
+        bySinger.endBulk();
+        byAlbum.endBulk();
+    });
+    std::printf("bulk build %zu tracks: %.1f ms, %zu singers, %zu albums\n",
+                TrackCnt, buildMs, bySinger.size(), byAlbum.size());
+
+    // artist1 是最大的分组
+    bench::report("add to the largest group", 10'000, [&](std::size_t i) {
+        bySinger.add("artist1", TrackCnt + 1 + i, 1);
+    });
+    bench::report("groups page (50)", 10'000, [&](std::size_t) {
+        bench::consume(bySinger.groups("artist" + std::to_string(rng() % 20'000), 50).size());
+    });
+    bench::report("ids page (50) in the largest group", 10'000, [&](std::size_t) {
+        bench::consume(bySinger.ids("artist1", rng() % TrackCnt, 50).size());
+    });
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 50 万首歌曲的启动加载: 全表查询与二进制快照
+// MusicDAO 的加载包含二级索引的重建; 同字段但不声明索引的表只计行的解码
+
+#include <filesystem>
+#include <optional>
+
+#include <Catalog.hpp>
+
+using namespace HX;
+
+namespace {
+
+constexpr std::size_t TrackCnt = 500'000;
+
+// 与 MusicDO 字段相同, 但没有二级索引
+struct CatalogRow {
+    db::PrimaryKey<uint64_t> id;
+    utils::CompactPath path;
+    std::string musicName;
+    utils::SymbolList singers;
+    utils::Symbol musicAlbum;
+    uint64_t millisecondsLen;
+    std::string coverSuffix;
+};
+
+template <typename DAO>
+double loadMs(std::string const& path, dao::SnapshotOptions const& snapshot) {
+    std::optional<DAO> dao;
+    // 只计构造; 析构 (及写快照) 不计入
+    return bench::timeMs([&] {
+        dao.emplace(db::SQLiteDB{path, db::SQLiteOpenOptions::production()},
+                    dao::WriteMode::WriteThrough, snapshot);
+    });
+}
+
+template <typename DAO, typename Row>
+void benchLoad(std::string_view name) {
+    auto path = bench::tmpDbPath(std::string{"SnapshotLoad."} + std::string{name});
+    {
+        DAO dao{db::SQLiteDB{path, db::SQLiteOpenOptions::production()}};
+        std::vector<Row> list;
+        list.reserve(TrackCnt);
+        for (std::size_t i = 0; i < TrackCnt; ++i) {
+            auto t = bench::makeTrack(i);
+            list.push_back(Row{{}, std::move(t.path), std::move(t.musicName), std::move(t.singers),
+                               std::move(t.musicAlbum), t.millisecondsLen, std::move(t.coverSuffix)});
+        }
+        dao.addMany(std::move(list));
+    }
+    dao::SnapshotOptions snapshot{true, {}};
+    auto fullMs = loadMs<DAO>(path, {});
+    // 首次启用快照时仍是全表加载, 析构时写出快照
+    loadMs<DAO>(path, snapshot);
+    auto snapMs = loadMs<DAO>(path, snapshot);
+    std::string snapPath;
+    for (auto const& entry : std::filesystem::directory_iterator{std::filesystem::path{path}.parent_path()}) {
+        if (auto str = entry.path().string(); str.starts_with(path) && str.ends_with(".snap")) {
+            snapPath = str;
+        }
+    }
+    std::printf("%-12.*s full %8.1f ms  snapshot %8.1f ms  (%.1f MiB)\n",
+                static_cast<int>(name.size()), name.data(), fullMs, snapMs,
+                static_cast<double>(std::filesystem::file_size(snapPath)) / (1024 * 1024));
+}
+
+} // namespace
+
+int main() {
+    std::printf("load %zu tracks\n", TrackCnt);
+    benchLoad<dao::ShardedInMemoryDAO<CatalogRow, 16, dao::PersistentIdStorage>, CatalogRow>("rows only");
+    benchLoad<MusicDAO, MusicDO>("MusicDAO");
+}
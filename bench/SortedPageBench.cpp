@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 排序分页 (utils::OrderStatIndex): 50 万个歌名键的建立、插入、任意偏移分页、游标定位与删除
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <utils/OrderStatIndex.hpp>
+#include <utils/TextTokenizer.hpp>
+
+#include <Bench.hpp>
+
+using namespace HX;
+
+int main() {
+    constexpr std::size_t TrackCnt = 500'000;
+    std::mt19937 rng{1};
+    std::vector<std::string> names(TrackCnt);
+    for (auto& name : names) {
+        name = "Song Title ";
+        for (int i = 0; i < 8; ++i) {
+            name += static_cast<char>('a' + rng() % 26);
+        }
+    }
+
+    utils::OrderStatIndex<std::string, uint64_t> index;
+    auto buildMs = bench::timeMs([&] {
+        index.beginBulk();
+        for (std::size_t i = 0; i < TrackCnt; ++i) {
+            index.insert(utils::TextTokenizer::normalize(names[i]), i + 1);
+        }
+        index.endBulk();
+    });
+    std::printf("bulk build %zu keys (with normalize): %.1f ms\n", TrackCnt, buildMs);
+
+    bench::report("insert at random position", 20'000, [&](std::size_t i) {
+        index.insert(utils::TextTokenizer::normalize(names[rng() % TrackCnt] + "x"), TrackCnt + 1 + i);
+    });
+    bench::report("page (50) at random offset", 20'000, [&](std::size_t i) {
+        bench::consume(index.slice(rng() % index.size(), 50, i & 1).size());
+    });
+    bench::report("rank of cursor row", 20'000, [&](std::size_t) {
+        auto j = rng() % TrackCnt;
+        bench::consume(index.rankOf(utils::TextTokenizer::normalize(names[j]), j + 1));
+    });
+    bench::report("erase", 20'000, [&](std::size_t) {
+        auto j = rng() % TrackCnt;
+        index.erase(utils::TextTokenizer::normalize(names[j]), j + 1);
+    });
+}
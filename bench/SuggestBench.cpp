@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 输入提示 (utils::SuggestTrie): 50 万首歌曲的批量建树、增量加入、前缀查询与权重下降
+
+#include <utils/SuggestTrie.hpp>
+
+#include <Bench.hpp>
+#include <Corpus.hpp>
+
+using namespace HX;
+
+int main() {
+    constexpr std::size_t TrackCnt = 500'000;
+    constexpr std::size_t IncrementalCnt = 10'000;
+    bench::Corpus corpus;
+    std::vector<std::string> singers, albums, names(TrackCnt);
+    for (std::size_t i = 0; i < 5'000; ++i) {
+        singers.push_back(corpus.phrase(2, i % 3 == 0));
+    }
+    for (std::size_t i = 0; i < 20'000; ++i) {
+        albums.push_back(corpus.phrase(2, i % 3 == 0));
+    }
+    for (std::size_t i = 0; i < TrackCnt; ++i) {
+        bool isCjk = i % 3 == 0;
+        names[i] = corpus.phrase(isCjk ? 4 : 3, isCjk);
+    }
+    auto addTrack = [&](utils::SuggestTrie<>& trie, std::size_t i) {
+        trie.add(0, names[i], 1);
+        trie.add(1, singers[corpus.zipf(singers.size())], 1);
+        trie.add(2, albums[corpus.zipf(albums.size())], 1);
+    };
+
+    auto before = bench::residentBytes();
+    utils::SuggestTrie<> trie;
+    auto buildMs = bench::timeMs([&] {
+        trie.beginBulk();
+        for (std::size_t i = 0; i < TrackCnt - IncrementalCnt; ++i) {
+            addTrack(trie, i);
+        }
+        trie.endBulk();
+    });
+    std::printf("bulk build %zu tracks: %.1f ms, %zu nodes, +%.1f MiB\n",
+                TrackCnt - IncrementalCnt, buildMs, trie.nodeCnt(),
+                static_cast<double>(bench::residentBytes() - before) / (1024 * 1024));
+
+    bench::report("incremental add track", IncrementalCnt, [&](std::size_t i) {
+        addTrack(trie, TrackCnt - IncrementalCnt + i);
+    });
+
+    auto const& words = corpus.words;
+    std::vector<std::string> prefixes{
+        "l", "lo", "love", "lovesun", words[100].substr(0, 4),
+        corpus.han[1], corpus.han[1] + corpus.han[2], "zz",
+    };
+    for (auto const& prefix : prefixes) {
+        bench::report("suggest \"" + prefix + "\"", 20'000, [&](std::size_t) {
+            bench::consume(trie.suggest(prefix, 10).size());
+        });
+    }
+
+    bench::report("remove track title", 100'000, [&](std::size_t i) {
+        trie.add(0, names[i], -1);
+    });
+}
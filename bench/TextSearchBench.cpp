@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// 全文检索 (utils::TextIndex): 50 万首歌曲 (歌名、歌手、专辑、路径) 的建立、各类查询与大批删除
+
+#include <utility>
+
+#include <utils/TextIndex.hpp>
+
+#include <Bench.hpp>
+#include <Corpus.hpp>
+
+using namespace HX;
+
+int main() {
+    constexpr std::size_t TrackCnt = 500'000;
+    bench::Corpus corpus;
+    std::vector<std::string> singers, albums, names(TrackCnt);
+    for (std::size_t i = 0; i < 5'000; ++i) {
+        singers.push_back(corpus.phrase(2, i % 3 == 0));
+    }
+    for (std::size_t i = 0; i < 20'000; ++i) {
+        albums.push_back(corpus.phrase(2, i % 3 == 0));
+    }
+    for (std::size_t i = 0; i < TrackCnt; ++i) {
+        bool isCjk = i % 3 == 0;
+        names[i] = corpus.phrase(isCjk ? 4 : 3, isCjk);
+    }
+
+    utils::TextIndex<uint64_t, 4> index;
+    index.reserve(TrackCnt);
+    auto buildMs = bench::timeMs([&] {
+        for (std::size_t i = 0; i < TrackCnt; ++i) {
+            auto const& singer = singers[corpus.zipf(singers.size())];
+            auto const& album = albums[corpus.zipf(albums.size())];
+            std::string path = singer + "/" + album + "/" + names[i] + ".mp3";
+            index.insert(i + 1, [&](auto&& sink) {
+                sink(0, names[i]);
+                sink(1, singer);
+                sink(2, album);
+                sink(3, path);
+            });
+        }
+    });
+    std::printf("build %zu tracks: %.1f ms, %zu terms\n", TrackCnt, buildMs, index.termCnt());
+
+    auto const& words = corpus.words;
+    std::vector<std::pair<std::string_view, std::string>> queries{
+        {"common word", words[0]},
+        {"rare word", words[15'000]},
+        {"two common words", words[0] + " " + words[1]},
+        {"full title", names[1]},
+        {"full cjk title", names[3]},
+        {"cjk two chars", names[3].substr(0, 6)},
+        {"cjk one char", corpus.han[1]},
+        {"file suffix", "mp3"},
+        {"no match", "zzzz"},
+    };
+    for (auto const& [name, query] : queries) {
+        bench::report(std::string{"search "} + std::string{name}, 200, [&](std::size_t) {
+            bench::consume(index.search(query, 20).size());
+        });
+    }
+
+    auto eraseMs = bench::timeMs([&] {
+        for (std::size_t i = 0; i < 300'000; ++i) {
+            index.erase(i + 1);
+        }
+    });
+    std::printf("erase 300k tracks (with compaction): %.1f ms, %zu left\n", eraseMs, index.size());
+}
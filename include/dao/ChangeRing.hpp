@@ -0,0 +1,126 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <db/SQLiteChangeLog.hpp>
+
+namespace HX::dao {
+
+/**
+ * @brief 一条内存中的变更记录
+ * @tparam Id 主键类型
+ */
+template <typename Id>
+struct ChangeEntry {
+    uint64_t version;
+    Id id;
+    db::ChangeOp op;
+};
+
+/**
+ * @brief changesSince 的结果
+ * @tparam Id 主键类型
+ */
+template <typename Id>
+struct ChangeSet {
+    uint64_t version;                       // 当前版本, 作为下次查询的 since
+    bool isResync;                          // since 之后的记录已被淘汰 (或 since 来自上次启动), 需要全量刷新
+    std::vector<ChangeEntry<Id>> changes;   // 每个主键只保留最后一次变更, 按版本升序
+};
+
+/**
+ * @brief 有界的变更环: 为每次修改分配单调递增的版本号, 并保留最近的 capacity 条 (版本, 操作, 主键)
+ * @note 初始版本取启动时刻的微秒时间戳, 因此重启后的版本号总是大于上次运行中客户端持有的版本号,
+ *       旧版本号会被判定为需要全量刷新. 仅在内存中, 不持久化.
+ * @tparam Id 主键类型
+ */
+template <typename Id>
+class ChangeRing {
+public:
+    explicit ChangeRing(std::size_t capacity)
+        : _capacity{capacity}
+        , _version{static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count())}
+        , _floor{_version}
+    {}
+
+    /**
+     * @brief 记录一次变更
+     * @warning 需要在修改对读者可见之后、释放该行的写锁之前调用,
+     *          以保证读到版本 v 的客户端也能读到 v 之前的全部修改
+     * @return uint64_t 该次变更的版本
+     */
+    uint64_t record(Id id, db::ChangeOp op) {
+        std::lock_guard _{_mtx};
+        if (_entries.size() == _capacity) {
+            _floor = _entries.front().version;
+            _entries.pop_front();
+        }
+        _entries.push_back({++_version, id, op});
+        return _version;
+    }
+
+    /**
+     * @brief 当前版本
+     */
+    uint64_t version() const {
+        std::lock_guard _{_mtx};
+        return _version;
+    }
+
+    /**
+     * @brief 取得 since 之后的变更
+     * @param since 客户端上次取得的版本
+     * @return ChangeSet<Id>
+     */
+    ChangeSet<Id> since(uint64_t since) const {
+        std::lock_guard _{_mtx};
+        ChangeSet<Id> res{_version, false, {}};
+        if (since < _floor || since > _version) {
+            res.isResync = true;
+            return res;
+        }
+        // 记录按版本升序, 从后往前取, 每个主键只保留最后一次
+        std::unordered_set<Id> seen;
+        for (auto it = _entries.rbegin(); it != _entries.rend() && it->version > since; ++it) {
+            if (seen.insert(it->id).second) {
+                res.changes.push_back(*it);
+            }
+        }
+        std::reverse(res.changes.begin(), res.changes.end());
+        return res;
+    }
+private:
+    std::size_t _capacity;
+    mutable std::mutex _mtx{};
+    std::deque<ChangeEntry<Id>> _entries{};
+    uint64_t _version;
+    // 已淘汰的最后一条记录的版本; since 小于它时, 中间的记录已丢失
+    uint64_t _floor;
+};
+
+} // namespace HX::dao
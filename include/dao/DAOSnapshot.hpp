@@ -0,0 +1,105 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <HXLibs/log/Log.hpp>
+
+namespace HX::dao {
+
+/**
+ * @brief 内存 DAO 的启动加载与二进制快照配置 (见 db::RowSnapshot, db::parallelScan)
+ * @note 快照文件为 `数据库文件路径.表名.snap`; 内存数据库不会使用快照, 也不会并行加载.
+ */
+struct SnapshotOptions {
+    bool isEnabled = false;                 // 启动时优先从快照加载, 并在析构时写快照
+    std::chrono::milliseconds interval{0};  // 定期写快照的间隔, 0 为只在析构时写
+    std::size_t loadThreads = 1;            // 全表加载时按 rowid 区间并行查询的线程数, 1 为不并行
+
+    /**
+     * @brief 生产环境配置: 启用快照, 每 10 分钟写一次; 全表加载时最多用 8 个线程
+     * @return SnapshotOptions
+     */
+    static SnapshotOptions production() noexcept {
+        return {
+            true,
+            std::chrono::minutes{10},
+            std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 8),
+        };
+    }
+};
+
+namespace internal {
+
+/**
+ * @brief 定期写快照的后台线程
+ */
+class PeriodicSnapshotter {
+public:
+    PeriodicSnapshotter(std::chrono::milliseconds interval, std::function<void()> save)
+        : _interval{interval}
+        , _save{std::move(save)}
+    {
+        _thread = std::jthread{[this](std::stop_token token) {
+            run(token);
+        }};
+    }
+
+    PeriodicSnapshotter& operator=(PeriodicSnapshotter&&) noexcept = delete;
+
+    ~PeriodicSnapshotter() noexcept {
+        _thread.request_stop();
+        _cv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+private:
+    void run(std::stop_token token) {
+        std::unique_lock lck{_mtx};
+        for (;;) {
+            // 只会因超时或者请求停止而返回
+            _cv.wait_for(lck, token, _interval, [] { return false; });
+            if (token.stop_requested()) {
+                break;
+            }
+            try {
+                _save();
+            } catch (std::exception const& e) {
+                log::hxLog.warning("写快照失败:", e.what());
+            }
+        }
+    }
+
+    std::chrono::milliseconds _interval;
+    std::function<void()> _save;
+    std::mutex _mtx{};
+    std::condition_variable_any _cv{};
+    std::jthread _thread{};
+};
+
+} // namespace internal
+
+} // namespace HX::dao
@@ -0,0 +1,304 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace HX::dao {
+
+namespace internal {
+
+/**
+ * @brief 以主键为下标的连续存储, 接口与 std::map 的常用部分一致 (按主键升序遍历).
+ *        删除只在墓碑位图上做标记, 尾部的空位会被回收.
+ * @note 适用于近乎连续的主键 (如 sqlite 的自增 rowid); 占用与最大主键成正比, 而非行数.
+ * @tparam Key 整数主键
+ * @tparam V
+ * @tparam Stride 主键的步长: 按主键取模分片时, 同一分片中的主键模 Stride 同余,
+ *         以 key / Stride 作为下标即可避免空位
+ */
+template <typename Key, typename V, std::size_t Stride = 1>
+class DenseIdMap {
+    static_assert(Stride > 0, "Stride must be greater than 0");
+public:
+    using key_type = Key;
+    using mapped_type = V;
+    using value_type = std::pair<Key const, V>;
+    using size_type = std::size_t;
+
+    template <bool IsConst>
+    class Iterator {
+        using MapPtr = std::conditional_t<IsConst, DenseIdMap const*, DenseIdMap*>;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = DenseIdMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        // 元素并非以 pair 存放, 因此解引用得到的是 (主键, 值的引用) 对
+        using reference = std::pair<Key const, std::conditional_t<IsConst, V const&, V&>>;
+
+        struct pointer {
+            reference ref;
+
+            reference const* operator->() const noexcept {
+                return &ref;
+            }
+        };
+
+        Iterator() = default;
+
+        // 可由非 const 迭代器转换; 写成模板以免成为 Iterator<false> 的拷贝构造函数
+        template <bool IsOtherConst>
+            requires (IsConst && !IsOtherConst)
+        Iterator(Iterator<IsOtherConst> const& it) noexcept
+            : _mp{it._mp}
+            , _slot{it._slot}
+        {}
+
+        reference operator*() const noexcept {
+            return {_mp->toKey(_slot), _mp->_data[_slot]};
+        }
+
+        pointer operator->() const noexcept {
+            return {**this};
+        }
+
+        Iterator& operator++() noexcept {
+            _slot = _mp->nextAlive(_slot + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+
+        bool operator==(Iterator const& that) const noexcept {
+            return _slot == that._slot;
+        }
+    private:
+        friend class DenseIdMap;
+        template <bool>
+        friend class Iterator;
+
+        Iterator(MapPtr mp, std::size_t slot) noexcept
+            : _mp{mp}
+            , _slot{slot}
+        {}
+
+        MapPtr _mp{};
+        std::size_t _slot{};
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return {this, nextAlive(0)};
+    }
+
+    const_iterator begin() const noexcept {
+        return {this, nextAlive(0)};
+    }
+
+    iterator end() noexcept {
+        return {this, _data.size()};
+    }
+
+    const_iterator end() const noexcept {
+        return {this, _data.size()};
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    bool contains(Key const& key) const noexcept {
+        return isAlive(findSlot(key));
+    }
+
+    iterator find(Key const& key) noexcept {
+        auto slot = findSlot(key);
+        return {this, isAlive(slot) ? slot : _data.size()};
+    }
+
+    const_iterator find(Key const& key) const noexcept {
+        auto slot = findSlot(key);
+        return {this, isAlive(slot) ? slot : _data.size()};
+    }
+
+    /**
+     * @brief 第一个不小于 key 的元素, O(空位数)
+     */
+    const_iterator lower_bound(Key const& key) const noexcept {
+        auto k = static_cast<std::size_t>(key);
+        auto slot = k <= _residue ? 0 : (k - _residue + Stride - 1) / Stride;
+        return {this, nextAlive(slot)};
+    }
+
+    V& at(Key const& key) {
+        auto slot = findSlot(key);
+        if (!isAlive(slot)) [[unlikely]] {
+            throw std::out_of_range{"DenseIdMap::at: key not found"};
+        }
+        return _data[slot];
+    }
+
+    V const& at(Key const& key) const {
+        auto slot = findSlot(key);
+        if (!isAlive(slot)) [[unlikely]] {
+            throw std::out_of_range{"DenseIdMap::at: key not found"};
+        }
+        return _data[slot];
+    }
+
+    V& operator[](Key const& key) {
+        return emplace(key).first->second;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Key const& key, Args&&... args) {
+        auto slot = prepare(key);
+        if (_alive[slot]) {
+            return {{this, slot}, false};
+        }
+        _data[slot] = V(std::forward<Args>(args)...);
+        _alive[slot] = true;
+        ++_size;
+        return {{this, slot}, true};
+    }
+
+    template <typename U>
+    std::pair<iterator, bool> insert_or_assign(Key const& key, U&& u) {
+        auto slot = prepare(key);
+        _data[slot] = std::forward<U>(u);
+        if (_alive[slot]) {
+            return {{this, slot}, false};
+        }
+        _alive[slot] = true;
+        ++_size;
+        return {{this, slot}, true};
+    }
+
+    void erase(const_iterator it) {
+        eraseSlot(it._slot);
+    }
+
+    size_type erase(Key const& key) {
+        auto slot = findSlot(key);
+        if (!isAlive(slot)) {
+            return 0;
+        }
+        eraseSlot(slot);
+        return 1;
+    }
+
+    void clear() noexcept {
+        _data.clear();
+        _alive.clear();
+        _size = 0;
+    }
+private:
+    std::size_t toSlot(Key const& key) const noexcept {
+        return static_cast<std::size_t>(key) / Stride;
+    }
+
+    // 余数不符的主键不可能存在, 返回越界的下标
+    std::size_t findSlot(Key const& key) const noexcept {
+        return static_cast<std::size_t>(key) % Stride == _residue
+            ? toSlot(key)
+            : _alive.size();
+    }
+
+    Key toKey(std::size_t slot) const noexcept {
+        return static_cast<Key>(slot * Stride + _residue);
+    }
+
+    bool isAlive(std::size_t slot) const noexcept {
+        return slot < _alive.size() && _alive[slot];
+    }
+
+    std::size_t nextAlive(std::size_t slot) const noexcept {
+        while (slot < _alive.size() && !_alive[slot]) {
+            ++slot;
+        }
+        return std::min(slot, _alive.size());
+    }
+
+    std::size_t prepare(Key const& key) {
+        if (_size == 0) {
+            _residue = static_cast<std::size_t>(key) % Stride;
+        } else if (static_cast<std::size_t>(key) % Stride != _residue) [[unlikely]] {
+            throw std::invalid_argument{"DenseIdMap: key does not match the stride"};
+        }
+        auto slot = toSlot(key);
+        if (slot >= _data.size()) {
+            _data.resize(slot + 1);
+            _alive.resize(slot + 1, false);
+        }
+        return slot;
+    }
+
+    void eraseSlot(std::size_t slot) {
+        _data[slot] = V{};
+        _alive[slot] = false;
+        --_size;
+        // 回收尾部的空位, 保证 end() 紧跟最后一个元素
+        while (!_alive.empty() && !_alive.back()) {
+            _alive.pop_back();
+            _data.pop_back();
+        }
+    }
+
+    std::vector<V> _data{};
+    std::vector<bool> _alive{};     // 墓碑位图: false 为已删除或未使用
+    std::size_t _size = 0;
+    std::size_t _residue = 0;       // 所有主键模 Stride 的余数
+};
+
+} // namespace internal
+
+/**
+ * @brief 内存 DAO 的存储策略: 有序的 std::map (默认), 适用于任意主键
+ */
+struct OrderedMapStorage {
+    template <typename Key, typename V, std::size_t Stride = 1>
+    using Type = std::map<Key, V>;
+};
+
+/**
+ * @brief 内存 DAO 的存储策略: 以主键为下标的连续存储, 适用于近乎连续的自增主键
+ */
+struct DenseIdStorage {
+    template <typename Key, typename V, std::size_t Stride = 1>
+    using Type = internal::DenseIdMap<Key, V, Stride>;
+};
+
+} // namespace HX::dao
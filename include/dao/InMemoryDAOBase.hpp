@@ -0,0 +1,485 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <HXLibs/log/Log.hpp>
+#include <HXLibs/reflection/MemberName.hpp>
+
+#include <db/SQLiteMeta.hpp>
+#include <db/SQLiteDB.hpp>
+#include <db/RowSnapshot.hpp>
+#include <db/SQLiteParallelScan.hpp>
+#include <dao/WriteBehindQueue.hpp>
+#include <dao/WriteGroup.hpp>
+#include <dao/DAOSnapshot.hpp>
+#include <dao/ChangeRing.hpp>
+#include <dao/MemoryIndex.hpp>
+
+namespace HX::dao::internal {
+
+/**
+ * @brief 内存 DAO 的公共部分: 建表/预编译, 以及直写 (WriteThrough) 与回写 (WriteBehind) 两种持久化方式.
+ * @note 内存中的数据如何存放与加锁由派生类决定; 本类只保证对数据库连接的访问是串行的.
+ * @tparam T
+ */
+template <typename T>
+struct InMemoryDAOBase {
+    using PrimaryKeyType = db::RemovePrimaryKeyType<meta::remove_cvref_t<decltype(
+        std::get<
+            db::GetFirstPrimaryKeyIndex<T>
+        >(reflection::internal::getObjTie(std::declval<T>()))
+    )>>;
+
+    // T 声明的二级索引 (见 db::Index)
+    using IndexSetType = IndexSet<T, PrimaryKeyType, db::GetIndexList<T>>;
+
+    InMemoryDAOBase& operator=(InMemoryDAOBase&&) noexcept = delete;
+
+    /**
+     * @brief 是否为回写模式
+     */
+    bool isWriteBehind() const noexcept {
+        return static_cast<bool>(_writer);
+    }
+
+    /**
+     * @brief 持久化屏障: 阻塞直到此前的所有写操作都已提交到数据库; 直写模式下立即返回
+     */
+    void flush() {
+        if (_writer) {
+            _writer->flush();
+        }
+    }
+
+    /**
+     * @brief 异步的持久化屏障, 用于协程中 `co_await dao->flushAsync().via(io)`
+     * @warning 仅回写模式可用, 请先用 isWriteBehind() 判断
+     * @return container::FutureResult<>
+     */
+    container::FutureResult<> flushAsync() {
+        if (!_writer) [[unlikely]] {
+            throw std::runtime_error{"flushAsync: not in WriteBehind mode"};
+        }
+        return _writer->flushAsync();
+    }
+
+    /**
+     * @brief 获取后台写线程的统计; 直写模式下为空
+     * @return std::optional<WriteBehindStats>
+     */
+    std::optional<WriteBehindStats> getWriteBehindStats() const noexcept {
+        if (!_writer) {
+            return {};
+        }
+        return _writer->getStats();
+    }
+
+    /**
+     * @brief 当前的变更版本, 每次增删改递增
+     * @return uint64_t
+     */
+    uint64_t getVersion() const {
+        return _changes.version();
+    }
+
+    /**
+     * @brief 取得版本 since 之后变更过的主键; 记录已被淘汰时返回需要全量刷新
+     * @param since 上次取得的版本 (见 ChangeSet::version)
+     * @return ChangeSet<PrimaryKeyType>
+     */
+    ChangeSet<PrimaryKeyType> getChangesSince(uint64_t since) const {
+        return _changes.since(since);
+    }
+
+    /**
+     * @brief 不修改数据, 只记录一次该行的变更; 用于由其他表派生的内容 (如歌单的歌曲列表) 变化时
+     * @param id
+     */
+    void touch(PrimaryKeyType id) {
+        _changes.record(id, db::ChangeOp::Upsert);
+    }
+
+    /**
+     * @brief 获取底层数据库的预编译语句缓存统计
+     * @note 回写模式下会等待此前的写操作提交, 不要在 IO 线程中调用;
+     *       加入写组时为本 DAO 用于加载的连接, 写操作的统计见 WriteGroup::getStmtCacheStats
+     * @return db::StmtCacheStats
+     */
+    db::StmtCacheStats getStmtCacheStats() const {
+        return inspectDb([](db::SQLiteDB const& db) {
+            return db.getStmtCacheStats();
+        });
+    }
+
+    /**
+     * @brief 获取底层数据库每条语句的执行统计 (按总耗时降序)
+     * @note 同 getStmtCacheStats; 写组连接的统计见 WriteGroup::getStmtProfile
+     * @return std::vector<db::StmtProfile>
+     */
+    std::vector<db::StmtProfile> getStmtProfile() const {
+        return inspectDb([](db::SQLiteDB const& db) {
+            return db.getStmtProfile();
+        });
+    }
+protected:
+    /**
+     * @brief 建表, 并预编译增删改语句; 派生类随后自行加载数据
+     * @param db
+     * @param isGrouped 是否将加入写组; 是则 db 只用于加载, 增删改语句改为在写组的连接上预编译 (见 startWriteBehind)
+     */
+    explicit InMemoryDAOBase(db::SQLiteDB db, bool isGrouped = false)
+        : _db{std::move(db)}
+    {
+        _db.createDatabase<T>();
+        _db.createChangeLog<T>();
+        _db.migrateTextToBlob<T>();
+        if (!isGrouped) {
+            // 提前预编译增删改语句, 避免请求路径上首次调用时的 prepare 开销
+            _db.prepareInsert<T>();
+            _db.prepareUpdate<T, "where ", PrimaryKeyName, "=?">();
+            _db.prepareDelete<T, "where ", PrimaryKeyName, "=?">();
+        }
+    }
+
+    /**
+     * @brief 加载整张表: 有有效的快照时从快照解码, 再从数据库补上快照之后变更过的行;
+     *        否则全表查询, 行数足够多时按 rowid 区间并行查询 (见 SnapshotOptions::loadThreads)
+     * @param opts 快照配置
+     * @param reserve 形如 `(std::size_t) -> void`, 在接收第一行之前以 (大约的) 行数调用一次
+     * @param func 形如 `(T&&) -> void`, 在调用线程中逐行接收; 行的顺序不定
+     * @return PrimaryKeyType 最大的主键
+     */
+    template <typename Reserve, typename Func>
+    PrimaryKeyType loadRows(SnapshotOptions const& opts, Reserve&& reserve, Func&& func) {
+        // 少于该行数时, 开连接与线程的开销比并行节省的还多
+        constexpr std::size_t ParallelMinRows = 50'000;
+        auto beginTime = std::chrono::steady_clock::now();
+        auto path = _db.getFilePath();
+        if (opts.isEnabled && !path.empty()) {
+            _snapshotPath = path;
+            _snapshotPath += '.';
+            _snapshotPath += reflection::getTypeName<T>();
+            _snapshotPath += ".snap";
+        }
+        PrimaryKeyType maxId{};
+        std::size_t rowCnt = 0;
+        auto onRow = [&](T&& t) {
+            maxId = std::max(maxId, static_cast<PrimaryKeyType>(db::getFirstPrimaryKeyRef<T>(t)));
+            ++rowCnt;
+            func(std::move(t));
+        };
+        std::string_view from = "快照";
+        if (_snapshotPath.empty() || !loadSnapshot(reserve, onRow)) {
+            auto cnt = _db.template count<T>();
+            reserve(cnt);
+            auto range = _db.template getRowIdRange<T>();
+            if (opts.loadThreads > 1 && cnt >= ParallelMinRows && !path.empty() && range) {
+                from = "并行查询";
+                db::parallelScan<T>(path, *range, opts.loadThreads, onRow);
+            } else {
+                from = "全表查询";
+                for (auto&& t : _db.template query<T>()) {
+                    onRow(std::move(t));
+                }
+            }
+        }
+        log::hxLog.info("加载", reflection::getTypeName<T>(), "来自:", from, "行数:", rowCnt,
+            "耗时:", std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - beginTime).count(), "ms");
+        return maxId;
+    }
+
+    /**
+     * @brief 开始定期写快照, 并记录析构时用于写最后一次快照的函数
+     * @param opts 快照配置
+     * @param save 派生类的 saveSnapshot
+     */
+    void startSnapshotter(SnapshotOptions const& opts, std::function<void()> save) {
+        if (_snapshotPath.empty()) {
+            return;
+        }
+        _saveSnapshot = std::move(save);
+        if (opts.interval.count() > 0) {
+            _snapshotter = std::make_unique<PeriodicSnapshotter>(opts.interval, _saveSnapshot);
+        }
+    }
+
+    /**
+     * @brief 停止定期写快照, 并写最后一次快照
+     * @warning 需要在派生类的析构函数中调用, 此时派生类的数据仍然有效
+     */
+    void stopSnapshotter() noexcept {
+        _snapshotter.reset();
+        if (_saveSnapshot) {
+            try {
+                _saveSnapshot();
+            } catch (std::exception const& e) {
+                log::hxLog.warning("写快照失败:", _snapshotPath, e.what());
+            }
+            _saveSnapshot = {};
+        }
+    }
+
+    bool isSnapshotEnabled() const noexcept {
+        return !_snapshotPath.empty();
+    }
+
+    /**
+     * @brief 写一次快照
+     * @note 先在不持有任何 DAO 锁时取得变更序号 (独占写线程时会等待此前的写操作提交);
+     *       内存总是不落后于数据库, 因此该序号之前的修改都已在随后取得的行中.
+     *       行中超前于该序号的修改在快照生效 (重命名) 前等待其提交, 加载时按变更日志重读,
+     *       从而不会在持有 DAO 锁时阻塞于写线程 (写组的事务可能正等待这些锁)
+     * @param withRows 形如 `(auto&& encode) -> void`: 在阻塞本 DAO 写操作的期间
+     *        以按主键升序的 (主键, T const&) 序列调用 encode
+     */
+    template <typename WithRows>
+    void writeSnapshot(WithRows&& withRows) const {
+        // 定期写与手动写可能并发, 二者共用同一个临时文件
+        std::lock_guard _{_snapshotMtx};
+        uint64_t const seq = inspectDb([](db::SQLiteDB const& db) {
+            return db.getChangeSeq();
+        });
+        std::string const tmpPath = _snapshotPath + ".tmp";
+        withRows([&](auto const& rows) {
+            db::encodeRowSnapshot<T>(tmpPath, seq, rows);
+        });
+        if (_writer) {
+            _writer->flush();
+        }
+        std::filesystem::rename(tmpPath, _snapshotPath);
+    }
+
+    /**
+     * @brief 切换到回写模式: 数据库连接交给后台写线程独占; 或者加入写组, 使用写组的写线程
+     * @param nextId 下一个分配的主键; 与 sqlite 的 rowid 规则一致 (最大值 + 1)
+     * @param group 写组, 需要包含本 DAO 的数据库文件; 为空时使用自己的写线程
+     */
+    void startWriteBehind(PrimaryKeyType nextId, std::shared_ptr<WriteGroup> group = {}) {
+        _nextId = nextId;
+        if (group) {
+            if (!group->contains(_db.getFilePath())) [[unlikely]] {
+                throw std::runtime_error{"startWriteBehind: database is not in the WriteGroup"};
+            }
+            _writer = group->queue();
+            _group = std::move(group);
+            // 增删改都在写组的连接上执行, 在那里预编译
+            _writer->push([](db::SQLiteDB& db) {
+                db.prepareInsert<T, true>();
+                db.prepareUpdate<T, "where ", PrimaryKeyName, "=?">();
+                db.prepareDelete<T, "where ", PrimaryKeyName, "=?">();
+            });
+            return;
+        }
+        _db.prepareInsert<T, true>();
+        _writer = std::make_shared<WriteBehindQueue>(std::move(_db));
+    }
+
+    /**
+     * @brief 回写模式下在内存中分配主键
+     * @param n 连续分配的个数
+     * @return PrimaryKeyType 第一个主键
+     */
+    PrimaryKeyType allocId(std::size_t n = 1) noexcept {
+        return _nextId.fetch_add(static_cast<PrimaryKeyType>(n), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 持久化一次写操作: 直写模式下立即执行 (失败则抛出), 回写模式下复制参数后入队
+     * @warning 需要在持有该行的写锁时调用, 以保证与内存中的修改顺序一致
+     * @param func 形如 `(db::SQLiteDB&, Args const&...) -> void`, 不应捕获任何引用
+     * @param args
+     */
+    template <typename Func, typename... Args>
+    void persist(Func&& func, Args const&... args) {
+        if (_writer) {
+            _writer->push([func = std::forward<Func>(func), ...args = args](db::SQLiteDB& db) {
+                func(db, args...);
+            });
+        } else {
+            std::lock_guard _{_dbMtx};
+            func(_db, args...);
+        }
+    }
+
+    /**
+     * @brief 直写模式下同步地使用数据库连接, 并取得返回值 (如新增行的主键)
+     * @warning 仅直写模式可用
+     * @param func 形如 `(db::SQLiteDB&) -> Res`
+     */
+    template <typename Func>
+    decltype(auto) withDb(Func&& func) {
+        std::lock_guard _{_dbMtx};
+        return func(_db);
+    }
+
+    /**
+     * @brief 读取数据库连接上的状态 (统计信息等)
+     * @note 独占写线程时在写线程中读取 (会等待此前的写操作); 加入写组时读取本 DAO 自己的连接, 不等待
+     * @param func 形如 `(db::SQLiteDB const&) -> Res`
+     */
+    template <typename Func>
+    auto inspectDb(Func&& func) const {
+        if (_writer && !_group) {
+            // 数据库由写线程独占, 需要在写线程中读取
+            decltype(func(_db)) res{};
+            _writer->push([&](db::SQLiteDB& db) {
+                res = func(db);
+            });
+            _writer->flush();
+            return res;
+        }
+        std::lock_guard _{_dbMtx};
+        return func(_db);
+    }
+
+    template <bool IsMustSucceed>
+    void persistUpdate(PrimaryKeyType id, T const& t) {
+        persist([](db::SQLiteDB& db, PrimaryKeyType id, T const& t) {
+            auto& stmt = db.update<"where ", PrimaryKeyName, "=?">(t)
+                .template bind<true>(id)
+                .execOnThrow();
+            if constexpr (IsMustSucceed) {
+                stmt.getLastChanges().check();
+            }
+        }, id, t);
+    }
+
+    template <bool IsMustSucceed, auto... Ptrs>
+    void persistUpdateBy(PrimaryKeyType id, db::FieldPair<Ptrs> const&... mbPair) {
+        persist([](db::SQLiteDB& db, PrimaryKeyType id, auto const&... vals) {
+            auto& stmt = db.updateBy<"where ", PrimaryKeyName, "=?">(db::FieldPair<Ptrs>{vals}...)
+                .template bind<true>(id)
+                .execOnThrow();
+            if constexpr (IsMustSucceed) {
+                stmt.getLastChanges().check();
+            }
+        }, id, mbPair.dataView...);
+    }
+
+    /**
+     * @brief 记录一次变更, 见 ChangeRing::record
+     */
+    void recordChange(PrimaryKeyType id, db::ChangeOp op = db::ChangeOp::Upsert) {
+        _changes.record(id, op);
+    }
+
+    void persistDel(PrimaryKeyType id) {
+        persist([](db::SQLiteDB& db, PrimaryKeyType id) {
+            db.deleteBy<T, "where ", PrimaryKeyName, "=?">()
+                .template bind<true>(id)
+                .execOnThrow();
+        }, id);
+    }
+
+    /**
+     * @brief 校验快照, 并补上快照之后的变更
+     * @return true 已从快照加载; false 快照无效 (尚未调用过 onRow), 需要全量加载
+     */
+    template <typename Reserve, typename OnRow>
+    bool loadSnapshot(Reserve& reserve, OnRow& onRow) {
+        if (!std::filesystem::exists(_snapshotPath)) {
+            return false;
+        }
+        std::optional<db::RowSnapshot<T>> snap;
+        std::vector<T> fresh;
+        std::unordered_set<int64_t> changed;
+        try {
+            snap.emplace(_snapshotPath);
+            // 数据库的变更序号比快照还旧, 说明数据库被替换过 (如从备份恢复)
+            if (snap->changeSeq() > _db.getChangeSeq()) [[unlikely]] {
+                throw std::runtime_error{"snapshot: newer than database"};
+            }
+            auto changes = _db.template getChangesSince<T>(snap->changeSeq());
+            // 变更过多时, 逐行查询不如全表查询
+            if (changes.size() > snap->size() / 4 + 64) {
+                log::hxLog.info("快照之后变更过多, 全量加载:", _snapshotPath, changes.size());
+                return false;
+            }
+            // 变更过的行以数据库为准
+            std::size_t cnt = snap->size();
+            for (auto const& c : changes) {
+                changed.insert(c.rowId);
+                cnt -= snap->contains(c.rowId);
+                if (c.op == db::ChangeOp::Delete) {
+                    continue;
+                }
+                for (auto&& t : _db.template query<T, "where ", PrimaryKeyName, "=?">(c.rowId)) {
+                    fresh.push_back(std::move(t));
+                }
+            }
+            cnt += fresh.size();
+            if (cnt != _db.template count<T>()) [[unlikely]] {
+                throw std::runtime_error{"snapshot: row count mismatch"};
+            }
+        } catch (std::exception const& e) {
+            log::hxLog.warning("快照无效, 全量加载:", _snapshotPath, e.what());
+            return false;
+        }
+        reserve(snap->size() + fresh.size());
+        snap->forEach([&](T&& t) {
+            if (!changed.contains(static_cast<int64_t>(db::getFirstPrimaryKeyRef<T>(t)))) {
+                onRow(std::move(t));
+            }
+        });
+        for (auto& t : fresh) {
+            onRow(std::move(t));
+        }
+        log::hxLog.info("从快照加载:", _snapshotPath, "行数:", snap->size(), "补上变更:", changed.size());
+        return true;
+    }
+
+    // 变更环保留的记录数; 客户端落后更多时需要全量刷新
+    inline static constexpr std::size_t ChangeRingCapacity = 4096;
+
+    // 主键字段名, 用于拼接 `where 主键=?`
+    inline static constexpr auto PrimaryKeyName = [] {
+        constexpr auto name = reflection::getMembersNames<T>()[db::GetFirstPrimaryKeyIndex<T>];
+        return meta::FixedString<name.size() + 1>{name};
+    }();
+
+    db::SQLiteDB _db;
+    // 直写模式下串行化对 _db 的访问
+    mutable std::mutex _dbMtx{};
+    // 回写模式下的后台写线程 (持有数据库连接), 直写模式下为空; 加入写组时与组内的 DAO 共用
+    std::shared_ptr<WriteBehindQueue> _writer{};
+    std::shared_ptr<WriteGroup> _group{};
+    std::atomic<PrimaryKeyType> _nextId{};
+    // 快照文件路径, 未启用快照时为空
+    std::string _snapshotPath{};
+    mutable std::mutex _snapshotMtx{};
+    std::function<void()> _saveSnapshot{};
+    std::unique_ptr<PeriodicSnapshotter> _snapshotter{};
+    // 最近的变更记录, 供客户端增量同步
+    ChangeRing<PrimaryKeyType> _changes{ChangeRingCapacity};
+};
+
+} // namespace HX::dao::internal
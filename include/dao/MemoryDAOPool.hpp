@@ -18,20 +18,155 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <HXLibs/log/Log.hpp>
+#include <HXLibs/reflection/TypeName.hpp>
+
 #include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/ShardedInMemoryDAO.hpp>
+#include <dao/WriteGroup.hpp>
+#include <dao/UndoLog.hpp>
 
 namespace HX::dao {
 
+/**
+ * @brief 启动阶段需要加载的 DAO, 见 MemoryDAOPool::bootstrap
+ * @tparam T DAO 类型
+ * @tparam Path 数据库文件路径
+ */
+template <typename T, meta::FixedString Path>
+struct DAOEntry {};
+
 /**
  * @brief DAO 池
  */
 struct MemoryDAOPool {
+    /**
+     * @brief 获取 DAO 单例, 其数据库以生产配置 (WAL + 后台检查点) 打开, 并使用回写模式;
+     *        启动时优先从二进制快照加载, 退出时与每隔一段时间写快照.
+     *        数据库属于 setWriteGroup 设置的写组时, 以写组的配置 (回滚日志) 打开, 经由写组的连接提交.
+     * @tparam T DAO 类型
+     * @tparam Path 数据库文件路径
+     * @return std::shared_ptr<T>
+     */
     template <typename T, meta::FixedString Path>
     static std::shared_ptr<T> get() {
         using PathStr = meta::ToCharPack<Path>;
-        static auto dao = std::make_shared<T>(db::SQLiteDB{PathStr::view()});
+        static auto dao = [] {
+            auto group = writeGroup();
+            if (group && !group->contains(PathStr::view())) {
+                group.reset();
+            }
+            return std::make_shared<T>(db::SQLiteDB{
+                PathStr::view(),
+                group ? group->getOpenOptions() : db::SQLiteOpenOptions::production()
+            }, WriteMode::WriteBehind, SnapshotOptions::production(), std::move(group));
+        }();
         return dao;
     }
+
+    /**
+     * @brief 设置写组: 此后创建的、数据库属于该组的 DAO 共用它的连接提交, 使跨 DAO 的修改可以一次提交
+     * @warning 需要在 bootstrap 与首次 get 之前调用
+     * @param group
+     */
+    static void setWriteGroup(std::shared_ptr<WriteGroup> group) {
+        writeGroup() = std::move(group);
+    }
+
+    /**
+     * @brief 获取 setWriteGroup 设置的写组, 未设置时为空
+     * @return std::shared_ptr<WriteGroup>
+     */
+    static std::shared_ptr<WriteGroup> getWriteGroup() {
+        return writeGroup();
+    }
+
+    /**
+     * @brief 跨 DAO 的事务: lambda 中对写组内 DAO 的修改在同一个事务中提交;
+     *        lambda 抛出异常时撤销其中的修改 (见 UndoLog), 未设置写组时也是如此
+     * @param lambda
+     * @return lambda 的返回值
+     */
+    template <typename Lambda>
+    static decltype(auto) transaction(Lambda&& lambda) {
+        if (auto const& group = writeGroup()) {
+            return group->transaction(std::forward<Lambda>(lambda));
+        }
+        return UndoLog::run(std::forward<Lambda>(lambda));
+    }
+
+    /**
+     * @brief 启动阶段: 并发地创建并加载 Entries 中的所有 DAO, 并记录各自与总的耗时
+     * @note 同一个数据库文件的 DAO 在同一个线程中依次加载, 以免建表/切换日志模式时互相等锁;
+     *       任一 DAO 加载失败时, 等待其余线程结束后抛出第一个异常.
+     * @tparam Entries DAOEntry<DAO 类型, 数据库文件路径>...
+     */
+    template <typename... Entries>
+    static void bootstrap() {
+        struct Task {
+            std::string_view path;
+            void (*load)();
+        };
+        std::vector<std::vector<Task>> groups;
+        auto addTask = [&] <typename T, meta::FixedString Path> (DAOEntry<T, Path>) {
+            Task task{meta::ToCharPack<Path>::view(), [] {
+                auto beginTime = std::chrono::steady_clock::now();
+                get<T, Path>();
+                log::hxLog.info("启动: 已加载", reflection::getTypeName<T>(), "耗时:",
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - beginTime).count(), "ms");
+            }};
+            for (auto& group : groups) {
+                if (group.front().path == task.path) {
+                    group.push_back(task);
+                    return;
+                }
+            }
+            groups.push_back({task});
+        };
+        (addTask(Entries{}), ...);
+
+        auto beginTime = std::chrono::steady_clock::now();
+        std::mutex mtx;
+        std::exception_ptr err{};
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(groups.size());
+            for (auto const& group : groups) {
+                workers.emplace_back([&] {
+                    try {
+                        for (auto const& task : group) {
+                            task.load();
+                        }
+                    } catch (...) {
+                        std::lock_guard _{mtx};
+                        if (!err) {
+                            err = std::current_exception();
+                        }
+                    }
+                });
+            }
+        } // 等待所有线程退出
+        if (err) {
+            std::rethrow_exception(err);
+        }
+        log::hxLog.info("启动: 已加载", sizeof...(Entries), "个 DAO, 总耗时:",
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - beginTime).count(), "ms");
+    }
+private:
+    static std::shared_ptr<WriteGroup>& writeGroup() {
+        static std::shared_ptr<WriteGroup> group;
+        return group;
+    }
 };
 
 } // namespace HX::dao
\ No newline at end of file
@@ -0,0 +1,593 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <HXLibs/meta/TypeTraits.hpp>
+
+#include <db/SQLiteMeta.hpp>
+#include <db/MakeSqlStr.hpp>
+#include <meta/MemberPtrType.hpp>
+#include <utils/TextIndex.hpp>
+#include <utils/SuggestTrie.hpp>
+#include <utils/GroupIndex.hpp>
+#include <utils/OrderStatIndex.hpp>
+#include <utils/TextTokenizer.hpp>
+
+namespace HX::dao::internal {
+
+/**
+ * @brief 支持异构查找的哈希 (如以 std::string_view 查找 std::string 键)
+ * @tparam Key 索引的键类型; 若其提供 `Key::hashOf(k)`, 则以它计算 (需保证异构的键哈希一致)
+ */
+template <typename Key>
+struct IndexHash {
+    using is_transparent = void;
+
+    // 不声明 noexcept: libstdc++ 会因此在节点中缓存哈希值, rehash 与遍历桶时不必重新计算
+    template <typename K>
+    std::size_t operator()(K const& k) const {
+        if constexpr (std::is_convertible_v<K const&, std::string_view>) {
+            // 先统一为 std::string_view, 避免字符串字面量在 hashOf 的重载间二义
+            std::string_view str{k};
+            if constexpr (requires { Key::hashOf(str); }) {
+                return Key::hashOf(str);
+            } else {
+                return std::hash<std::string_view>{}(str);
+            }
+        } else if constexpr (requires { Key::hashOf(k); }) {
+            return Key::hashOf(k);
+        } else {
+            return std::hash<K>{}(k);
+        }
+    }
+};
+
+template <typename Idx, typename Id>
+struct IndexContainer {
+    using KeyType = meta::remove_cvref_t<meta::GetMemberPtrType<meta::remove_cvref_t<decltype(Idx::ptr)>>>;
+    // 唯一索引: 键 -> 主键; 普通索引: 键 -> 主键集合 (删除单行为 O(1))
+    using Type = std::conditional_t<Idx::IsUnique,
+        std::unordered_map<KeyType, Id, IndexHash<KeyType>, std::equal_to<>>,
+        std::unordered_map<KeyType, std::unordered_set<Id>, IndexHash<KeyType>, std::equal_to<>>
+    >;
+};
+
+template <typename Id, auto... Ptrs>
+struct IndexContainer<db::TextIndex<Ptrs...>, Id> {
+    using Type = utils::TextIndex<Id, sizeof...(Ptrs)>;
+};
+
+template <typename Id, auto... Ptrs>
+struct IndexContainer<db::SuggestIndex<Ptrs...>, Id> {
+    using Type = utils::SuggestTrie<>;
+};
+
+template <typename Id, auto KeyPtr, auto SumPtr>
+struct IndexContainer<db::GroupIndex<KeyPtr, SumPtr>, Id> {
+    using Type = utils::GroupIndex<Id>;
+};
+
+/**
+ * @brief 多字段索引 (全文索引、前缀提示索引) 的各字段; 分组聚合索引的分组字段
+ */
+template <auto... Ptrs>
+struct IndexFieldList {
+    template <auto Ptr>
+    static constexpr bool contains() noexcept {
+        return (meta::isSameMemberPtr<Ptrs, Ptr>() || ...);
+    }
+
+    /**
+     * @brief 第 field 个字段的成员名
+     */
+    static constexpr std::string_view nameOf(std::size_t field) noexcept {
+        constexpr std::string_view Names[] = {db::internal::getMemberPtrName<Ptrs>()...};
+        return field < sizeof...(Ptrs) ? Names[field] : std::string_view{};
+    }
+
+    /**
+     * @brief 以 `sink(字段序号, 文本)` 依次送出 t 中各字段的文本
+     */
+    template <typename T, typename Sink>
+    static void feed(T const& t, Sink&& sink) {
+        std::size_t field = 0;
+        ((feedValue(sink, field, t.*Ptrs), ++field), ...);
+    }
+private:
+    // 字符串 (及驻留字符串) 直接送出; 可 str() 的 (如 CompactPath) 取其完整内容; 列表逐项送出
+    template <typename Sink, typename V>
+    static void feedValue(Sink& sink, std::size_t field, V const& v) {
+        if constexpr (std::is_convertible_v<V const&, std::string_view>) {
+            sink(field, std::string_view{v});
+        } else if constexpr (requires { v.str(); }) {
+            sink(field, std::string_view{v.str()});
+        } else {
+            for (auto const& e : v) {
+                feedValue(sink, field, e);
+            }
+        }
+    }
+};
+
+template <typename Idx>
+struct IndexFields;
+
+template <auto... Ptrs>
+struct IndexFields<db::TextIndex<Ptrs...>> : IndexFieldList<Ptrs...> {};
+
+template <auto... Ptrs>
+struct IndexFields<db::SuggestIndex<Ptrs...>> : IndexFieldList<Ptrs...> {};
+
+template <auto KeyPtr, auto SumPtr>
+struct IndexFields<db::GroupIndex<KeyPtr, SumPtr>> : IndexFieldList<KeyPtr> {
+    template <auto Ptr>
+    static constexpr bool contains() noexcept {
+        return meta::isSameMemberPtr<KeyPtr, Ptr>() || meta::isSameMemberPtr<SumPtr, Ptr>();
+    }
+
+    template <typename T>
+    static uint64_t sumOf(T const& t) noexcept {
+        return static_cast<uint64_t>(t.*SumPtr);
+    }
+};
+
+/**
+ * @brief 排序索引的键: 数值 (包括主键) 按值; 其余按 TextTokenizer::normalize 后的文本, 列表取第一项
+ */
+template <auto Ptr>
+struct IndexFields<db::SortIndex<Ptr>> {
+    using FieldType = meta::remove_cvref_t<meta::GetMemberPtrType<meta::remove_cvref_t<decltype(Ptr)>>>;
+    using ValueType = db::RemovePrimaryKeyType<FieldType>;
+    inline static constexpr bool IsNumeric = std::is_arithmetic_v<ValueType>;
+    using KeyType = std::conditional_t<IsNumeric, ValueType, std::string>;
+
+    template <typename T>
+    static KeyType keyOf(T const& t) {
+        if constexpr (IsNumeric) {
+            return static_cast<ValueType const&>(t.*Ptr);
+        } else {
+            std::string res;
+            bool isFirst = true;
+            IndexFieldList<Ptr>::feed(t, [&](std::size_t, std::string_view text) {
+                if (isFirst) {
+                    res = utils::TextTokenizer::normalize(text);
+                    isFirst = false;
+                }
+            });
+            return res;
+        }
+    }
+
+    /**
+     * @brief 由字段的原值 (文本形式) 得到键, 用于游标行已被删除时定位
+     * @throw std::runtime_error 数值字段无法解析
+     */
+    static KeyType keyOfText(std::string_view text) {
+        if constexpr (IsNumeric) {
+            ValueType res{};
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), res);
+            if (ec != std::errc{} || ptr != text.data() + text.size()) [[unlikely]] {
+                throw std::runtime_error{"bad sort key: " + std::string{text}};
+            }
+            return res;
+        } else {
+            return utils::TextTokenizer::normalize(text);
+        }
+    }
+};
+
+template <typename Id, auto Ptr>
+struct IndexContainer<db::SortIndex<Ptr>, Id> {
+    using Type = utils::OrderStatIndex<typename IndexFields<db::SortIndex<Ptr>>::KeyType, Id>;
+};
+
+template <typename T, typename Id, typename List>
+class IndexSet;
+
+/**
+ * @brief T 声明的全部内存索引
+ * @warning 本身不加锁, 需要与主数据在同一临界区内修改
+ */
+template <typename T, typename Id, typename... Idx>
+class IndexSet<T, Id, db::IndexList<Idx...>> {
+    // Ptr 的 (可按键查找的) 索引的位置, 没有则为 sizeof...(Idx)
+    template <auto Ptr>
+    static constexpr std::size_t indexOf() noexcept {
+        std::size_t res = sizeof...(Idx);
+        std::size_t i = 0;
+        ((isKeyIndexOf<Idx, Ptr>() ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+
+    template <typename I, auto Ptr>
+    static constexpr bool isKeyIndexOf() noexcept {
+        if constexpr (I::IsText || I::IsSuggest || I::IsGroup || I::IsSort) {
+            return false;
+        } else {
+            return meta::isSameMemberPtr<I::ptr, Ptr>();
+        }
+    }
+
+    template <typename I, auto... Ptrs>
+    static constexpr bool isAnyCoveredBy() noexcept {
+        if constexpr (I::IsText || I::IsSuggest || I::IsGroup) {
+            return (IndexFields<I>::template contains<Ptrs>() || ...);
+        } else {
+            return (meta::isSameMemberPtr<I::ptr, Ptrs>() || ...);
+        }
+    }
+
+    static constexpr std::size_t textIndexOf() noexcept {
+        std::size_t res = sizeof...(Idx);
+        std::size_t i = 0;
+        ((Idx::IsText ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+
+    static constexpr std::size_t suggestIndexOf() noexcept {
+        std::size_t res = sizeof...(Idx);
+        std::size_t i = 0;
+        ((Idx::IsSuggest ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+
+    // 以 Ptr 分组的分组聚合索引的位置, 没有则为 sizeof...(Idx)
+    template <auto Ptr>
+    static constexpr std::size_t groupIndexOf() noexcept {
+        std::size_t res = sizeof...(Idx);
+        std::size_t i = 0;
+        ((isGroupIndexOf<Idx, Ptr>() ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+
+    template <typename I, auto Ptr>
+    static constexpr bool isGroupIndexOf() noexcept {
+        if constexpr (I::IsGroup) {
+            return meta::isSameMemberPtr<I::ptr, Ptr>();
+        } else {
+            return false;
+        }
+    }
+
+    // Ptr 的排序索引的位置, 没有则为 sizeof...(Idx)
+    template <auto Ptr>
+    static constexpr std::size_t sortIndexOf() noexcept {
+        std::size_t res = sizeof...(Idx);
+        std::size_t i = 0;
+        ((isSortIndexOf<Idx, Ptr>() ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+
+    template <typename I, auto Ptr>
+    static constexpr bool isSortIndexOf() noexcept {
+        if constexpr (I::IsSort) {
+            return meta::isSameMemberPtr<I::ptr, Ptr>();
+        } else {
+            return false;
+        }
+    }
+public:
+    /**
+     * @brief 是否声明了全文索引 (至多一个)
+     */
+    inline static constexpr bool HasTextIndex = textIndexOf() < sizeof...(Idx);
+
+    /**
+     * @brief 是否声明了前缀提示索引 (至多一个)
+     */
+    inline static constexpr bool HasSuggestIndex = suggestIndexOf() < sizeof...(Idx);
+
+    static_assert((0 + ... + Idx::IsText) <= 1, "at most one db::TextIndex per table");
+    static_assert((0 + ... + Idx::IsSuggest) <= 1, "at most one db::SuggestIndex per table");
+
+    /**
+     * @brief Ptr 是否有 (可按键查找的) 索引
+     */
+    template <auto Ptr>
+    static constexpr bool isIndexed() noexcept {
+        return indexOf<Ptr>() < sizeof...(Idx);
+    }
+
+    /**
+     * @brief 是否有以 Ptr 分组的分组聚合索引
+     */
+    template <auto Ptr>
+    static constexpr bool isGrouped() noexcept {
+        return groupIndexOf<Ptr>() < sizeof...(Idx);
+    }
+
+    /**
+     * @brief Ptr 是否有排序索引
+     */
+    template <auto Ptr>
+    static constexpr bool isSorted() noexcept {
+        return sortIndexOf<Ptr>() < sizeof...(Idx);
+    }
+
+    /**
+     * @brief Ptrs 中是否有任一成员参与了索引 (包括全文索引等), 修改它们时需要更新索引
+     */
+    template <auto... Ptrs>
+    static constexpr bool isAnyIndexed() noexcept {
+        return (isAnyCoveredBy<Idx, Ptrs...>() || ...);
+    }
+
+    /**
+     * @brief 检查 t 以主键 id 写入后是否违反唯一约束
+     * @param t 
+     * @param id 新增时为空
+     * @throw std::runtime_error 违反唯一约束
+     */
+    void check(T const& t, std::optional<Id> id) const {
+        forEachIndex([&] <typename I> (I, auto const& mp) {
+            if constexpr (I::IsUnique) {
+                auto it = mp.find(t.*(I::ptr));
+                if (it != mp.end() && (!id || it->second != *id)) [[unlikely]] {
+                    throw std::runtime_error{
+                        "unique index conflict: " + std::string{db::internal::getMemberPtrName<I::ptr>()}
+                    };
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief 检查一批新增数据是否违反唯一约束 (包括批内重复)
+     * @throw std::runtime_error 违反唯一约束
+     */
+    void checkMany(std::vector<T> const& list) const {
+        forEachIndex([&] <typename I> (I, auto const& mp) {
+            if constexpr (I::IsUnique) {
+                using KeyType = typename IndexContainer<I, Id>::KeyType;
+                std::unordered_set<KeyType, IndexHash<KeyType>, std::equal_to<>> keys;
+                for (auto const& t : list) {
+                    auto const& key = t.*(I::ptr);
+                    if (mp.contains(key) || !keys.insert(key).second) [[unlikely]] {
+                        throw std::runtime_error{
+                            "unique index conflict: " + std::string{db::internal::getMemberPtrName<I::ptr>()}
+                        };
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief 加载前按行数预留唯一索引 (及全文索引的文档表) 的桶, 避免逐行插入时反复 rehash;
+     *        前缀提示、分组聚合与排序索引进入批量模式, 直到 finishLoad
+     * @param n 行数
+     */
+    void reserve(std::size_t n) {
+        forEachIndex([&] <typename I> (I, auto& mp) {
+            if constexpr (I::IsUnique || I::IsText) {
+                mp.reserve(n);
+            } else if constexpr (I::IsSuggest || I::IsGroup || I::IsSort) {
+                mp.beginBulk();
+            }
+        });
+    }
+
+    /**
+     * @brief 加载完成, 见 reserve
+     */
+    void finishLoad() {
+        forEachIndex([&] <typename I> (I, auto& mp) {
+            if constexpr (I::IsSuggest || I::IsGroup || I::IsSort) {
+                mp.endBulk();
+            }
+        });
+    }
+
+    void insert(T const& t, Id id) {
+        forEachIndex([&] <typename I> (I, auto& mp) {
+            if constexpr (I::IsText) {
+                mp.insert(id, [&](auto&& sink) {
+                    IndexFields<I>::feed(t, sink);
+                });
+            } else if constexpr (I::IsSuggest) {
+                IndexFields<I>::feed(t, [&](std::size_t field, std::string_view text) {
+                    mp.add(field, text, 1);
+                });
+            } else if constexpr (I::IsGroup) {
+                auto val = IndexFields<I>::sumOf(t);
+                IndexFields<I>::feed(t, [&](std::size_t, std::string_view key) {
+                    mp.add(key, id, val);
+                });
+            } else if constexpr (I::IsSort) {
+                mp.insert(IndexFields<I>::keyOf(t), id);
+            } else if constexpr (I::IsUnique) {
+                // 旧数据可能存在重复, 此时保留先加载的一条
+                mp.emplace(t.*(I::ptr), id);
+            } else {
+                mp[t.*(I::ptr)].insert(id);
+            }
+        });
+    }
+
+    void erase(T const& t, Id id) {
+        forEachIndex([&] <typename I> (I, auto& mp) {
+            if constexpr (I::IsText) {
+                mp.erase(id);
+            } else if constexpr (I::IsSuggest) {
+                IndexFields<I>::feed(t, [&](std::size_t field, std::string_view text) {
+                    mp.add(field, text, -1);
+                });
+            } else if constexpr (I::IsGroup) {
+                auto val = IndexFields<I>::sumOf(t);
+                IndexFields<I>::feed(t, [&](std::size_t, std::string_view key) {
+                    mp.erase(key, id, val);
+                });
+            } else if constexpr (I::IsSort) {
+                mp.erase(IndexFields<I>::keyOf(t), id);
+            } else {
+                eraseKey<I>(mp, t, id);
+            }
+        });
+    }
+
+    /**
+     * @brief 以键查找主键
+     * @return 唯一索引为 std::optional<Id>, 普通索引为 std::vector<Id>
+     */
+    template <auto Ptr, typename K>
+        requires (isIndexed<Ptr>())
+    auto find(K const& key) const {
+        using I = std::tuple_element_t<indexOf<Ptr>(), std::tuple<Idx...>>;
+        auto const& mp = std::get<indexOf<Ptr>()>(_maps);
+        auto it = mp.find(key);
+        if constexpr (I::IsUnique) {
+            return it == mp.end() ? std::optional<Id>{} : std::optional<Id>{it->second};
+        } else {
+            return it == mp.end() ? std::vector<Id>{} : std::vector<Id>(it->second.begin(), it->second.end());
+        }
+    }
+
+    /**
+     * @brief 全文检索, 见 utils::TextIndex::search
+     */
+    std::vector<utils::TextHit<Id>> search(std::string_view query, std::size_t k) const
+        requires (HasTextIndex)
+    {
+        return std::get<textIndexOf()>(_maps).search(query, k);
+    }
+
+    /**
+     * @brief 前缀提示, 见 utils::SuggestTrie::suggest
+     */
+    std::vector<utils::Suggestion> suggest(std::string_view prefix, std::size_t k) const
+        requires (HasSuggestIndex)
+    {
+        return std::get<suggestIndexOf()>(_maps).suggest(prefix, k);
+    }
+
+    /**
+     * @brief 以 Ptr 分组的分组列表, 见 utils::GroupIndex::groups
+     */
+    template <auto Ptr>
+        requires (isGrouped<Ptr>())
+    std::vector<utils::GroupStat> groups(std::string_view after, std::size_t maxCnt) const {
+        return std::get<groupIndexOf<Ptr>()>(_maps).groups(after, maxCnt);
+    }
+
+    /**
+     * @brief 以 Ptr 分组的分组 key 中的主键, 见 utils::GroupIndex::ids
+     */
+    template <auto Ptr>
+        requires (isGrouped<Ptr>())
+    std::vector<Id> groupIds(std::string_view key, Id beginId, std::size_t maxCnt) const {
+        return std::get<groupIndexOf<Ptr>()>(_maps).ids(key, beginId, maxCnt);
+    }
+
+    /**
+     * @brief 按 Ptr 的顺序取一页主键
+     * @param after 游标行 (上一页的最后一行), 为空则从头开始
+     * @param afterId 游标行的主键, 0 为从头开始
+     * @param afterKey 游标行排序字段的原值; 游标行已被删除时据此定位
+     * @param offset 在游标之后再跳过的行数
+     * @param maxCnt 最多返回的个数
+     * @param isDesc 是否降序
+     * @throw std::out_of_range 游标行已被删除, 且未给出 afterKey (按主键排序时除外)
+     */
+    template <auto Ptr>
+        requires (isSorted<Ptr>())
+    std::vector<Id> sorted(
+        T const* after, Id afterId, std::optional<std::string_view> afterKey,
+        std::size_t offset, std::size_t maxCnt, bool isDesc
+    ) const {
+        using I = std::tuple_element_t<sortIndexOf<Ptr>(), std::tuple<Idx...>>;
+        using Fields = IndexFields<I>;
+        auto const& mp = std::get<sortIndexOf<Ptr>()>(_maps);
+        std::size_t rank = 0;
+        if (after || afterId) {
+            typename Fields::KeyType key{};
+            if (after) {
+                key = Fields::keyOf(*after);
+            } else if (afterKey) {
+                key = Fields::keyOfText(*afterKey);
+            } else if constexpr (!std::is_same_v<typename Fields::FieldType, typename Fields::ValueType>) {
+                // 按主键排序时键即主键
+                key = static_cast<typename Fields::KeyType>(afterId);
+            } else {
+                throw std::out_of_range{"sorted: the cursor row does not exist"};
+            }
+            // 游标行已被删除时, 其后第一项的升序排名为 lower 而非 lower + 1; 降序排名两种情况都是 size - lower
+            auto lower = mp.rankOf(key, afterId);
+            rank = isDesc ? mp.size() - lower : lower + (after ? 1 : 0);
+        }
+        return mp.slice(rank + std::min(offset, mp.size()), maxCnt, isDesc);
+    }
+
+    /**
+     * @brief 前缀提示索引第 field 个字段的成员名 (即 utils::Suggestion::field 对应的成员)
+     */
+    static constexpr std::string_view suggestFieldName(std::size_t field) noexcept
+        requires (HasSuggestIndex)
+    {
+        return IndexFields<std::tuple_element_t<suggestIndexOf(), std::tuple<Idx...>>>::nameOf(field);
+    }
+private:
+    template <typename I, typename Map>
+    static void eraseKey(Map& mp, T const& t, Id id) {
+        auto it = mp.find(t.*(I::ptr));
+        if (it == mp.end()) {
+            return;
+        }
+        if constexpr (I::IsUnique) {
+            if (it->second == id) {
+                mp.erase(it);
+            }
+        } else {
+            it->second.erase(id);
+            if (it->second.empty()) {
+                mp.erase(it);
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEachIndex(Func&& func) {
+        [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+            (func(Idx{}, std::get<Is>(_maps)), ...);
+        }(std::make_index_sequence<sizeof...(Idx)>{});
+    }
+
+    template <typename Func>
+    void forEachIndex(Func&& func) const {
+        [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+            (func(Idx{}, std::get<Is>(_maps)), ...);
+        }(std::make_index_sequence<sizeof...(Idx)>{});
+    }
+
+    std::tuple<typename IndexContainer<Idx, Id>::Type...> _maps;
+};
+
+} // namespace HX::dao::internal
@@ -0,0 +1,422 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace HX::dao {
+
+namespace internal {
+
+/**
+ * @brief 以主键为下标的持久化基数树 (64 叉), 接口与 std::map 的常用部分一致 (按主键升序遍历).
+ *        复制只复制根指针, 为 O(1); 修改时只复制从根到叶的一条路径, 为 O(log64 n),
+ *        未修改的节点在新旧版本之间共享.
+ * @note 供 RCU 式的发布使用: 复制当前版本、修改副本、再发布副本. 已发布的版本不再修改, 可被并发读取.
+ *       每个对象持有一个编辑令牌, 只原地修改由自己创建的节点 (同一次发布中的多次修改不会重复复制);
+ *       复制时双方都换用新的令牌, 此后共享的节点对双方都是只读的.
+ * @tparam Key 整数主键
+ * @tparam V
+ * @tparam Stride 主键的步长, 含义同 DenseIdMap
+ */
+template <typename Key, typename V, std::size_t Stride = 1>
+class PersistentIdMap {
+    static_assert(Stride > 0, "Stride must be greater than 0");
+
+    static constexpr unsigned Bits = 6;
+    static constexpr std::size_t Fanout = std::size_t{1} << Bits;
+    static constexpr std::size_t NoSlot = static_cast<std::size_t>(-1);
+
+    struct Node {
+        uint64_t edit;      // 创建该节点的对象的编辑令牌
+        uint64_t mask = 0;  // 第 i 位表示第 i 个子节点 (或值) 存在
+    };
+
+    struct Inner : Node {
+        std::array<std::shared_ptr<Node>, Fanout> kids{};
+    };
+
+    struct Leaf : Node {
+        std::array<V, Fanout> vals{};
+    };
+public:
+    using key_type = Key;
+    using mapped_type = V;
+    using value_type = std::pair<Key const, V>;
+    using size_type = std::size_t;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PersistentIdMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        // 元素并非以 pair 存放, 因此解引用得到的是 (主键, 值的引用) 对
+        using reference = std::pair<Key const, V const&>;
+
+        struct pointer {
+            reference ref;
+
+            reference const* operator->() const noexcept {
+                return &ref;
+            }
+        };
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept {
+            return {_mp->toKey(_slot), _leaf->vals[_slot % Fanout]};
+        }
+
+        pointer operator->() const noexcept {
+            return {**this};
+        }
+
+        const_iterator& operator++() noexcept {
+            // 先在当前叶中找, 叶用尽时再从根向下查找
+            auto i = _slot % Fanout;
+            auto rest = i + 1 < Fanout ? _leaf->mask & (~uint64_t{0} << (i + 1)) : 0;
+            if (rest) {
+                _slot = _slot - i + static_cast<std::size_t>(std::countr_zero(rest));
+            } else if (_slot - i + Fanout < _slot) [[unlikely]] {
+                _slot = NoSlot;
+            } else {
+                *this = _mp->seek(_slot - i + Fanout);
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+
+        bool operator==(const_iterator const& that) const noexcept {
+            return _slot == that._slot;
+        }
+    private:
+        friend class PersistentIdMap;
+
+        const_iterator(PersistentIdMap const* mp, Leaf const* leaf, std::size_t slot) noexcept
+            : _mp{mp}
+            , _leaf{leaf}
+            , _slot{slot}
+        {}
+
+        PersistentIdMap const* _mp{};
+        Leaf const* _leaf{};
+        std::size_t _slot = NoSlot;
+    };
+
+    using iterator = const_iterator;
+
+    PersistentIdMap() noexcept
+        : _edit{newEdit()}
+    {}
+
+    // 双方都取得新的编辑令牌, 因此都不会原地修改共享的节点
+    PersistentIdMap(PersistentIdMap const& that) noexcept
+        : _root{that._root}
+        , _height{that._height}
+        , _size{that._size}
+        , _residue{that._residue}
+        , _edit{newEdit()}
+    {
+        that._edit.store(newEdit(), std::memory_order_relaxed);
+    }
+
+    PersistentIdMap(PersistentIdMap&& that) noexcept
+        : _root{std::move(that._root)}
+        , _height{std::exchange(that._height, 0)}
+        , _size{std::exchange(that._size, 0)}
+        , _residue{that._residue}
+        , _edit{that._edit.exchange(newEdit(), std::memory_order_relaxed)}
+    {}
+
+    PersistentIdMap& operator=(PersistentIdMap const& that) noexcept {
+        if (this != &that) {
+            *this = PersistentIdMap{that};
+        }
+        return *this;
+    }
+
+    PersistentIdMap& operator=(PersistentIdMap&& that) noexcept {
+        _root = std::move(that._root);
+        _height = std::exchange(that._height, 0);
+        _size = std::exchange(that._size, 0);
+        _residue = that._residue;
+        _edit.store(that._edit.exchange(newEdit(), std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    const_iterator begin() const noexcept {
+        return seek(0);
+    }
+
+    const_iterator end() const noexcept {
+        return {};
+    }
+
+    size_type size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    bool contains(Key const& key) const noexcept {
+        return findLeaf(key) != nullptr;
+    }
+
+    const_iterator find(Key const& key) const noexcept {
+        auto leaf = findLeaf(key);
+        return leaf ? const_iterator{this, leaf, toSlot(key)} : end();
+    }
+
+    /**
+     * @brief 第一个不小于 key 的元素, O(log64 n)
+     */
+    const_iterator lower_bound(Key const& key) const noexcept {
+        auto k = static_cast<std::size_t>(key);
+        return seek(k <= _residue ? 0 : (k - _residue + Stride - 1) / Stride);
+    }
+
+    V const& at(Key const& key) const {
+        auto leaf = findLeaf(key);
+        if (!leaf) [[unlikely]] {
+            throw std::out_of_range{"PersistentIdMap::at: key not found"};
+        }
+        return leaf->vals[toSlot(key) % Fanout];
+    }
+
+    template <typename... Args>
+    std::pair<const_iterator, bool> emplace(Key const& key, Args&&... args) {
+        if (auto it = find(key); it != end()) {
+            return {it, false};
+        }
+        return assign(key, V(std::forward<Args>(args)...));
+    }
+
+    template <typename U>
+    std::pair<const_iterator, bool> insert_or_assign(Key const& key, U&& u) {
+        return assign(key, std::forward<U>(u));
+    }
+
+    size_type erase(Key const& key) {
+        if (!contains(key)) {
+            return 0;
+        }
+        if (eraseIn(_root, _height, toSlot(key))) {
+            _root.reset();
+            _height = 0;
+        }
+        --_size;
+        return 1;
+    }
+
+    void clear() noexcept {
+        _root.reset();
+        _height = 0;
+        _size = 0;
+    }
+private:
+    static uint64_t newEdit() noexcept {
+        static std::atomic<uint64_t> nextEdit{1};
+        return nextEdit.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static unsigned shiftOf(unsigned height) noexcept {
+        return (height - 1) * Bits;
+    }
+
+    // 高度为 height 的树能容纳的下标个数, 超过 size_t 时视为无限
+    static bool isCovered(unsigned height, std::size_t slot) noexcept {
+        return height * Bits >= 64 || (slot >> (height * Bits)) == 0;
+    }
+
+    std::size_t toSlot(Key const& key) const noexcept {
+        return static_cast<std::size_t>(key) / Stride;
+    }
+
+    Key toKey(std::size_t slot) const noexcept {
+        return static_cast<Key>(slot * Stride + _residue);
+    }
+
+    Leaf const* findLeaf(Key const& key) const noexcept {
+        if (_size == 0 || static_cast<std::size_t>(key) % Stride != _residue) {
+            return nullptr;
+        }
+        auto slot = toSlot(key);
+        if (!isCovered(_height, slot)) {
+            return nullptr;
+        }
+        Node const* node = _root.get();
+        for (unsigned h = _height; h > 1; --h) {
+            auto i = (slot >> shiftOf(h)) % Fanout;
+            if (!(node->mask >> i & 1)) {
+                return nullptr;
+            }
+            node = static_cast<Inner const*>(node)->kids[i].get();
+        }
+        return node->mask >> (slot % Fanout) & 1 ? static_cast<Leaf const*>(node) : nullptr;
+    }
+
+    // 第一个下标不小于 slot 的元素
+    const_iterator seek(std::size_t slot) const noexcept {
+        Leaf const* leaf{};
+        if (_root && isCovered(_height, slot) && seekIn(_root.get(), _height, 0, slot, leaf, slot)) {
+            return {this, leaf, slot};
+        }
+        return end();
+    }
+
+    // 在覆盖 [base, base + 64^height) 的子树中查找; 要求 slot >= base
+    static bool seekIn(
+        Node const* node, unsigned height, std::size_t base, std::size_t slot,
+        Leaf const*& leaf, std::size_t& res
+    ) noexcept {
+        auto shift = shiftOf(height);
+        auto i = (slot - base) >> shift;
+        auto mask = node->mask & (~uint64_t{0} << i);
+        if (height == 1) {
+            if (!mask) {
+                return false;
+            }
+            leaf = static_cast<Leaf const*>(node);
+            res = base + static_cast<std::size_t>(std::countr_zero(mask));
+            return true;
+        }
+        for (; mask; mask &= mask - 1) {
+            auto j = static_cast<std::size_t>(std::countr_zero(mask));
+            auto kidBase = base + (j << shift);
+            if (seekIn(static_cast<Inner const*>(node)->kids[j].get(), height - 1,
+                       kidBase, std::max(slot, kidBase), leaf, res)
+            ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 取得可原地修改的节点: 不是本对象创建的则复制一份
+    template <typename N>
+    N& editable(std::shared_ptr<Node>& node) {
+        auto edit = _edit.load(std::memory_order_relaxed);
+        if (node->edit != edit) {
+            auto copy = std::make_shared<N>(static_cast<N const&>(*node));
+            copy->edit = edit;
+            node = std::move(copy);
+        }
+        return static_cast<N&>(*node);
+    }
+
+    template <typename N>
+    std::shared_ptr<Node> makeNode() {
+        auto node = std::make_shared<N>();
+        node->edit = _edit.load(std::memory_order_relaxed);
+        return node;
+    }
+
+    template <typename U>
+    std::pair<const_iterator, bool> assign(Key const& key, U&& u) {
+        if (_size == 0) {
+            _residue = static_cast<std::size_t>(key) % Stride;
+        } else if (static_cast<std::size_t>(key) % Stride != _residue) [[unlikely]] {
+            throw std::invalid_argument{"PersistentIdMap: key does not match the stride"};
+        }
+        auto slot = toSlot(key);
+        if (!_root) {
+            _root = makeNode<Leaf>();
+            _height = 1;
+        }
+        while (!isCovered(_height, slot)) {
+            auto root = makeNode<Inner>();
+            auto& inner = static_cast<Inner&>(*root);
+            inner.kids[0] = std::move(_root);
+            inner.mask = 1;
+            _root = std::move(root);
+            ++_height;
+        }
+        std::shared_ptr<Node>* node = &_root;
+        for (unsigned h = _height; h > 1; --h) {
+            auto& inner = editable<Inner>(*node);
+            auto i = (slot >> shiftOf(h)) % Fanout;
+            if (!(inner.mask >> i & 1)) {
+                inner.kids[i] = h == 2 ? makeNode<Leaf>() : makeNode<Inner>();
+                inner.mask |= uint64_t{1} << i;
+            }
+            node = &inner.kids[i];
+        }
+        auto& leaf = editable<Leaf>(*node);
+        auto i = slot % Fanout;
+        bool isNew = !(leaf.mask >> i & 1);
+        leaf.vals[i] = std::forward<U>(u);
+        leaf.mask |= uint64_t{1} << i;
+        _size += isNew;
+        return {{this, &leaf, slot}, isNew};
+    }
+
+    // 删除后子树为空时返回 true, 由上层摘除
+    bool eraseIn(std::shared_ptr<Node>& node, unsigned height, std::size_t slot) {
+        if (height == 1) {
+            auto& leaf = editable<Leaf>(node);
+            auto i = slot % Fanout;
+            leaf.vals[i] = V{};
+            leaf.mask &= ~(uint64_t{1} << i);
+            return leaf.mask == 0;
+        }
+        auto& inner = editable<Inner>(node);
+        auto i = (slot >> shiftOf(height)) % Fanout;
+        if (eraseIn(inner.kids[i], height - 1, slot)) {
+            inner.kids[i].reset();
+            inner.mask &= ~(uint64_t{1} << i);
+        }
+        return inner.mask == 0;
+    }
+
+    std::shared_ptr<Node> _root{};
+    unsigned _height = 0;           // 0 为空树, 1 为只有一个叶
+    std::size_t _size = 0;
+    std::size_t _residue = 0;       // 所有主键模 Stride 的余数
+    // 复制 const 的已发布版本时也要更换, 因此为 mutable; 修改总在持有写锁时进行, 原子只为避免数据竞争
+    mutable std::atomic<uint64_t> _edit;
+};
+
+} // namespace internal
+
+/**
+ * @brief 分片内存 DAO 的存储策略: 持久化基数树, 复制为 O(1), 每次修改为 O(log n);
+ *        适用于整数主键 (可以稀疏). 只实现了只读接口与 emplace/insert_or_assign/erase, 不能用于 ThreadSafeInMemoryDAO
+ */
+struct PersistentIdStorage {
+    template <typename Key, typename V, std::size_t Stride = 1>
+    using Type = internal::PersistentIdMap<Key, V, Stride>;
+};
+
+} // namespace HX::dao
@@ -0,0 +1,71 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <tuple>
+#include <type_traits>
+
+namespace HX::dao {
+
+/**
+ * @brief 投影: 成员容器的大小, 不复制容器本身. 用于 `dao.project<dao::sizeOf<&T::list>>(id)`
+ * @tparam Ptr 容器成员指针
+ */
+template <auto Ptr>
+    requires (std::is_member_object_pointer_v<decltype(Ptr)>)
+struct SizeOf {
+    template <typename T>
+    constexpr auto operator()(T const& t) const noexcept(noexcept((t.*Ptr).size())) {
+        return (t.*Ptr).size();
+    }
+};
+
+template <auto Ptr>
+inline constexpr SizeOf<Ptr> sizeOf{};
+
+namespace internal {
+
+template <auto Proj, typename T>
+auto projectOne(T const& t) {
+    if constexpr (std::is_member_object_pointer_v<decltype(Proj)>) {
+        // 成员指针: 复制该字段
+        return t.*Proj;
+    } else {
+        // 可调用对象 (如 SizeOf): 计算结果
+        return Proj(t);
+    }
+}
+
+/**
+ * @brief 对一行数据做编译期投影
+ * @tparam Projs 成员指针, 或者形如 `(T const&) -> R` 的可作为模板参数的可调用对象
+ * @return 单个投影为其值, 多个为 std::tuple
+ */
+template <auto... Projs, typename T>
+auto project(T const& t) {
+    if constexpr (sizeof...(Projs) == 1) {
+        return projectOne<Projs...>(t);
+    } else {
+        return std::tuple{projectOne<Projs>(t)...};
+    }
+}
+
+} // namespace internal
+
+} // namespace HX::dao
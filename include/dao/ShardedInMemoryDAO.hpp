@@ -0,0 +1,825 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dao/InMemoryDAOBase.hpp>
+#include <dao/UndoLog.hpp>
+#include <dao/DenseIdMap.hpp>
+#include <dao/PersistentIdMap.hpp>
+#include <dao/Projection.hpp>
+
+namespace HX::dao {
+
+namespace internal {
+
+// 假定的缓存行大小, 用于避免分片的锁之间伪共享
+inline constexpr std::size_t CacheLineSize = 64;
+
+/**
+ * @brief 多个按主键取模划分的分片快照的只读合并视图, 遍历顺序与单个 std::map 一致 (主键升序)
+ * @note 视图持有各分片快照的引用计数, 遍历期间不加锁, 也不会看到之后的修改;
+ *       迭代器每步需要在各分片的当前位置中取最小值, 为 O(ShardCnt)
+ * @tparam Key 主键类型
+ * @tparam T 行类型
+ * @tparam ShardCnt 分片数
+ * @tparam Storage 分片的存储策略
+ */
+template <typename Key, typename T, std::size_t ShardCnt, typename Storage>
+class ShardedMapView {
+public:
+    // 单个分片的快照, 发布后不再修改; 同一分片的主键模 ShardCnt 同余
+    using ShardMap = typename Storage::template Type<Key, std::shared_ptr<T const>, ShardCnt>;
+
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<Key const, T>;
+        using difference_type = std::ptrdiff_t;
+        // 行以 shared_ptr 存放, 因此解引用得到的是 (主键, 行的引用) 对;
+        // 主键按值保存: 以下标存放的分片 (DenseIdStorage 等) 的主键是即时算出的, 没有可引用的对象
+        using reference = std::pair<Key const, T const&>;
+
+        struct pointer {
+            reference ref;
+
+            reference const* operator->() const noexcept {
+                return &ref;
+            }
+        };
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept {
+            return {_cur[_min]->first, *_cur[_min]->second};
+        }
+
+        pointer operator->() const noexcept {
+            return {**this};
+        }
+
+        const_iterator& operator++() {
+            ++_cur[_min];
+            seekMin();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+
+        bool operator==(const_iterator const& that) const noexcept {
+            return _min == that._min && (_min == ShardCnt || _cur[_min] == that._cur[_min]);
+        }
+    private:
+        friend class ShardedMapView;
+
+        using MapIt = typename ShardMap::const_iterator;
+
+        void seekMin() noexcept {
+            _min = ShardCnt;
+            for (std::size_t i = 0; i < ShardCnt; ++i) {
+                if (_cur[i] != _end[i]
+                    && (_min == ShardCnt || _cur[i]->first < _cur[_min]->first)
+                ) {
+                    _min = i;
+                }
+            }
+        }
+
+        std::array<MapIt, ShardCnt> _cur{};
+        std::array<MapIt, ShardCnt> _end{};
+        std::size_t _min = ShardCnt;    // 当前元素所在的分片, ShardCnt 表示 end
+    };
+
+    using iterator = const_iterator;
+
+    explicit ShardedMapView(std::array<std::shared_ptr<ShardMap const>, ShardCnt> maps) noexcept
+        : _maps{std::move(maps)}
+    {}
+
+    const_iterator begin() const {
+        return seek([](ShardMap const& mp) { return mp.begin(); });
+    }
+
+    const_iterator end() const noexcept {
+        return {};
+    }
+
+    const_iterator lower_bound(key_type const& key) const {
+        return seek([&](ShardMap const& mp) { return mp.lower_bound(key); });
+    }
+
+    const_iterator find(key_type const& key) const {
+        auto it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    mapped_type const& at(key_type const& key) const {
+        return *shardOf(key).at(key);
+    }
+
+    bool contains(key_type const& key) const {
+        return shardOf(key).contains(key);
+    }
+
+    size_type size() const noexcept {
+        size_type res = 0;
+        for (auto const& mp : _maps) {
+            res += mp->size();
+        }
+        return res;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+private:
+    template <typename Func>
+    const_iterator seek(Func&& func) const {
+        const_iterator it;
+        for (std::size_t i = 0; i < ShardCnt; ++i) {
+            it._cur[i] = func(*_maps[i]);
+            it._end[i] = _maps[i]->end();
+        }
+        it.seekMin();
+        return it;
+    }
+
+    ShardMap const& shardOf(key_type const& key) const noexcept {
+        return *_maps[static_cast<std::size_t>(key) % ShardCnt];
+    }
+
+    std::array<std::shared_ptr<ShardMap const>, ShardCnt> _maps;
+};
+
+} // namespace internal
+
+/**
+ * @brief 分片的内存 DAO: 数据按主键取模分到 ShardCnt 个分片. 读取为 RCU 方式:
+ *        每个分片以 atomic shared_ptr 发布一份不可变的快照, 读者原子地取得当前快照, 不加任何锁,
+ *        也不会等待正在执行的数据库写入; 写者持有分片的写锁, 复制快照、修改后再发布.
+ *        接口与 ThreadSafeInMemoryDAO 一致.
+ * @note 默认的 PersistentIdStorage 下复制快照为 O(1), 每次写入只复制一条路径, 为 O(log n);
+ *       以 OrderedMapStorage / DenseIdStorage 存储时, 每次写入需要复制所在分片的整个 map
+ *       (仅复制行指针, 不复制行), 为 O(n / ShardCnt), 只适合很少写的表.
+ * @note 加锁顺序 (仅写者): 新增 -> 二级索引 -> 分片 (按下标升序) -> 数据库连接. 二级索引是全局的,
+ *       因此 DO 声明了索引时, 增删与修改索引字段仍会在索引锁上串行; 新增之间总是串行,
+ *       直写模式下新增入库 (由数据库分配主键) 时不持有索引锁.
+ * @tparam T
+ * @tparam ShardCnt 分片数
+ * @tparam Storage 分片的存储策略, 见 PersistentIdStorage / OrderedMapStorage / DenseIdStorage
+ */
+template <typename T, std::size_t ShardCnt = 16, typename Storage = PersistentIdStorage>
+struct ShardedInMemoryDAO : public internal::InMemoryDAOBase<T> {
+    static_assert(ShardCnt > 0, "ShardCnt must be greater than 0");
+
+    using Base = internal::InMemoryDAOBase<T>;
+    using typename Base::PrimaryKeyType;
+    using typename Base::IndexSetType;
+
+    // lockSelect 中看到的是所有分片快照的合并视图
+    using MapType = internal::ShardedMapView<db::GetFirstPrimaryKeyType<T>, T, ShardCnt, Storage>;
+
+    // 单个分片的快照
+    using ShardMapType = typename MapType::ShardMap;
+
+    /**
+     * @brief 加载整张表到内存
+     * @param db
+     * @param mode 持久化模式; WriteBehind 时 db 会交给后台写线程独占
+     * @param snapshot 快照配置; 启用时优先从快照加载
+     * @param group 写组; 非空时总为回写模式, 经由写组共用的连接提交, db 仍由本 DAO 用于加载与统计
+     */
+    ShardedInMemoryDAO(
+        db::SQLiteDB db,
+        WriteMode mode = WriteMode::WriteThrough,
+        SnapshotOptions const& snapshot = {},
+        std::shared_ptr<WriteGroup> group = {}
+    )
+        : Base{std::move(db), group != nullptr}
+    {
+        std::array<ShardMapType, ShardCnt> maps;
+        auto maxId = Base::loadRows(snapshot, [&](std::size_t n) {
+            _indexes.reserve(n);
+        }, [&](T&& t) {
+            auto id = db::getFirstPrimaryKeyRef<T>(t);
+            _indexes.insert(t, id);
+            maps[static_cast<std::size_t>(id) % ShardCnt].emplace(
+                id, std::make_shared<T const>(std::move(t)));
+        });
+        _indexes.finishLoad();
+        for (std::size_t i = 0; i < ShardCnt; ++i) {
+            _shards[i].rows.store(std::make_shared<ShardMapType const>(std::move(maps[i])));
+        }
+        if (mode == WriteMode::WriteBehind || group) {
+            Base::startWriteBehind(maxId + 1, std::move(group));
+        }
+        Base::startSnapshotter(snapshot, [this] {
+            saveSnapshot();
+        });
+    }
+
+    ShardedInMemoryDAO& operator=(ShardedInMemoryDAO&&) noexcept = delete;
+
+    ~ShardedInMemoryDAO() noexcept {
+        Base::stopSnapshotter();
+    }
+
+    /**
+     * @brief 立即写一次快照; 未启用快照时什么也不做
+     * @note 只在取得各分片的快照时短暂阻塞写者, 编码与写文件时不持有任何锁
+     */
+    void saveSnapshot() const {
+        if (!Base::isSnapshotEnabled()) {
+            return;
+        }
+        Base::writeSnapshot([&](auto&& encode) {
+            std::optional<MapType> rows;
+            {
+                // 等待已入库的新增发布到内存, 使变更序号不会超前于取得的各行
+                std::lock_guard addLck{_addMtx};
+                uniqueLock([&] {
+                    lockSelect([&](MapType const& mp) {
+                        rows.emplace(mp);
+                    });
+                });
+            }
+            encode(*rows);
+        });
+    }
+
+    template <typename U>
+        requires (std::convertible_to<U, T>)
+    T add(U&& u) {
+        // 新增之间串行, 并持有 _addMtx 直到发布: 直写模式下主键由数据库分配, 入库时尚不知道分片,
+        // 需要以此保证 saveSnapshot 取得的变更序号不会超前于内存
+        std::lock_guard addLck{_addMtx};
+        PrimaryKeyType id{};
+        auto idxLck = lockIndexesForAdd([&] {
+            _indexes.check(u, std::nullopt);
+        }, [&](db::SQLiteDB& db) {
+            id = db.insert(u);
+            return std::vector<PrimaryKeyType>{id};
+        });
+        if (_writer) {
+            id = Base::allocId();
+        }
+        db::getFirstPrimaryKeyRef<T>(u) = id;
+        auto row = std::make_shared<T const>(std::forward<U>(u));
+        auto& shard = shardOf(id);
+        std::unique_lock _{shard.mtx};
+        publish(shard, [&](ShardMapType& mp) {
+            mp.emplace(id, row);
+        });
+        Base::recordChange(id);
+        _indexes.insert(*row, id);
+        if (_writer) {
+            _writer->push([row](db::SQLiteDB& db) {
+                db.insert<T const&, true>(*row);
+            });
+        }
+        UndoLog::record([this, id] {
+            del(id);
+        });
+        return *row;
+    }
+
+    /**
+     * @brief 批量新增, 在同一个事务中写入数据库 (只需一次提交)
+     * @param list 待新增的数据
+     * @return std::vector<PrimaryKeyType> 按顺序对应的新增数据的主键
+     */
+    std::vector<PrimaryKeyType> addMany(std::vector<T> list) {
+        // 同 add
+        std::lock_guard addLck{_addMtx};
+        std::vector<PrimaryKeyType> ids;
+        auto idxLck = lockIndexesForAdd([&] {
+            _indexes.checkMany(list);
+        }, [&](db::SQLiteDB& db) {
+            ids = db.insertMany(list);
+            return ids;
+        });
+        if (_writer) {
+            ids.reserve(list.size());
+            auto id = Base::allocId(list.size());
+            for (auto& t : list) {
+                ids.push_back(db::getFirstPrimaryKeyRef<T>(t) = id++);
+            }
+            // 新主键在返回前不可能被其他写操作引用, 因此可以先于发布入队
+            _writer->push([list](db::SQLiteDB& db) {
+                db.insertMany<true>(list);
+            });
+        }
+        // 按分片归组, 每个分片只复制并发布一次
+        std::array<std::vector<std::pair<PrimaryKeyType, std::shared_ptr<T const>>>, ShardCnt> rows;
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            db::getFirstPrimaryKeyRef<T>(list[i]) = ids[i];
+            _indexes.insert(list[i], ids[i]);
+            rows[static_cast<std::size_t>(ids[i]) % ShardCnt].emplace_back(
+                ids[i], std::make_shared<T const>(std::move(list[i])));
+        }
+        for (std::size_t i = 0; i < ShardCnt; ++i) {
+            if (rows[i].empty()) {
+                continue;
+            }
+            std::unique_lock _{_shards[i].mtx};
+            publish(_shards[i], [&](ShardMapType& mp) {
+                for (auto& [id, row] : rows[i]) {
+                    mp.emplace(id, std::move(row));
+                }
+            });
+            for (auto const& [id, row] : rows[i]) {
+                Base::recordChange(id);
+            }
+        }
+        if (UndoLog::isActive()) {
+            UndoLog::record([this, ids] {
+                for (auto id : ids) {
+                    del(id);
+                }
+            });
+        }
+        return ids;
+    }
+
+    template <bool IsMustSucceed = false, typename U>
+        requires (std::convertible_to<U, T>)
+    T update(U&& u) {
+        auto id = db::getFirstPrimaryKeyRef<T>(u);
+        auto idxLck = lockIndexes();
+        auto& shard = shardOf(id);
+        std::unique_lock _{shard.mtx};
+        auto old = find(shard, id);
+        checkExist<IsMustSucceed>(old);
+        _indexes.check(u, id);
+        Base::template persistUpdate<IsMustSucceed>(id, static_cast<T const&>(u));
+        if (!old) [[unlikely]] {
+            // 该行不存在: 数据库中也未修改任何行, 不能凭空插入
+            return T{std::forward<U>(u)};
+        }
+        auto row = std::make_shared<T const>(std::forward<U>(u));
+        publish(shard, [&](ShardMapType& mp) {
+            mp.insert_or_assign(id, row);
+        });
+        Base::recordChange(id);
+        _indexes.erase(*old, id);
+        _indexes.insert(*row, id);
+        UndoLog::record([this, old] {
+            update(T{*old});
+        });
+        return *row;
+    }
+
+    template <bool IsMustSucceed = false, auto... Ptrs>
+        requires (std::is_same_v<meta::GetMemberPtrsClassType<decltype(Ptrs)...>, T>)
+    void updateBy(db::GetFirstPrimaryKeyType<T> id, db::FieldPair<Ptrs>... mbPair) {
+        constexpr bool IsIndexed = IndexSetType::template isAnyIndexed<Ptrs...>();
+        // 只改非索引字段时不需要索引锁, 不同分片上的修改完全并行
+        std::unique_lock<std::shared_mutex> idxLck;
+        if constexpr (IsIndexed) {
+            idxLck = std::unique_lock{_indexMtx};
+        }
+        auto& shard = shardOf(id);
+        std::unique_lock _{shard.mtx};
+        auto old = find(shard, id);
+        checkExist<IsMustSucceed>(old);
+        std::shared_ptr<T> next;
+        if (old) {
+            next = std::make_shared<T>(*old);
+            (((*next).*(mbPair.ptr) = mbPair.dataView), ...);
+            if constexpr (IsIndexed) {
+                _indexes.check(*next, id);
+            }
+        }
+        Base::template persistUpdateBy<IsMustSucceed>(id, mbPair...);
+        if (!next) {
+            return;
+        }
+        publish(shard, [&](ShardMapType& mp) {
+            mp.insert_or_assign(id, next);
+        });
+        Base::recordChange(id);
+        if constexpr (IsIndexed) {
+            _indexes.erase(*old, id);
+            _indexes.insert(*next, id);
+        }
+        UndoLog::record([this, id, old] {
+            updateBy(id, db::FieldPair<Ptrs>{(*old).*Ptrs}...);
+        });
+    }
+
+    void del(PrimaryKeyType id) {
+        auto idxLck = lockIndexes();
+        auto& shard = shardOf(id);
+        std::unique_lock _{shard.mtx};
+        Base::persistDel(id);
+        if (auto old = find(shard, id)) {
+            publish(shard, [&](ShardMapType& mp) {
+                mp.erase(id);
+            });
+            Base::recordChange(id, db::ChangeOp::Delete);
+            _indexes.erase(*old, id);
+            UndoLog::record([this, id, old] {
+                restore(id, old);
+            });
+        }
+    }
+
+    /**
+     * @brief 无锁地取得一行的当前版本; 持有期间即使该行被修改或删除, 指向的数据也不会变化
+     * @param id
+     * @return std::shared_ptr<T const>
+     * @throw std::out_of_range 不存在该主键
+     */
+    std::shared_ptr<T const> atPtr(PrimaryKeyType id) const {
+        auto row = find(shardOf(id), id);
+        if (!row) [[unlikely]] {
+            throw std::out_of_range{"atPtr: id not found"};
+        }
+        return row;
+    }
+
+    T at(PrimaryKeyType id) const {
+        return *atPtr(id);
+    }
+
+    template <typename... ClassPtr>
+        requires (sizeof...(ClassPtr) > 0 && (std::is_member_pointer_v<ClassPtr> && ...))
+    auto at(PrimaryKeyType id, ClassPtr&&... ptr) const {
+        auto row = atPtr(id);
+        auto const& typeDO = *row;
+        if constexpr (sizeof...(ptr) == 1) {
+            return ((typeDO.*ptr), ...);
+        } else {
+            return std::make_tuple((typeDO.*ptr)...);
+        }
+    }
+
+    /**
+     * @brief 在当前版本上以只读引用访问一行, 不复制整个 DO
+     * @warning func 不应保存引用, 也不应再进行任何 DAO 操作
+     * @param id
+     * @param func 形如 `(T const&) -> Res`
+     * @return Res
+     * @throw std::out_of_range 不存在该主键
+     */
+    template <typename Func>
+    auto visit(PrimaryKeyType id, Func&& func) const {
+        auto row = atPtr(id);
+        return func(*row);
+    }
+
+    /**
+     * @brief 批量以只读引用访问多行, 不复制 DO: 每个分片至多取一次快照 (不加锁),
+     *        不必为每一行取快照与增减引用计数
+     * @warning func 不应保存引用, 也不应再进行任何 DAO 操作
+     * @param ids 按该顺序访问, 不存在的主键被跳过
+     * @param func 形如 `(T const&) -> void`, 如直接构造到 VO 的列表中
+     * @return std::size_t 访问到的行数
+     */
+    template <typename Func>
+    std::size_t atMany(std::span<PrimaryKeyType const> ids, Func&& func) const {
+        std::array<std::shared_ptr<ShardMapType const>, ShardCnt> rows{};
+        std::size_t cnt = 0;
+        for (auto id : ids) {
+            auto& mp = rows[static_cast<std::size_t>(id) % ShardCnt];
+            if (!mp) {
+                mp = shardOf(id).rows.load(std::memory_order_acquire);
+            }
+            auto it = mp->find(id);
+            if (it == mp->end()) {
+                continue;
+            }
+            func(*it->second);
+            ++cnt;
+        }
+        return cnt;
+    }
+
+    /**
+     * @brief 编译期投影, 只复制/计算所需的字段, 如
+     *        `project<&PlaylistDO::name, dao::sizeOf<&PlaylistDO::songIdList>>(id)`
+     * @tparam Projs 成员指针, 或 dao::sizeOf 等可调用对象
+     * @return 单个投影为其值, 多个为 std::tuple
+     */
+    template <auto... Projs>
+        requires (sizeof...(Projs) > 0)
+    auto project(PrimaryKeyType id) const {
+        return visit(id, [](T const& t) {
+            return internal::project<Projs...>(t);
+        });
+    }
+
+    /**
+     * @brief 以二级索引查找, O(1)
+     * @tparam Ptr 有索引的成员指针 (见 DO 中的 `Indexes` 声明)
+     * @param key
+     * @return 唯一索引为 std::optional<T>, 普通索引为 std::vector<T>
+     */
+    template <auto Ptr, typename K>
+        requires (IndexSetType::template isIndexed<Ptr>())
+    auto findBy(K const& key) const {
+        std::shared_lock _{_indexMtx};
+        auto ids = _indexes.template find<Ptr>(key);
+        if constexpr (requires { ids.has_value(); }) {
+            return ids ? std::optional<T>{*atPtr(*ids)} : std::optional<T>{};
+        } else {
+            std::vector<T> res;
+            res.reserve(ids.size());
+            for (auto id : ids) {
+                res.push_back(*atPtr(id));
+            }
+            return res;
+        }
+    }
+
+    /**
+     * @brief 以二级索引查找主键, O(1)
+     * @return 唯一索引为 std::optional<PrimaryKeyType>, 普通索引为 std::vector<PrimaryKeyType>
+     */
+    template <auto Ptr, typename K>
+        requires (IndexSetType::template isIndexed<Ptr>())
+    auto findIdBy(K const& key) const {
+        std::shared_lock _{_indexMtx};
+        return _indexes.template find<Ptr>(key);
+    }
+
+    /**
+     * @brief 全文检索 (见 DO 中声明的 `db::TextIndex`), 按相关度返回前 topK 条的主键与得分
+     * @param query 查询文本, 需包含其中全部的词才会命中
+     * @param topK 最多返回的条数
+     * @return std::vector<utils::TextHit<PrimaryKeyType>>
+     */
+    auto search(std::string_view query, std::size_t topK) const
+        requires (IndexSetType::HasTextIndex)
+    {
+        std::shared_lock _{_indexMtx};
+        return _indexes.search(query, topK);
+    }
+
+    /**
+     * @brief 前缀提示 (见 DO 中声明的 `db::SuggestIndex`), 按出现次数返回至多 topK 条
+     * @param prefix 已输入的前缀
+     * @param topK 最多返回的条数 (不超过索引预存的条数)
+     * @return std::vector<utils::Suggestion>
+     */
+    auto suggest(std::string_view prefix, std::size_t topK) const
+        requires (IndexSetType::HasSuggestIndex)
+    {
+        std::shared_lock _{_indexMtx};
+        return _indexes.suggest(prefix, topK);
+    }
+
+    /**
+     * @brief 按键升序分页列出以 Ptr 分组的分组及其行数、求和 (见 DO 中声明的 `db::GroupIndex`)
+     * @param after 从大于该键的分组开始, 空为从头开始
+     * @param maxCnt 最多返回的分组数
+     * @return std::vector<utils::GroupStat>
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isGrouped<Ptr>())
+    auto selectGroups(std::string_view after, std::size_t maxCnt) const {
+        std::shared_lock _{_indexMtx};
+        return _indexes.template groups<Ptr>(after, maxCnt);
+    }
+
+    /**
+     * @brief 按主键升序分页列出以 Ptr 分组时, 分组 key 中的主键 (见 DO 中声明的 `db::GroupIndex`)
+     * @param key 分组的键
+     * @param beginId 从大于该主键的开始
+     * @param maxCnt 最多返回的个数
+     * @return std::vector<PrimaryKeyType>
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isGrouped<Ptr>())
+    auto selectGroupIds(std::string_view key, PrimaryKeyType beginId, std::size_t maxCnt) const {
+        std::shared_lock _{_indexMtx};
+        return _indexes.template groupIds<Ptr>(key, beginId, maxCnt);
+    }
+
+    /**
+     * @brief 按 Ptr 的顺序分页 (见 DO 中声明的 `db::SortIndex`), O(log n + maxCnt)
+     * @param beginId 游标: 从该主键所在行之后开始, 0 为从头开始
+     * @param offset 在游标之后再跳过的行数, 用于直接跳到任意一页
+     * @param maxCnt 最多返回的个数
+     * @param isDesc 是否降序
+     * @param beginKey 游标行排序字段的原值, 游标行已被删除时据此定位; 按主键排序时不需要
+     * @return std::vector<PrimaryKeyType>
+     * @throw std::out_of_range 游标行已被删除, 且未给出 beginKey
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isSorted<Ptr>())
+    auto selectSorted(
+        PrimaryKeyType beginId, std::size_t offset, std::size_t maxCnt, bool isDesc,
+        std::optional<std::string_view> beginKey = std::nullopt
+    ) const {
+        std::shared_lock _{_indexMtx};
+        // 行快照不可变, 持有索引读锁时其排序键不会再变
+        auto row = beginId ? find(shardOf(beginId), beginId) : nullptr;
+        return _indexes.template sorted<Ptr>(row.get(), beginId, beginKey, offset, maxCnt, isDesc);
+    }
+
+    /**
+     * @brief 阻塞所有写者 (索引与所有分片), 读取不受影响
+     */
+    template <typename Lambda>
+    decltype(auto) uniqueLock(Lambda&& lambda) const {
+        auto idxLck = lockIndexes();
+        auto _ = lockShards<std::unique_lock>();
+        return lambda();
+    }
+
+    template <typename Lambda>
+    decltype(auto) sharedLock(Lambda&& lambda) const {
+        auto _ = lockShards<std::shared_lock>();
+        return lambda();
+    }
+
+    /**
+     * @brief 只读的对 MapType 进行读取; 取得各分片的当前快照后遍历, 不加锁, 也不阻塞写者.
+     * @note 每个分片的快照各自是一致的; 与之并发的写入可能只有一部分可见.
+     * @tparam Lambda 
+     * @tparam Res 
+     * @param lambda 
+     * @return Res 
+     */
+    template <typename Lambda, typename Res = std::invoke_result_t<Lambda, MapType const&>>
+    Res lockSelect(Lambda&& lambda) const {
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return lambda(MapType{{
+                _shards[Is].rows.load(std::memory_order_acquire)...
+            }});
+        }(std::make_index_sequence<ShardCnt>{});
+    }
+protected:
+    struct alignas(internal::CacheLineSize) Shard {
+        // 只由写者持有, 串行化对本分片的修改
+        mutable std::shared_mutex mtx;
+        std::atomic<std::shared_ptr<ShardMapType const>> rows{std::make_shared<ShardMapType const>()};
+    };
+
+    // 主键所在的分片; 派生类可借此只对单行加写锁
+    Shard& shardOf(PrimaryKeyType id) noexcept {
+        return _shards[static_cast<std::size_t>(id) % ShardCnt];
+    }
+
+    Shard const& shardOf(PrimaryKeyType id) const noexcept {
+        return _shards[static_cast<std::size_t>(id) % ShardCnt];
+    }
+
+    static std::shared_ptr<T const> find(Shard const& shard, PrimaryKeyType id) {
+        auto rows = shard.rows.load(std::memory_order_acquire);
+        auto it = rows->find(id);
+        return it == rows->end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief 复制分片的当前快照, 修改后发布; 同一次发布中的多次修改只复制一次
+     * @warning 需要持有 shard.mtx 的写锁
+     * @param func 形如 `(ShardMapType&) -> void`
+     */
+    template <typename Func>
+    static void publish(Shard& shard, Func&& func) {
+        auto next = std::make_shared<ShardMapType>(*shard.rows.load(std::memory_order_relaxed));
+        func(*next);
+        shard.rows.store(std::move(next), std::memory_order_release);
+    }
+
+    /**
+     * @brief 以原主键重新插入被删除的行, 用于撤销删除 (见 UndoLog)
+     */
+    void restore(PrimaryKeyType id, std::shared_ptr<T const> row) {
+        // 同 add
+        std::lock_guard addLck{_addMtx};
+        auto idxLck = lockIndexesForAdd([&] {
+            _indexes.check(*row, std::nullopt);
+        }, [&](db::SQLiteDB& db) {
+            db.insert<T const&, true>(*row);
+            return std::vector<PrimaryKeyType>{id};
+        });
+        auto& shard = shardOf(id);
+        std::unique_lock _{shard.mtx};
+        publish(shard, [&](ShardMapType& mp) {
+            mp.emplace(id, row);
+        });
+        Base::recordChange(id);
+        _indexes.insert(*row, id);
+        if (_writer) {
+            _writer->push([row](db::SQLiteDB& db) {
+                db.insert<T const&, true>(*row);
+            });
+        }
+    }
+
+    /**
+     * @brief 新增前检查唯一约束, 直写模式下并入库; 返回时持有索引的写锁
+     * @note 需要持有 _addMtx. 直写模式下入库时不持有索引锁, 以免阻塞按索引的查询与其他修改;
+     *       入库后在索引锁下重新检查, 期间其他修改占用了唯一索引的键时, 删除刚入库的行并抛出
+     * @param check 检查唯一约束, 违反时抛出
+     * @param insert 形如 `(db::SQLiteDB&) -> std::vector<PrimaryKeyType>`, 返回入库的行的主键; 仅直写模式调用
+     */
+    template <typename Check, typename Insert>
+    std::unique_lock<std::shared_mutex> lockIndexesForAdd(Check&& check, Insert&& insert) {
+        if (_writer) {
+            std::unique_lock idxLck{_indexMtx};
+            check();
+            return idxLck;
+        }
+        {
+            std::shared_lock _{_indexMtx};
+            check();
+        }
+        auto ids = Base::withDb(insert);
+        std::unique_lock idxLck{_indexMtx};
+        try {
+            check();
+        } catch (...) {
+            for (auto id : ids) {
+                Base::persistDel(id);
+            }
+            throw;
+        }
+        return idxLck;
+    }
+
+    template <bool IsMustSucceed>
+    void checkExist(std::shared_ptr<T const> const& old) const {
+        // 回写模式下无法得知数据库的修改行数, 以内存中的数据为准
+        if constexpr (IsMustSucceed) {
+            if (_writer && !old) [[unlikely]] {
+                throw std::runtime_error{"check: Change < 1"};
+            }
+        }
+    }
+
+    /**
+     * @brief 对二级索引加写锁; DO 未声明索引时不加锁
+     */
+    std::unique_lock<std::shared_mutex> lockIndexes() const {
+        if constexpr (db::GetIndexList<T>::Size > 0) {
+            return std::unique_lock{_indexMtx};
+        } else {
+            return {};
+        }
+    }
+
+    /**
+     * @brief 按下标升序对所有分片加锁
+     * @tparam Lock std::unique_lock / std::shared_lock
+     */
+    template <template <typename> typename Lock>
+    auto lockShards() const {
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return std::array<Lock<std::shared_mutex>, ShardCnt>{
+                Lock<std::shared_mutex>{_shards[Is].mtx}...
+            };
+        }(std::make_index_sequence<ShardCnt>{});
+    }
+
+    using Base::_db;
+    using Base::_writer;
+
+    std::array<Shard, ShardCnt> _shards{};
+    // 二级索引, 由 _indexMtx 保护 (不属于任何分片)
+    IndexSetType _indexes{};
+    mutable std::shared_mutex _indexMtx;
+    // 串行化新增 (见 add), 先于其他锁取得
+    mutable std::mutex _addMtx;
+};
+
+} // namespace HX::dao
@@ -18,95 +18,164 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <map>
+#include <algorithm>
+#include <optional>
+#include <vector>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <utility>
 
-#include <HXLibs/reflection/MemberName.hpp>
-
-#include <db/SQLiteMeta.hpp>
-#include <db/SQLiteDB.hpp>
+#include <dao/InMemoryDAOBase.hpp>
+#include <dao/UndoLog.hpp>
+#include <dao/DenseIdMap.hpp>
+#include <dao/Projection.hpp>
 
 namespace HX::dao {
 
 /**
  * @brief 线程安全访问的, 数据缓存; 启动时候会把所有数据加载到内存, 日后全部访问基于内存; 仅增删改会同步一次到数据库.
  * @tparam T 
+ * @tparam Storage 存储策略, 见 OrderedMapStorage / DenseIdStorage
  */
-template <typename T>
-struct ThreadSafeInMemoryDAO {
-    using PrimaryKeyType = db::RemovePrimaryKeyType<meta::remove_cvref_t<decltype(
-        std::get<
-            db::GetFirstPrimaryKeyIndex<T>
-        >(reflection::internal::getObjTie(std::declval<T>()))
-    )>>;
-
-    using MapType = std::map<db::GetFirstPrimaryKeyType<T>, T>;
-
-    ThreadSafeInMemoryDAO(db::SQLiteDB db)
-        : _db{std::move(db)}
+template <typename T, typename Storage = OrderedMapStorage>
+struct ThreadSafeInMemoryDAO : public internal::InMemoryDAOBase<T> {
+    using Base = internal::InMemoryDAOBase<T>;
+    using typename Base::PrimaryKeyType;
+    using typename Base::IndexSetType;
+
+    using MapType = typename Storage::template Type<db::GetFirstPrimaryKeyType<T>, T>;
+
+    /**
+     * @brief 加载整张表到内存
+     * @param db
+     * @param mode 持久化模式; WriteBehind 时 db 会交给后台写线程独占
+     * @param snapshot 快照配置; 启用时优先从快照加载
+     * @param group 写组; 非空时总为回写模式, 经由写组共用的连接提交, db 仍由本 DAO 用于加载与统计
+     */
+    ThreadSafeInMemoryDAO(
+        db::SQLiteDB db,
+        WriteMode mode = WriteMode::WriteThrough,
+        SnapshotOptions const& snapshot = {},
+        std::shared_ptr<WriteGroup> group = {}
+    )
+        : Base{std::move(db), group != nullptr}
         , _map{}
         , _mtx{}
     {
-        _db.createDatabase<T>();
-        auto res = _db.queryAll<T>();
-        for (auto&& it : res) {
-            auto id = db::getFirstPrimaryKeyRef<T>(it);
-            _map.emplace(id, std::move(it));
+        // 逐行读取, 直接移动进 map, 避免先整表读入 vector 造成的双倍内存峰值
+        auto maxId = Base::loadRows(snapshot, [&](std::size_t n) {
+            _indexes.reserve(n);
+        }, [&](T&& t) {
+            auto id = db::getFirstPrimaryKeyRef<T>(t);
+            _indexes.insert(t, id);
+            _map.emplace(id, std::move(t));
+        });
+        _indexes.finishLoad();
+        if (mode == WriteMode::WriteBehind || group) {
+            Base::startWriteBehind(maxId + 1, std::move(group));
         }
+        Base::startSnapshotter(snapshot, [this] {
+            saveSnapshot();
+        });
     }
 
     ThreadSafeInMemoryDAO& operator=(ThreadSafeInMemoryDAO&&) noexcept = delete;
 
+    ~ThreadSafeInMemoryDAO() noexcept {
+        Base::stopSnapshotter();
+    }
+
+    /**
+     * @brief 立即写一次快照; 未启用快照时什么也不做
+     * @note 只在持有读锁复制各行时阻塞写操作, 编码与写文件时不持有锁 (代价是短暂地多占用一份行的内存)
+     */
+    void saveSnapshot() const {
+        if (!Base::isSnapshotEnabled()) {
+            return;
+        }
+        Base::writeSnapshot([&](auto&& encode) {
+            std::vector<std::pair<PrimaryKeyType, T>> rows;
+            {
+                std::shared_lock _{_mtx};
+                rows.reserve(_map.size());
+                for (auto const& [id, row] : _map) {
+                    rows.emplace_back(id, row);
+                }
+            }
+            encode(rows);
+        });
+    }
+
+    // 以下公开的增删改在 UndoLog 的事务中会登记逆操作, 以便事务失败时撤销
+
     template <typename U>
         requires (std::convertible_to<U, T>)
     T add(U&& u) {
         std::unique_lock _{_mtx};
-        auto id = _db.insert(u);
-        db::getFirstPrimaryKeyRef<T>(u) = id;
-        auto [it, ok] = _map.emplace(id, std::forward<U>(u));
-        return it->second;
+        auto res = addImpl(std::forward<U>(u));
+        UndoLog::record([this, id = db::getFirstPrimaryKeyRef<T>(res)] {
+            del(id);
+        });
+        return res;
+    }
+
+    /**
+     * @brief 批量新增, 在同一个事务中写入数据库 (只需一次提交)
+     * @param list 待新增的数据
+     * @return std::vector<PrimaryKeyType> 按顺序对应的新增数据的主键
+     */
+    std::vector<PrimaryKeyType> addMany(std::vector<T> list) {
+        std::unique_lock _{_mtx};
+        auto ids = addManyImpl(std::move(list));
+        if (UndoLog::isActive()) {
+            UndoLog::record([this, ids] {
+                for (auto id : ids) {
+                    del(id);
+                }
+            });
+        }
+        return ids;
     }
 
     template <bool IsMustSucceed = false, typename U>
         requires (std::convertible_to<U, T>)
     T update(U&& u) {
         std::unique_lock _{_mtx};
-        auto id = db::getFirstPrimaryKeyRef<T>(u);
-        constexpr auto name = reflection::getMembersNames<T>()[db::GetFirstPrimaryKeyIndex<T>];
-        auto& stmt = _db.update<"where ", meta::FixedString<name.size() + 1>{name}, "=?">(u)
-            .template bind<true>(id)
-            .execOnThrow();
-        if constexpr (IsMustSucceed) {
-            stmt.getLastChanges().check();
+        auto old = findForUndo(db::getFirstPrimaryKeyRef<T>(u));
+        auto res = updateImpl<IsMustSucceed>(std::forward<U>(u));
+        if (old) {
+            UndoLog::record([this, old = std::move(*old)] {
+                update(T{old});
+            });
         }
-        return _map[id] = std::forward<U>(u);
+        return res;
     }
 
-    template <bool IsMustSucceed = false, typename... MemberPtr>
-        requires (std::is_same_v<meta::GetMemberPtrsClassType<MemberPtr...>, T>)
-    void updateBy(db::GetFirstPrimaryKeyType<T> id, db::FieldPair<MemberPtr>... mbPair) {
+    template <bool IsMustSucceed = false, auto... Ptrs>
+        requires (std::is_same_v<meta::GetMemberPtrsClassType<decltype(Ptrs)...>, T>)
+    void updateBy(db::GetFirstPrimaryKeyType<T> id, db::FieldPair<Ptrs>... mbPair) {
         std::unique_lock _{_mtx};
-        constexpr auto name = reflection::getMembersNames<T>()[db::GetFirstPrimaryKeyIndex<T>];
-        auto& stmt = _db.updateBy<"where ", meta::FixedString<name.size() + 1>{name}, "=?">(mbPair...)
-            .template bind<true>(id)
-            .execOnThrow();
-        if constexpr (IsMustSucceed) {
-            stmt.getLastChanges().check();
+        auto old = findForUndo(id);
+        updateByImpl<IsMustSucceed>(id, std::move(mbPair)...);
+        if (old) {
+            UndoLog::record([this, id, old = std::move(*old)] {
+                updateBy(id, db::FieldPair<Ptrs>{old.*Ptrs}...);
+            });
         }
-        auto& data = _map[id];
-        ((data.*(mbPair.ptr) = mbPair.dataView), ...);
     }
 
     void del(PrimaryKeyType id) {
-        using namespace std::string_literals;
         std::unique_lock _{_mtx};
-        _db.deleteBy<T>(("where "s
-                        += reflection::getMembersNames<T>()[db::GetFirstPrimaryKeyIndex<T>])
-                        += " = ?")
-            .template bind<true>(id)
-            .execOnThrow();
-        _map.erase(id);
+        auto old = findForUndo(id);
+        delImpl(id);
+        if (old) {
+            UndoLog::record([this, id, old = std::move(*old)] {
+                std::unique_lock _{_mtx};
+                restoreImpl(id, old);
+            });
+        }
     }
 
     T at(PrimaryKeyType id) const {
@@ -126,6 +195,165 @@ struct ThreadSafeInMemoryDAO {
         }
     }
 
+    /**
+     * @brief 在读锁内以只读引用访问一行, 不复制整个 DO
+     * @warning func 不应保存引用, 也不应再进行任何 DAO 操作
+     * @param id
+     * @param func 形如 `(T const&) -> Res`
+     * @return Res
+     * @throw std::out_of_range 不存在该主键
+     */
+    template <typename Func>
+    auto visit(PrimaryKeyType id, Func&& func) const {
+        std::shared_lock _{_mtx};
+        return func(_map.at(id));
+    }
+
+    /**
+     * @brief 批量以只读引用访问多行, 只加一次读锁, 不复制 DO
+     * @warning func 不应保存引用, 也不应再进行任何 DAO 操作
+     * @param ids 按该顺序访问, 不存在的主键被跳过
+     * @param func 形如 `(T const&) -> void`, 如直接构造到 VO 的列表中
+     * @return std::size_t 访问到的行数
+     */
+    template <typename Func>
+    std::size_t atMany(std::span<PrimaryKeyType const> ids, Func&& func) const {
+        std::shared_lock _{_mtx};
+        std::size_t cnt = 0;
+        for (auto id : ids) {
+            auto it = _map.find(id);
+            if (it == _map.end()) {
+                continue;
+            }
+            func(it->second);
+            ++cnt;
+        }
+        return cnt;
+    }
+
+    /**
+     * @brief 编译期投影, 只复制/计算所需的字段, 如
+     *        `project<&PlaylistDO::name, dao::sizeOf<&PlaylistDO::songIdList>>(id)`
+     * @tparam Projs 成员指针, 或 dao::sizeOf 等可调用对象
+     * @return 单个投影为其值, 多个为 std::tuple
+     */
+    template <auto... Projs>
+        requires (sizeof...(Projs) > 0)
+    auto project(PrimaryKeyType id) const {
+        return visit(id, [](T const& t) {
+            return internal::project<Projs...>(t);
+        });
+    }
+
+    /**
+     * @brief 以二级索引查找, O(1)
+     * @tparam Ptr 有索引的成员指针 (见 DO 中的 `Indexes` 声明)
+     * @param key
+     * @return 唯一索引为 std::optional<T>, 普通索引为 std::vector<T>
+     */
+    template <auto Ptr, typename K>
+        requires (IndexSetType::template isIndexed<Ptr>())
+    auto findBy(K const& key) const {
+        std::shared_lock _{_mtx};
+        auto ids = _indexes.template find<Ptr>(key);
+        if constexpr (requires { ids.has_value(); }) {
+            return ids ? std::optional<T>{_map.at(*ids)} : std::optional<T>{};
+        } else {
+            std::vector<T> res;
+            res.reserve(ids.size());
+            for (auto id : ids) {
+                res.push_back(_map.at(id));
+            }
+            return res;
+        }
+    }
+
+    /**
+     * @brief 以二级索引查找主键, O(1)
+     * @return 唯一索引为 std::optional<PrimaryKeyType>, 普通索引为 std::vector<PrimaryKeyType>
+     */
+    template <auto Ptr, typename K>
+        requires (IndexSetType::template isIndexed<Ptr>())
+    auto findIdBy(K const& key) const {
+        std::shared_lock _{_mtx};
+        return _indexes.template find<Ptr>(key);
+    }
+
+    /**
+     * @brief 全文检索 (见 DO 中声明的 `db::TextIndex`), 按相关度返回前 topK 条的主键与得分
+     * @param query 查询文本, 需包含其中全部的词才会命中
+     * @param topK 最多返回的条数
+     * @return std::vector<utils::TextHit<PrimaryKeyType>>
+     */
+    auto search(std::string_view query, std::size_t topK) const
+        requires (IndexSetType::HasTextIndex)
+    {
+        std::shared_lock _{_mtx};
+        return _indexes.search(query, topK);
+    }
+
+    /**
+     * @brief 前缀提示 (见 DO 中声明的 `db::SuggestIndex`), 按出现次数返回至多 topK 条
+     * @param prefix 已输入的前缀
+     * @param topK 最多返回的条数 (不超过索引预存的条数)
+     * @return std::vector<utils::Suggestion>
+     */
+    auto suggest(std::string_view prefix, std::size_t topK) const
+        requires (IndexSetType::HasSuggestIndex)
+    {
+        std::shared_lock _{_mtx};
+        return _indexes.suggest(prefix, topK);
+    }
+
+    /**
+     * @brief 按键升序分页列出以 Ptr 分组的分组及其行数、求和 (见 DO 中声明的 `db::GroupIndex`)
+     * @param after 从大于该键的分组开始, 空为从头开始
+     * @param maxCnt 最多返回的分组数
+     * @return std::vector<utils::GroupStat>
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isGrouped<Ptr>())
+    auto selectGroups(std::string_view after, std::size_t maxCnt) const {
+        std::shared_lock _{_mtx};
+        return _indexes.template groups<Ptr>(after, maxCnt);
+    }
+
+    /**
+     * @brief 按主键升序分页列出以 Ptr 分组时, 分组 key 中的主键 (见 DO 中声明的 `db::GroupIndex`)
+     * @param key 分组的键
+     * @param beginId 从大于该主键的开始
+     * @param maxCnt 最多返回的个数
+     * @return std::vector<PrimaryKeyType>
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isGrouped<Ptr>())
+    auto selectGroupIds(std::string_view key, PrimaryKeyType beginId, std::size_t maxCnt) const {
+        std::shared_lock _{_mtx};
+        return _indexes.template groupIds<Ptr>(key, beginId, maxCnt);
+    }
+
+    /**
+     * @brief 按 Ptr 的顺序分页 (见 DO 中声明的 `db::SortIndex`), O(log n + maxCnt)
+     * @param beginId 游标: 从该主键所在行之后开始, 0 为从头开始
+     * @param offset 在游标之后再跳过的行数, 用于直接跳到任意一页
+     * @param maxCnt 最多返回的个数
+     * @param isDesc 是否降序
+     * @param beginKey 游标行排序字段的原值, 游标行已被删除时据此定位; 按主键排序时不需要
+     * @return std::vector<PrimaryKeyType>
+     * @throw std::out_of_range 游标行已被删除, 且未给出 beginKey
+     */
+    template <auto Ptr>
+        requires (IndexSetType::template isSorted<Ptr>())
+    auto selectSorted(
+        PrimaryKeyType beginId, std::size_t offset, std::size_t maxCnt, bool isDesc,
+        std::optional<std::string_view> beginKey = std::nullopt
+    ) const {
+        std::shared_lock _{_mtx};
+        auto it = beginId ? _map.find(beginId) : _map.end();
+        auto row = it == _map.end() ? nullptr : &it->second;
+        return _indexes.template sorted<Ptr>(row, beginId, beginKey, offset, maxCnt, isDesc);
+    }
+
     template <typename Lambda>
     decltype(auto) uniqueLock(Lambda&& lambda) const {
         std::unique_lock _{_mtx};
@@ -152,8 +380,162 @@ struct ThreadSafeInMemoryDAO {
         return lambda(_map);
     }
 protected:
-    db::SQLiteDB _db;
+    // 以下 xxxImpl 为不加锁的增删改, 需要在持有写锁时调用;
+    // 供派生类把多步修改 (连同自身的索引) 组合在同一次加锁中完成.
+
+    template <typename U>
+        requires (std::convertible_to<U, T>)
+    T addImpl(U&& u) {
+        _indexes.check(u, std::nullopt);
+        if (_writer) {
+            auto id = Base::allocId();
+            db::getFirstPrimaryKeyRef<T>(u) = id;
+            auto [it, ok] = _map.emplace(id, std::forward<U>(u));
+            _indexes.insert(it->second, id);
+            _writer->push([t = it->second](db::SQLiteDB& db) {
+                db.insert<T const&, true>(t);
+            });
+            Base::recordChange(id);
+            return it->second;
+        }
+        auto id = Base::withDb([&](db::SQLiteDB& db) {
+            return db.insert(u);
+        });
+        db::getFirstPrimaryKeyRef<T>(u) = id;
+        auto [it, ok] = _map.emplace(id, std::forward<U>(u));
+        _indexes.insert(it->second, id);
+        Base::recordChange(id);
+        return it->second;
+    }
+
+    std::vector<PrimaryKeyType> addManyImpl(std::vector<T> list) {
+        _indexes.checkMany(list);
+        std::vector<PrimaryKeyType> ids;
+        if (_writer) {
+            ids.reserve(list.size());
+            auto id = Base::allocId(list.size());
+            for (auto& t : list) {
+                ids.push_back(db::getFirstPrimaryKeyRef<T>(t) = id++);
+            }
+            _writer->push([list](db::SQLiteDB& db) {
+                db.insertMany<true>(list);
+            });
+        } else {
+            ids = Base::withDb([&](db::SQLiteDB& db) {
+                return db.insertMany(list);
+            });
+        }
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            db::getFirstPrimaryKeyRef<T>(list[i]) = ids[i];
+            _indexes.insert(list[i], ids[i]);
+            _map.emplace(ids[i], std::move(list[i]));
+            Base::recordChange(ids[i]);
+        }
+        return ids;
+    }
+
+    template <bool IsMustSucceed = false, typename U>
+        requires (std::convertible_to<U, T>)
+    T updateImpl(U&& u) {
+        auto id = db::getFirstPrimaryKeyRef<T>(u);
+        checkExist<IsMustSucceed>(id);
+        _indexes.check(u, id);
+        Base::template persistUpdate<IsMustSucceed>(id, static_cast<T const&>(u));
+        auto it = _map.find(id);
+        if (it == _map.end()) [[unlikely]] {
+            // 不存在的行: 数据库同样没有修改, 不应以默认值插入到 _map
+            return T{std::forward<U>(u)};
+        }
+        auto& data = it->second;
+        _indexes.erase(data, id);
+        data = std::forward<U>(u);
+        _indexes.insert(data, id);
+        Base::recordChange(id);
+        return data;
+    }
+
+    template <bool IsMustSucceed = false, auto... Ptrs>
+        requires (std::is_same_v<meta::GetMemberPtrsClassType<decltype(Ptrs)...>, T>)
+    void updateByImpl(db::GetFirstPrimaryKeyType<T> id, db::FieldPair<Ptrs>... mbPair) {
+        checkExist<IsMustSucceed>(id);
+        auto it = _map.find(id);
+        if constexpr (IndexSetType::template isAnyIndexed<Ptrs...>()) {
+            if (it != _map.end()) {
+                T next = it->second;
+                ((next.*(mbPair.ptr) = mbPair.dataView), ...);
+                _indexes.check(next, id);
+            }
+        }
+        Base::template persistUpdateBy<IsMustSucceed>(id, mbPair...);
+        if (it == _map.end()) [[unlikely]] {
+            return;
+        }
+        auto& data = it->second;
+        if constexpr (IndexSetType::template isAnyIndexed<Ptrs...>()) {
+            _indexes.erase(data, id);
+            ((data.*(mbPair.ptr) = mbPair.dataView), ...);
+            _indexes.insert(data, id);
+        } else {
+            ((data.*(mbPair.ptr) = mbPair.dataView), ...);
+        }
+        Base::recordChange(id);
+    }
+
+    void delImpl(PrimaryKeyType id) {
+        Base::persistDel(id);
+        if (auto it = _map.find(id); it != _map.end()) {
+            _indexes.erase(it->second, id);
+            _map.erase(it);
+            Base::recordChange(id, db::ChangeOp::Delete);
+        }
+    }
+
+    /**
+     * @brief 以原主键重新插入被删除的行, 用于撤销删除
+     */
+    void restoreImpl(PrimaryKeyType id, T const& t) {
+        _indexes.check(t, std::nullopt);
+        if (_writer) {
+            _writer->push([t](db::SQLiteDB& db) {
+                db.insert<T const&, true>(t);
+            });
+        } else {
+            Base::withDb([&](db::SQLiteDB& db) {
+                db.insert<T const&, true>(t);
+            });
+        }
+        auto [it, ok] = _map.emplace(id, t);
+        _indexes.insert(it->second, id);
+        Base::recordChange(id);
+    }
+
+    // 处于 UndoLog 的事务中时复制该行的旧值, 否则不复制
+    std::optional<T> findForUndo(PrimaryKeyType id) const {
+        if (!UndoLog::isActive()) {
+            return std::nullopt;
+        }
+        if (auto it = _map.find(id); it != _map.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    template <bool IsMustSucceed>
+    void checkExist(PrimaryKeyType id) const {
+        // 回写模式下无法得知数据库的修改行数, 以内存中的数据为准
+        if constexpr (IsMustSucceed) {
+            if (_writer && !_map.contains(id)) [[unlikely]] {
+                throw std::runtime_error{"check: Change < 1"};
+            }
+        }
+    }
+
+    using Base::_db;
+    using Base::_writer;
+
     MapType _map;
+    // 二级索引, 与 _map 在同一临界区内修改
+    IndexSetType _indexes{};
     mutable std::shared_mutex _mtx;
 };
 
@@ -0,0 +1,104 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <HXLibs/log/Log.hpp>
+
+namespace HX::dao {
+
+/**
+ * @brief 事务的补偿日志: 事务期间本线程对内存 DAO 的每次修改都登记一个逆操作,
+ *        lambda 抛出异常时按相反的顺序执行, 撤销内存与数据库中已做的修改.
+ * @note 逆操作本身是普通的 DAO 修改; 在写组的事务中执行时与原修改在同一个事务中提交, 净效果为没有修改.
+ *       只撤销本线程的修改, 不隔离其他线程: 期间其他线程对同一行的修改可能被逆操作覆盖.
+ */
+class UndoLog {
+public:
+    /**
+     * @brief 若本线程正处于事务中, 登记一个逆操作; 否则什么也不做
+     * @param undo 形如 `() -> void`, 只捕获值 (以及 DAO 的 this)
+     */
+    template <typename Func>
+    static void record(Func&& undo) {
+        if (auto* log = _current) {
+            log->_undoList.emplace_back(std::forward<Func>(undo));
+        }
+    }
+
+    /**
+     * @brief 本线程是否处于事务中, 用于在登记前决定是否需要保存旧值
+     */
+    static bool isActive() noexcept {
+        return _current != nullptr;
+    }
+
+    /**
+     * @brief 以事务执行 lambda: lambda 抛出异常时先回滚其中的修改, 再继续抛出.
+     *        可嵌套, 内层合并到最外层, 只由最外层回滚.
+     * @param lambda
+     * @return lambda 的返回值
+     */
+    template <typename Lambda>
+    static decltype(auto) run(Lambda&& lambda) {
+        if (_current) {
+            return std::forward<Lambda>(lambda)();
+        }
+        struct Scope {
+            UndoLog log{};
+            int exceptionCnt = std::uncaught_exceptions();
+
+            Scope() noexcept {
+                _current = &log;
+            }
+
+            ~Scope() noexcept {
+                // 回滚期间的修改不再登记
+                _current = nullptr;
+                if (std::uncaught_exceptions() > exceptionCnt) {
+                    log.rollback();
+                }
+            }
+        } _;
+        return std::forward<Lambda>(lambda)();
+    }
+private:
+    void rollback() noexcept {
+        for (auto it = _undoList.rbegin(); it != _undoList.rend(); ++it) {
+            try {
+                (*it)();
+            } catch (std::exception const& e) {
+                log::hxLog.error("事务回滚失败:", e.what());
+            } catch (...) {
+                log::hxLog.error("事务回滚失败: unknown exception");
+            }
+        }
+        _undoList.clear();
+    }
+
+    std::vector<std::function<void()>> _undoList{};
+
+    inline static thread_local UndoLog* _current = nullptr;
+};
+
+} // namespace HX::dao
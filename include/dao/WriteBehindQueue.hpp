@@ -0,0 +1,286 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <HXLibs/container/ThreadPool.hpp>
+#include <HXLibs/log/Log.hpp>
+
+#include <db/SQLiteDB.hpp>
+
+namespace HX::dao {
+
+/**
+ * @brief DAO 的持久化模式
+ */
+enum class WriteMode : uint8_t {
+    WriteThrough,   // 持有写锁时同步写入数据库 (默认)
+    WriteBehind,    // 先更新内存并立即可见, 再由后台写线程批量提交到数据库
+};
+
+/**
+ * @brief 后台写线程的统计
+ */
+struct WriteBehindStats {
+    uint64_t pushCnt;       // 入队的写操作数 (含跨 DAO 事务的开始/结束标记)
+    uint64_t doneCnt;       // 已执行 (提交或失败) 的写操作数 (同上)
+    uint64_t batchCnt;      // 组提交的次数
+    uint64_t failCnt;       // 失败的写操作数
+};
+
+namespace internal {
+
+/**
+ * @brief 回写队列: 由唯一的写线程持有数据库连接, 把排队的写操作合并到同一事务中提交 (组提交).
+ * @note 操作按入队顺序执行; 组提交失败时会回滚, 并逐个重试以隔离出错的操作.
+ *       多个 DAO 可以共用同一个队列 (见 dao::WriteGroup), 此时 beginGroup/endGroup
+ *       之间的操作总在同一个事务中提交.
+ */
+class WriteBehindQueue {
+public:
+    using Op = std::function<void(db::SQLiteDB&)>;
+
+    // 单次组提交的最大操作数, 避免单个事务过大
+    inline static constexpr std::size_t MaxBatchSize = 1024;
+
+    explicit WriteBehindQueue(db::SQLiteDB db)
+        : _db{std::move(db)}
+    {
+        _waitPool.setFixedThreadNum(1);
+        _waitPool.run<container::ThreadPool::Model::FixedSizeAndNoCheck>();
+        _thread = std::jthread{[this](std::stop_token token) {
+            run(token);
+        }};
+    }
+
+    WriteBehindQueue& operator=(WriteBehindQueue&&) noexcept = delete;
+
+    ~WriteBehindQueue() noexcept {
+        // 写线程退出前会把队列中剩余的操作全部提交
+        _thread.request_stop();
+        _cv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    /**
+     * @brief 入队一个写操作
+     * @param op 会在写线程中执行, 只能按值捕获
+     * @return uint64_t 该操作的序号
+     */
+    uint64_t push(Op op) {
+        return pushItem(Kind::Op, std::move(op));
+    }
+
+    /**
+     * @brief 开始一组必须在同一事务中提交的写操作, 需要与 endGroup 成对调用
+     * @note 组内 (包括其他线程在此期间入队) 的操作不会被拆分到不同的组提交中;
+     *       组提交失败而逐个重试时, 组内的操作也作为一个事务重试. 可嵌套.
+     */
+    void beginGroup() {
+        pushItem(Kind::Begin, {});
+    }
+
+    void endGroup() {
+        pushItem(Kind::End, {});
+    }
+
+    /**
+     * @brief 持久化屏障: 阻塞直到此前入队的所有写操作都已执行
+     */
+    void flush() {
+        std::unique_lock lck{_mtx};
+        uint64_t seq = _pushSeq;
+        _doneCv.wait(lck, [&] { return _doneSeq >= seq; });
+    }
+
+    /**
+     * @brief 异步的持久化屏障, 用于协程中 `co_await flushAsync().via(io)`, 不会阻塞事件循环
+     * @return container::FutureResult<>
+     */
+    container::FutureResult<> flushAsync() {
+        uint64_t seq;
+        {
+            std::lock_guard _{_mtx};
+            seq = _pushSeq;
+        }
+        return _waitPool.addTask([this, seq] {
+            std::unique_lock lck{_mtx};
+            _doneCv.wait(lck, [&] { return _doneSeq >= seq; });
+        });
+    }
+
+    /**
+     * @brief 暂停提交, 需要与 resume 成对调用 (可嵌套): 阻塞直到正在进行的组提交完成;
+     *        此后入队的操作只在队列中排队, 直到 resume
+     * @warning 不要在未结束的组 (beginGroup) 中调用, 写线程可能正在等待该组结束
+     */
+    void pause() {
+        std::unique_lock lck{_mtx};
+        ++_pauseCnt;
+        _doneCv.wait(lck, [&] { return !_isCommitting; });
+    }
+
+    void resume() {
+        {
+            std::lock_guard _{_mtx};
+            --_pauseCnt;
+        }
+        _cv.notify_one();
+    }
+
+    WriteBehindStats getStats() const noexcept {
+        return {
+            _pushSeq.load(std::memory_order_relaxed),
+            _doneSeq.load(std::memory_order_relaxed),
+            _batchCnt.load(std::memory_order_relaxed),
+            _failCnt.load(std::memory_order_relaxed),
+        };
+    }
+private:
+    enum class Kind : uint8_t {
+        Op,
+        Begin,  // beginGroup 的标记
+        End,    // endGroup 的标记
+    };
+
+    struct Item {
+        Kind kind;
+        Op op;
+    };
+
+    uint64_t pushItem(Kind kind, Op op) {
+        uint64_t seq;
+        {
+            std::lock_guard _{_mtx};
+            _ops.push_back({kind, std::move(op)});
+            seq = ++_pushSeq;
+        }
+        _cv.notify_one();
+        return seq;
+    }
+
+    static int depthOf(Kind kind) noexcept {
+        return kind == Kind::Begin ? 1 : kind == Kind::End ? -1 : 0;
+    }
+
+    void run(std::stop_token token) {
+        std::vector<Item> batch;
+        for (;;) {
+            uint64_t lastSeq;
+            {
+                std::unique_lock lck{_mtx};
+                _cv.wait(lck, token, [&] { return !_ops.empty() && _pauseCnt == 0; });
+                if (_ops.empty()) {
+                    // 请求停止, 且队列已经清空
+                    break;
+                }
+                _isCommitting = true;
+                int depth = 0;
+                for (;;) {
+                    // 未结束的组不能被截断, 此时不受 MaxBatchSize 限制
+                    while (!_ops.empty() && (batch.size() < MaxBatchSize || depth > 0)) {
+                        depth += depthOf(_ops.front().kind);
+                        batch.push_back(std::move(_ops.front()));
+                        _ops.pop_front();
+                    }
+                    if (depth == 0) {
+                        break;
+                    }
+                    // 等待组的其余操作; 组总会结束, 因此请求停止时也要等待
+                    _cv.wait(lck, [&] { return !_ops.empty(); });
+                }
+                lastSeq = _doneSeq + batch.size();
+            }
+            commit(batch);
+            batch.clear();
+            {
+                std::lock_guard _{_mtx};
+                _doneSeq = lastSeq;
+                _isCommitting = false;
+            }
+            _doneCv.notify_all();
+        }
+    }
+
+    void commit(std::vector<Item>& batch) noexcept {
+        _batchCnt.fetch_add(1, std::memory_order_relaxed);
+        auto exec = [&](std::size_t begin, std::size_t end) {
+            _db.transaction([&] {
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (batch[i].kind == Kind::Op) {
+                        batch[i].op(_db);
+                    }
+                }
+            });
+        };
+        try {
+            exec(0, batch.size());
+            return;
+        } catch (std::exception const& e) {
+            log::hxLog.warning("组提交失败, 逐个重试:", e.what());
+        }
+        // 组外的操作逐个重试, 一个组内的操作作为一个事务重试
+        for (std::size_t i = 0; i < batch.size();) {
+            std::size_t j = i + 1;
+            for (int depth = depthOf(batch[i].kind); depth > 0 && j < batch.size(); ++j) {
+                depth += depthOf(batch[j].kind);
+            }
+            try {
+                exec(i, j);
+            } catch (std::exception const& e) {
+                _failCnt.fetch_add(static_cast<uint64_t>(std::count_if(
+                    batch.begin() + static_cast<std::ptrdiff_t>(i),
+                    batch.begin() + static_cast<std::ptrdiff_t>(j),
+                    [](Item const& item) { return item.kind == Kind::Op; })),
+                    std::memory_order_relaxed);
+                log::hxLog.error("回写失败:", e.what());
+            }
+            i = j;
+        }
+    }
+
+    db::SQLiteDB _db;
+    std::mutex _mtx{};
+    std::condition_variable_any _cv{};
+    std::condition_variable_any _doneCv{};
+    std::deque<Item> _ops{};
+    int _pauseCnt{0};
+    bool _isCommitting{false};
+    std::atomic_uint64_t _pushSeq{0};
+    std::atomic_uint64_t _doneSeq{0};
+    std::atomic_uint64_t _batchCnt{0};
+    std::atomic_uint64_t _failCnt{0};
+    container::ThreadPool _waitPool{};
+    std::jthread _thread{};
+};
+
+} // namespace internal
+
+} // namespace HX::dao
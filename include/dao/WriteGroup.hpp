@@ -0,0 +1,213 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <db/SQLiteDB.hpp>
+#include <dao/WriteBehindQueue.hpp>
+#include <dao/UndoLog.hpp>
+
+namespace HX::dao {
+
+/**
+ * @brief 写组: 一个连接以第一个库为主库, ATTACH 其余的库, 组内所有 DAO 的回写都经由它的同一个写线程提交.
+ * @note 组内 DAO 的修改会被合并到同样的组提交中; transaction 内跨 DAO 的修改总在同一个事务中提交.
+ *       各库仍由各自 DAO 的连接建表与加载; 各库的表名不应重复 (见 SQLiteDB::attach).
+ *       组内的库总以回滚日志模式打开, 跨库的提交因此是原子的 (WAL 下只对每个文件各自原子);
+ *       日志模式是库文件的属性, 各 DAO 自己的连接也需要以 getOpenOptions 打开, 以免切回 WAL.
+ */
+class WriteGroup {
+public:
+    /**
+     * @brief 打开写组的连接
+     * @param paths 数据库文件路径, 第一个为主库, 其余依次附加为 `db1`, `db2`, ...
+     * @param opts 主库以此打开, 附加库也应用其中对单个库生效的设置; 未设置日志模式时使用 DELETE,
+     *        设置为 WAL/MEMORY/OFF 时抛出异常 (跨库的提交不再是原子的)
+     */
+    explicit WriteGroup(std::vector<std::string> paths, db::SQLiteOpenOptions opts = {})
+        : _paths{std::move(paths)}
+        , _opts{std::move(opts)}
+    {
+        if (_paths.empty()) [[unlikely]] {
+            throw std::runtime_error{"WriteGroup: no database"};
+        }
+        // 显式设置, 以便把之前以 WAL 打开过的库切换回来
+        auto mode = _opts.journalMode.value_or(db::JournalMode::Delete);
+        if (mode == db::JournalMode::Wal
+            || mode == db::JournalMode::Memory
+            || mode == db::JournalMode::Off
+        ) [[unlikely]] {
+            throw std::runtime_error{"WriteGroup: commits are only atomic across files with a rollback journal"};
+        }
+        _opts.journalMode = mode;
+        _opts.checkpointInterval = std::chrono::milliseconds{0};
+        db::SQLiteDB db{_paths.front(), _opts};
+        for (std::size_t i = 1; i < _paths.size(); ++i) {
+            db.attach(_paths[i], "db" + std::to_string(i), _opts);
+        }
+        for (auto& path : _paths) {
+            path = normalize(path);
+        }
+        _queue = std::make_shared<internal::WriteBehindQueue>(std::move(db));
+    }
+
+    WriteGroup& operator=(WriteGroup&&) noexcept = delete;
+
+    /**
+     * @brief 数据库文件是否属于本组
+     * @param path
+     */
+    bool contains(std::string_view path) const {
+        auto p = normalize(path);
+        for (auto const& it : _paths) {
+            if (it == p) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 组内的库的打开配置 (回滚日志模式), 组内 DAO 自己的连接也应以此打开
+     */
+    db::SQLiteOpenOptions const& getOpenOptions() const noexcept {
+        return _opts;
+    }
+
+    /**
+     * @brief 跨 DAO 的事务: lambda 中组内 DAO 的所有修改在同一个事务中提交 (只需一次提交)
+     * @note 内存中的修改仍然立即可见; lambda 抛出异常时, 按 UndoLog 逆序撤销已做的修改,
+     *       逆操作与原修改在同一个事务中提交, 然后继续抛出.
+     *       可嵌套; 在此期间其他线程的修改也可能被合并到同一个事务中 (不会被回滚).
+     * @param lambda
+     * @return lambda 的返回值
+     */
+    template <typename Lambda, typename Res = std::invoke_result_t<Lambda>>
+    Res transaction(Lambda&& lambda) {
+        struct EndGroup {
+            internal::WriteBehindQueue& queue;
+            ~EndGroup() noexcept {
+                queue.endGroup();
+            }
+        };
+        _queue->beginGroup();
+        EndGroup _{*_queue};
+        // 回滚在 EndGroup 之前完成, 逆操作因此落在同一组中
+        return UndoLog::run(std::forward<Lambda>(lambda));
+    }
+
+    /**
+     * @brief pause 的返回值, 析构时恢复提交
+     */
+    class PauseGuard {
+    public:
+        explicit PauseGuard(std::shared_ptr<internal::WriteBehindQueue> queue)
+            : _queue{std::move(queue)}
+        {
+            _queue->pause();
+        }
+
+        PauseGuard& operator=(PauseGuard&&) noexcept = delete;
+
+        ~PauseGuard() noexcept {
+            _queue->resume();
+        }
+    private:
+        std::shared_ptr<internal::WriteBehindQueue> _queue;
+    };
+
+    /**
+     * @brief 暂停组的提交, 直到返回值析构: 阻塞直到正在进行的组提交完成, 期间的写操作在内存中排队.
+     * @note 回滚日志模式下, 其他连接持有的读事务 (如在线备份固定的快照) 会阻塞提交,
+     *       先暂停可以避免写线程因等锁超时而提交失败
+     * @warning 不要在 transaction 中调用
+     * @return std::unique_ptr<PauseGuard>
+     */
+    [[nodiscard]] std::unique_ptr<PauseGuard> pause() {
+        return std::make_unique<PauseGuard>(_queue);
+    }
+
+    /**
+     * @brief 持久化屏障: 阻塞直到此前组内的所有写操作都已提交
+     */
+    void flush() {
+        _queue->flush();
+    }
+
+    WriteBehindStats getStats() const noexcept {
+        return _queue->getStats();
+    }
+
+    /**
+     * @brief 获取写组连接的预编译语句缓存统计
+     * @note 在写线程中读取, 会等待此前的写操作提交, 不要在 IO 线程中调用
+     * @return db::StmtCacheStats
+     */
+    db::StmtCacheStats getStmtCacheStats() const {
+        return inspect([](db::SQLiteDB const& db) {
+            return db.getStmtCacheStats();
+        });
+    }
+
+    /**
+     * @brief 获取写组连接上每条语句的执行统计 (按总耗时降序), 同 getStmtCacheStats
+     * @return std::vector<db::StmtProfile>
+     */
+    std::vector<db::StmtProfile> getStmtProfile() const {
+        return inspect([](db::SQLiteDB const& db) {
+            return db.getStmtProfile();
+        });
+    }
+
+    /**
+     * @brief 组内 DAO 共用的回写队列
+     */
+    std::shared_ptr<internal::WriteBehindQueue> const& queue() const noexcept {
+        return _queue;
+    }
+private:
+    template <typename Func, typename Res = std::invoke_result_t<Func, db::SQLiteDB const&>>
+    Res inspect(Func&& func) const {
+        Res res{};
+        _queue->push([&](db::SQLiteDB& db) {
+            res = func(db);
+        });
+        _queue->flush();
+        return res;
+    }
+
+    static std::string normalize(std::string_view path) {
+        std::error_code ec;
+        auto res = std::filesystem::weakly_canonical(std::filesystem::path{path}, ec);
+        return ec ? std::string{path} : res.string();
+    }
+
+    std::vector<std::string> _paths;
+    db::SQLiteOpenOptions _opts;
+    std::shared_ptr<internal::WriteBehindQueue> _queue;
+};
+
+} // namespace HX::dao
@@ -0,0 +1,149 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HX::db {
+
+/**
+ * @brief BLOB 列的二进制编解码
+ * @note 特化需提供 `static std::string encode(T const&)` 与 `static T decode(std::string_view)`
+ * @tparam T
+ */
+template <typename T>
+struct BlobCodec;
+
+template <typename T>
+constexpr bool isBlobCodecVal = requires (T const& t, std::string_view bytes) {
+    { BlobCodec<T>::encode(t) } -> std::same_as<std::string>;
+    { BlobCodec<T>::decode(bytes) } -> std::same_as<T>;
+};
+
+namespace internal {
+
+template <std::integral U>
+inline void writeLE(char* out, U val) noexcept {
+    using UU = std::make_unsigned_t<U>;
+    auto v = static_cast<UU>(val);
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        out[i] = static_cast<char>(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+template <std::integral U>
+inline U readLE(char const* in) noexcept {
+    using UU = std::make_unsigned_t<U>;
+    UU v = 0;
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        v |= static_cast<UU>(static_cast<UU>(static_cast<uint8_t>(in[i])) << (8 * i));
+    }
+    return static_cast<U>(v);
+}
+
+} // namespace internal
+
+/**
+ * @brief 整数数组: 小端定宽紧密排列, 长度即 字节数 / sizeof(U)
+ */
+template <std::integral U>
+struct BlobCodec<std::vector<U>> {
+    static std::string encode(std::vector<U> const& list) {
+        std::string res(list.size() * sizeof(U), '\0');
+        if constexpr (std::endian::native == std::endian::little) {
+            if (!list.empty()) {
+                std::memcpy(res.data(), list.data(), res.size());
+            }
+        } else {
+            for (std::size_t i = 0; i < list.size(); ++i) {
+                internal::writeLE(res.data() + i * sizeof(U), list[i]);
+            }
+        }
+        return res;
+    }
+
+    static std::vector<U> decode(std::string_view bytes) {
+        if (bytes.size() % sizeof(U)) [[unlikely]] {
+            throw std::runtime_error{"BlobCodec: bad integer array size"};
+        }
+        std::vector<U> res(bytes.size() / sizeof(U));
+        if constexpr (std::endian::native == std::endian::little) {
+            if (!res.empty()) {
+                std::memcpy(res.data(), bytes.data(), bytes.size());
+            }
+        } else {
+            for (std::size_t i = 0; i < res.size(); ++i) {
+                res[i] = internal::readLE<U>(bytes.data() + i * sizeof(U));
+            }
+        }
+        return res;
+    }
+};
+
+/**
+ * @brief 字符串数组: 每项为 uint32 小端长度 + 内容
+ */
+template <>
+struct BlobCodec<std::vector<std::string>> {
+    using LenType = uint32_t;
+
+    static std::string encode(std::vector<std::string> const& list) {
+        std::size_t size = 0;
+        for (auto const& str : list) {
+            size += sizeof(LenType) + str.size();
+        }
+        std::string res(size, '\0');
+        char* out = res.data();
+        for (auto const& str : list) {
+            internal::writeLE(out, static_cast<LenType>(str.size()));
+            out += sizeof(LenType);
+            if (!str.empty()) {
+                std::memcpy(out, str.data(), str.size());
+                out += str.size();
+            }
+        }
+        return res;
+    }
+
+    static std::vector<std::string> decode(std::string_view bytes) {
+        std::vector<std::string> res;
+        while (!bytes.empty()) {
+            if (bytes.size() < sizeof(LenType)) [[unlikely]] {
+                throw std::runtime_error{"BlobCodec: truncated string length"};
+            }
+            auto len = internal::readLE<LenType>(bytes.data());
+            bytes.remove_prefix(sizeof(LenType));
+            if (bytes.size() < len) [[unlikely]] {
+                throw std::runtime_error{"BlobCodec: truncated string"};
+            }
+            res.emplace_back(bytes.substr(0, len));
+            bytes.remove_prefix(len);
+        }
+        return res;
+    }
+};
+
+} // namespace HX::db
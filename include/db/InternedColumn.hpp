@@ -0,0 +1,123 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <HXLibs/reflection/json/JsonRead.hpp>
+
+#include <db/SQLiteMeta.hpp>
+#include <db/BlobCodec.hpp>
+#include <utils/StringPool.hpp>
+
+namespace HX::db {
+
+/**
+ * @brief 驻留字符串: 以 TEXT 存储, 读出时驻留
+ */
+template <>
+struct SQLiteSqlType<utils::Symbol> {
+    static std::string bind(utils::Symbol const& sym) {
+        return sym.str();
+    }
+
+    static utils::Symbol columnType(std::string_view str) {
+        return utils::Symbol{str};
+    }
+};
+
+/**
+ * @brief 压缩路径: 以完整路径的 TEXT 存储
+ */
+template <>
+struct SQLiteSqlType<utils::CompactPath> {
+    static std::string bind(utils::CompactPath const& path) {
+        return path.str();
+    }
+
+    static utils::CompactPath columnType(std::string_view str) {
+        return utils::CompactPath{str};
+    }
+};
+
+/**
+ * @brief 驻留字符串数组: 与 std::vector<std::string> 的 BLOB 格式相同, 可直接读取已有数据
+ */
+template <>
+struct BlobCodec<utils::SymbolList> {
+    using LenType = BlobCodec<std::vector<std::string>>::LenType;
+
+    static std::string encode(utils::SymbolList const& list) {
+        std::size_t size = 0;
+        for (auto sym : list) {
+            size += sizeof(LenType) + sym.view().size();
+        }
+        std::string res;
+        res.reserve(size);
+        for (auto sym : list) {
+            auto str = sym.view();
+            char len[sizeof(LenType)];
+            internal::writeLE(len, static_cast<LenType>(str.size()));
+            res.append(len, sizeof(LenType));
+            res += str;
+        }
+        return res;
+    }
+
+    static utils::SymbolList decode(std::string_view bytes) {
+        utils::SymbolList res;
+        while (!bytes.empty()) {
+            if (bytes.size() < sizeof(LenType)) [[unlikely]] {
+                throw std::runtime_error{"BlobCodec: truncated string length"};
+            }
+            auto len = internal::readLE<LenType>(bytes.data());
+            bytes.remove_prefix(sizeof(LenType));
+            if (bytes.size() < len) [[unlikely]] {
+                throw std::runtime_error{"BlobCodec: truncated string"};
+            }
+            res.push_back(utils::Symbol{bytes.substr(0, len)});
+            bytes.remove_prefix(len);
+        }
+        return res;
+    }
+};
+
+template <>
+struct SQLiteSqlType<utils::SymbolList> {
+    static constexpr bool IsBlob = true;
+
+    static std::string bind(utils::SymbolList const& list) {
+        return BlobCodec<utils::SymbolList>::encode(list);
+    }
+
+    static utils::SymbolList columnType(std::string_view bytes) {
+        return BlobCodec<utils::SymbolList>::decode(bytes);
+    }
+
+    // 迁移前以 JSON 数组存储的旧数据
+    static utils::SymbolList columnTypeFromText(std::string_view str) {
+        std::vector<std::string> list;
+        reflection::fromJson(list, str);
+        return utils::SymbolList{list};
+    }
+};
+
+} // namespace HX::db
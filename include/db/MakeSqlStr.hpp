@@ -18,114 +18,325 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <string_view>
+#include <utility>
+
 #include <meta/MemberPtrType.hpp>
 #include <db/SQLiteMeta.hpp>
 #include <HXLibs/meta/TypeTraits.hpp>
+#include <HXLibs/meta/FixedString.hpp>
 #include <HXLibs/reflection/MemberPtr.hpp>
 #include <HXLibs/reflection/TypeName.hpp>
 
 namespace HX::db {
 
-struct MakeSqlStr {
-    template <typename T, bool IsSetPrimaryKey = false>
-    static std::string makeInsertSql() noexcept {
-        using U = meta::remove_cvref_t<T>;
-        std::string sqlName = "INSERT INTO ";
-        sqlName += reflection::getTypeName<U>();
-        sqlName += " (";
-        constexpr auto& obj = reflection::internal::getStaticObj<U>();
-        constexpr auto N = reflection::membersCountVal<U>;
-        std::string sqlVal = ") VALUES (";
-        reflection::forEach(obj, [&] <std::size_t Idx> (
-            std::index_sequence<Idx>, std::string_view name, auto&& val
-        ) constexpr {
-            using Type = meta::remove_cvref_t<decltype(val)>;
-            if constexpr (isPrimaryKeyVal<Type> && !IsSetPrimaryKey) {
-                // 主键不会进行指定
-                return;
-            } else {
-                sqlName += name;
-                sqlVal += '?';
-                if constexpr (Idx + 1 != N) {
-                    sqlVal += ',';
-                    sqlName += ',';
-                }
-            }
+namespace internal {
+
+/**
+ * @brief 编译期生成的 SQL 字符串 ('\0' 结尾)
+ * @tparam N 长度 (不含 '\0')
+ */
+template <std::size_t N>
+struct SqlStr {
+    std::array<char, N + 1> data{};
+
+    constexpr std::string_view view() const noexcept {
+        return {data.data(), N};
+    }
+};
+
+/**
+ * @brief 编译期拼接 SQL 用; out 为空时只统计长度
+ */
+struct SqlWriter {
+    char* out = nullptr;
+    std::size_t len = 0;
+
+    constexpr SqlWriter& operator+=(char c) noexcept {
+        if (out) {
+            out[len] = c;
+        }
+        ++len;
+        return *this;
+    }
+
+    constexpr SqlWriter& operator+=(std::string_view str) noexcept {
+        for (char c : str) {
+            *this += c;
+        }
+        return *this;
+    }
+};
+
+/**
+ * @brief 执行两遍 Build: 第一遍求长度, 第二遍写入
+ * @tparam Build 可默认构造的 `(SqlWriter&) -> void` 的函数对象
+ */
+template <typename Build>
+consteval auto makeSqlStr() {
+    constexpr std::size_t N = [] {
+        SqlWriter w{};
+        Build{}(w);
+        return w.len;
+    }();
+    SqlStr<N> res{};
+    SqlWriter w{res.data.data()};
+    Build{}(w);
+    return res;
+}
+
+/**
+ * @brief 追加在语句后面的 SQL 片段 (where / order by ...)
+ */
+template <meta::FixedString... SqlBody>
+struct SqlBodyList {
+    static constexpr void appendTo(SqlWriter& sql) noexcept {
+        ((sql += meta::ToCharPack<SqlBody>::view()), ...);
+    }
+};
+
+/**
+ * @brief 成员指针在 T 的成员中的索引
+ * @tparam T
+ * @tparam Ptr 成员指针
+ */
+template <typename T, auto Ptr>
+consteval std::size_t getMemberPtrIndex() {
+    constexpr auto tp = reflection::internal::getStaticObjPtrTuple<T>();
+    constexpr auto& obj = reflection::internal::getStaticObj<T>();
+    return [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+        std::size_t res = sizeof...(Is);
+        ((static_cast<void const*>(std::get<Is>(tp))
+            == static_cast<void const*>(&(obj.*Ptr)) ? (res = Is) : 0), ...);
+        return res;
+    }(std::make_index_sequence<std::tuple_size_v<decltype(tp)>>{});
+}
+
+/**
+ * @brief 成员指针对应的字段名
+ * @tparam Ptr 成员指针
+ */
+template <auto Ptr>
+consteval std::string_view getMemberPtrName() {
+    using T = meta::GetMemberPtrClassType<decltype(Ptr)>;
+    constexpr auto Idx = getMemberPtrIndex<T, Ptr>();
+    static_assert(Idx < reflection::membersCountVal<T>, "member ptr not found");
+    return reflection::getMembersNames<T>()[Idx];
+}
+
+template <typename T, std::size_t I>
+using ColumnType = meta::remove_cvref_t<
+    decltype(*std::get<I>(reflection::internal::getStaticObjPtrTuple<T>()))>;
+
+/**
+ * @brief 按顺序写出 T 的字段 (以 ',' 分隔), 可选跳过主键
+ * @param fmt 形如 `(SqlWriter&, std::string_view name) -> void`
+ */
+template <typename T, bool IsSetPrimaryKey, typename Fmt>
+constexpr void forEachColumn(SqlWriter& sql, Fmt fmt) noexcept {
+    constexpr auto names = reflection::getMembersNames<T>();
+    constexpr auto isColumn = [] <std::size_t... Is> (std::index_sequence<Is...>) {
+        // 主键不会进行指定
+        return std::array<bool, sizeof...(Is)>{
+            (IsSetPrimaryKey || !isPrimaryKeyVal<ColumnType<T, Is>>)...
+        };
+    }(std::make_index_sequence<names.size()>{});
+    bool isFirst = true;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (!isColumn[i]) {
+            continue;
+        }
+        if (!isFirst) {
+            sql += ',';
+        }
+        isFirst = false;
+        fmt(sql, names[i]);
+    }
+}
+
+template <typename T, bool IsSetPrimaryKey>
+struct InsertSqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        sql += "INSERT INTO ";
+        sql += reflection::getTypeName<T>();
+        sql += " (";
+        forEachColumn<T, IsSetPrimaryKey>(sql, [](SqlWriter& s, std::string_view name) {
+            s += name;
         });
-        sqlName += std::move(sqlVal);
-        sqlName += ");";
-        return sqlName;
-    }
-
-    template <typename T, typename... MemberPtr>
-        requires (sizeof...(MemberPtr) >= 1 && (meta::IsMemberPtrVal<MemberPtr> && ...))
-    static std::string makeInsertSql(MemberPtr... ptrs) noexcept {
-        using U = meta::remove_cvref_t<T>;
-        std::string sqlName = "INSERT INTO ";
-        sqlName += reflection::getTypeName<U>();
-        sqlName += " (";
-        constexpr auto& obj = reflection::internal::getStaticObj<U>();
-        constexpr auto N = reflection::membersCountVal<U>;
-        std::string sqlVal = ") VALUES (";
-        auto map = reflection::makeMemberPtrToNameMap<U>();
-        (([&](){
-            sqlName += map.at(ptrs);
-            sqlName += ',';
-            sqlVal += '?';
-            sqlVal += ',';
-        }()), ...);
-        sqlName.pop_back();
-        sqlVal.back() = ')';
-        sqlName += std::move(sqlVal);
-        sqlName += ';';
-        return sqlName;
+        sql += ") VALUES (";
+        forEachColumn<T, IsSetPrimaryKey>(sql, [](SqlWriter& s, std::string_view) {
+            s += '?';
+        });
+        sql += ");";
     }
+};
 
-    template <typename T, bool IsSetPrimaryKey = false>
-    static std::string makeUpdateSqlFragment() noexcept {
-        using U = meta::remove_cvref_t<T>;
-        std::string sql = "UPDATE ";
-        sql += reflection::getTypeName<U>();
+
+template <auto... Ptrs>
+struct InsertBySqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        using T = meta::GetMemberPtrsClassType<decltype(Ptrs)...>;
+        sql += "INSERT INTO ";
+        sql += reflection::getTypeName<T>();
+        sql += " (";
+        bool isFirst = true;
+        ((sql += (std::exchange(isFirst, false) ? "" : ","), sql += getMemberPtrName<Ptrs>()), ...);
+        sql += ") VALUES (";
+        isFirst = true;
+        ((sql += (std::exchange(isFirst, false) ? "?" : ",?"), (void)Ptrs), ...);
+        sql += ");";
+    }
+};
+
+
+template <typename T, typename Body>
+struct UpdateSqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        sql += "UPDATE ";
+        sql += reflection::getTypeName<T>();
         sql += " SET ";
-        constexpr auto& obj = reflection::internal::getStaticObj<U>();
-        constexpr auto N = reflection::membersCountVal<U>;
-        reflection::forEach(obj, [&] <std::size_t Idx> (
-            std::index_sequence<Idx>, std::string_view name, auto&& val
-        ) constexpr {
-            using Type = meta::remove_cvref_t<decltype(val)>;
-            if constexpr (isPrimaryKeyVal<Type> && !IsSetPrimaryKey) {
-                // 主键不会进行指定
-                return;
-            } else {
-                sql += name;
-                sql += '=';
-                sql += '?';
-                if constexpr (Idx + 1 != N) {
-                    sql += ',';
-                } else {
-                    sql += ' ';
-                }
-            }
+        forEachColumn<T, false>(sql, [](SqlWriter& s, std::string_view name) {
+            s += name;
+            s += "=?";
         });
-        return sql;
+        sql += ' ';
+        Body::appendTo(sql);
     }
+};
+
 
-    template <typename T, typename... MemberPtr>
-        requires (sizeof...(MemberPtr) >= 1 && (meta::IsMemberPtrVal<MemberPtr> && ...))
-    static std::string makeUpdateSqlFragment(MemberPtr... ptrs) noexcept {
-        using U = meta::remove_cvref_t<T>;
-        std::string sql = "UPDATE ";
-        sql += reflection::getTypeName<U>();
+template <typename Body, auto... Ptrs>
+struct UpdateBySqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        using T = meta::GetMemberPtrsClassType<decltype(Ptrs)...>;
+        sql += "UPDATE ";
+        sql += reflection::getTypeName<T>();
         sql += " SET ";
-        auto map = reflection::makeMemberPtrToNameMap<U>();
-        (([&](){
-            sql += map.at(ptrs);
-            sql += '=';
-            sql += '?';
-            sql += ',';
-        }()), ...);
-        sql.back() = ' ';
-        return sql;
+        bool isFirst = true;
+        ((sql += (std::exchange(isFirst, false) ? "" : ","),
+          sql += getMemberPtrName<Ptrs>(),
+          sql += "=?"), ...);
+        sql += ' ';
+        Body::appendTo(sql);
+    }
+};
+
+
+template <typename T, typename Body>
+struct DeleteSqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        sql += "DELETE FROM ";
+        sql += reflection::getTypeName<T>();
+        sql += ' ';
+        Body::appendTo(sql);
+    }
+};
+
+
+template <typename T, typename Body>
+struct SelectSqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        sql += "SELECT * FROM ";
+        sql += reflection::getTypeName<T>();
+        sql += ' ';
+        Body::appendTo(sql);
+    }
+};
+
+
+/**
+ * @brief 任意 SQL, 由 SqlBody 直接拼接而成
+ */
+template <typename Body>
+struct RawSqlBuilder {
+    constexpr void operator()(SqlWriter& sql) const noexcept {
+        Body::appendTo(sql);
+    }
+};
+
+/**
+ * @brief Build 对应的 SQL 常量, 每种 Build 只会生成一份
+ */
+template <typename Build>
+inline constexpr auto SqlOf = makeSqlStr<Build>();
+
+} // namespace internal
+
+/**
+ * @brief 编译期生成 SQL, 返回的 string_view 指向静态存储, 生命周期为整个程序
+ */
+struct MakeSqlStr {
+    // 以下的 Builder 类型同时作为 SQL 的唯一标识 (如 SQLiteDB 以其分配语句槽位)
+
+    template <typename T, bool IsSetPrimaryKey = false>
+    using Insert = internal::InsertSqlBuilder<meta::remove_cvref_t<T>, IsSetPrimaryKey>;
+
+    template <auto... Ptrs>
+        requires (sizeof...(Ptrs) >= 1 && (meta::IsMemberPtrVal<decltype(Ptrs)> && ...))
+    using InsertBy = internal::InsertBySqlBuilder<Ptrs...>;
+
+    template <typename T, meta::FixedString... SqlBody>
+    using Update = internal::UpdateSqlBuilder<
+        meta::remove_cvref_t<T>, internal::SqlBodyList<SqlBody...>>;
+
+    /**
+     * @brief 只更新指定字段
+     * @tparam Body internal::SqlBodyList<SqlBody...>
+     * @tparam Ptrs 成员指针
+     */
+    template <typename Body, auto... Ptrs>
+        requires (sizeof...(Ptrs) >= 1 && (meta::IsMemberPtrVal<decltype(Ptrs)> && ...))
+    using UpdateBy = internal::UpdateBySqlBuilder<Body, Ptrs...>;
+
+    template <typename T, meta::FixedString... SqlBody>
+    using Delete = internal::DeleteSqlBuilder<
+        meta::remove_cvref_t<T>, internal::SqlBodyList<SqlBody...>>;
+
+    template <typename T, meta::FixedString... SqlBody>
+    using Select = internal::SelectSqlBuilder<
+        meta::remove_cvref_t<T>, internal::SqlBodyList<SqlBody...>>;
+
+    template <meta::FixedString... Sql>
+    using Raw = internal::RawSqlBuilder<internal::SqlBodyList<Sql...>>;
+
+    /**
+     * @brief 获取 Build 对应的 SQL 文本
+     * @tparam Build 上面的 Builder 类型之一
+     */
+    template <typename Build>
+    static constexpr std::string_view view() noexcept {
+        return internal::SqlOf<Build>.view();
+    }
+
+    template <typename T, bool IsSetPrimaryKey = false>
+    static constexpr std::string_view makeInsertSql() noexcept {
+        return view<Insert<T, IsSetPrimaryKey>>();
+    }
+
+    template <auto... Ptrs>
+    static constexpr std::string_view makeInsertBySql() noexcept {
+        return view<InsertBy<Ptrs...>>();
+    }
+
+    template <typename T, meta::FixedString... SqlBody>
+    static constexpr std::string_view makeUpdateSql() noexcept {
+        return view<Update<T, SqlBody...>>();
+    }
+
+    template <typename Body, auto... Ptrs>
+    static constexpr std::string_view makeUpdateBySql() noexcept {
+        return view<UpdateBy<Body, Ptrs...>>();
+    }
+
+    template <typename T, meta::FixedString... SqlBody>
+    static constexpr std::string_view makeDeleteSql() noexcept {
+        return view<Delete<T, SqlBody...>>();
+    }
+
+    template <typename T, meta::FixedString... SqlBody>
+    static constexpr std::string_view makeSelectSql() noexcept {
+        return view<Select<T, SqlBody...>>();
     }
 };
 
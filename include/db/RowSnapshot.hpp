@@ -0,0 +1,445 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <HXLibs/meta/ContainerConcepts.hpp>
+#include <HXLibs/reflection/MemberName.hpp>
+#include <HXLibs/reflection/TypeName.hpp>
+
+#include <db/SQLiteMeta.hpp>
+#include <db/BlobCodec.hpp>
+
+namespace HX::db {
+
+// 表的二进制快照文件, 格式 (整数均为小端):
+// - 文件头 64 字节: 魔数 `HXSNAP\0\0`, 格式版本 u32, 保留 u32, 表结构哈希 u64,
+//   变更序号 u64 (见 SQLiteDB::getChangeSeq), 行数 u64, 主键表偏移 u64, 文件大小 u64, 校验和 u64
+// - 行数据: 按成员顺序逐个编码; 整数/浮点为 8 字节, 其余为 u32 长度 + 与数据库列相同的字节
+//   (即 SQLiteSqlType::bind 的结果), 因此加载时无需 JSON 解析
+// - 主键表: 按主键升序的 (主键 i64, 行偏移 u64), 8 字节对齐
+// 校验和覆盖文件头之后的全部字节; 版本、表结构或校验和任一不符, 快照即视为无效.
+
+namespace internal {
+
+inline constexpr char SnapshotMagic[8] = {'H', 'X', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+// 修改编码方式时递增, 旧快照随之失效
+inline constexpr uint32_t SnapshotVersion = 1;
+
+inline constexpr std::size_t SnapshotHeaderSize = 64;
+
+/**
+ * @brief 快照的校验和: 以 8 字节为单位的 FNV-1a
+ * @note 除最后一次外, 每次 update 的长度需为 8 的倍数
+ */
+class SnapshotHasher {
+public:
+    void update(std::string_view bytes) noexcept {
+        std::size_t i = 0;
+        for (; i + 8 <= bytes.size(); i += 8) {
+            _hash = (_hash ^ readLE<uint64_t>(bytes.data() + i)) * Prime;
+        }
+        for (; i < bytes.size(); ++i) {
+            _hash = (_hash ^ static_cast<uint8_t>(bytes[i])) * Prime;
+        }
+    }
+
+    uint64_t get() const noexcept {
+        return _hash;
+    }
+private:
+    static constexpr uint64_t Prime = 0x100000001b3ULL;
+    uint64_t _hash = 0xcbf29ce484222325ULL;
+};
+
+/**
+ * @brief 字段在快照中的编码方式, 与 StmtCallChain::bind 的分派一致
+ */
+template <typename U>
+constexpr char snapshotFieldKind() noexcept {
+    using T = RemovePrimaryKeyType<U>;
+    if constexpr (std::is_integral_v<T>) {
+        return 'i';
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return 'f';
+    } else if constexpr (isSQLiteBlobVal<T>) {
+        return 'b';
+    } else if constexpr (meta::StringType<T> || isSQLiteSqlTypeVal<T>) {
+        return 't';
+    } else {
+        // 不支持该类型
+        static_assert(!sizeof(T), "type is not sql type");
+    }
+}
+
+/**
+ * @brief 表结构哈希: 表名, 以及每个成员的名称与编码方式
+ */
+template <typename T>
+uint64_t snapshotSchemaHash() {
+    SnapshotHasher hasher;
+    hasher.update(reflection::getTypeName<T>());
+    auto obj = reflection::internal::getStaticObj<T>();
+    reflection::forEach(obj, [&] <std::size_t Idx> (
+        std::index_sequence<Idx>, std::string_view name, auto&& val
+    ) {
+        char const kind = snapshotFieldKind<meta::remove_cvref_t<decltype(val)>>();
+        hasher.update(name);
+        hasher.update({&kind, 1});
+    });
+    return hasher.get();
+}
+
+template <std::integral U>
+inline void appendLE(std::string& out, U val) {
+    char buf[sizeof(U)];
+    writeLE(buf, val);
+    out.append(buf, sizeof(U));
+}
+
+inline void appendBytes(std::string& out, std::string_view bytes) {
+    appendLE(out, static_cast<uint32_t>(bytes.size()));
+    out += bytes;
+}
+
+inline std::string_view takeBytes(std::string_view& in, std::size_t n) {
+    if (in.size() < n) [[unlikely]] {
+        throw std::runtime_error{"snapshot: truncated row"};
+    }
+    auto res = in.substr(0, n);
+    in.remove_prefix(n);
+    return res;
+}
+
+template <std::integral U>
+inline U takeLE(std::string_view& in) {
+    return readLE<U>(takeBytes(in, sizeof(U)).data());
+}
+
+template <typename U>
+void encodeSnapshotField(std::string& out, U const& val) {
+    using T = RemovePrimaryKeyType<U>;
+    if constexpr (std::is_integral_v<T>) {
+        appendLE(out, static_cast<int64_t>(static_cast<T const&>(val)));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        appendLE(out, std::bit_cast<uint64_t>(static_cast<double>(val)));
+    } else if constexpr (isSQLiteBlobVal<T> || isSQLiteSqlTypeVal<T>) {
+        appendBytes(out, SQLiteSqlType<T>::bind(val));
+    } else {
+        appendBytes(out, val);
+    }
+}
+
+template <typename U>
+U decodeSnapshotField(std::string_view& in) {
+    using T = RemovePrimaryKeyType<U>;
+    if constexpr (std::is_integral_v<T>) {
+        return U{static_cast<T>(takeLE<int64_t>(in))};
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(std::bit_cast<double>(takeLE<uint64_t>(in)));
+    } else {
+        auto bytes = takeBytes(in, takeLE<uint32_t>(in));
+        if constexpr (isSQLiteBlobVal<T> || isSQLiteSqlTypeVal<T>) {
+            return SQLiteSqlType<T>::columnType(bytes);
+        } else {
+            return T{bytes.data(), bytes.size()};
+        }
+    }
+}
+
+/**
+ * @brief 只读地映射整个文件; 非 POSIX 平台退化为读入内存
+ */
+class MappedFile {
+public:
+    explicit MappedFile(std::string const& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) [[unlikely]] {
+            throw std::runtime_error{"snapshot: failed to open " + path};
+        }
+        struct ::stat st{};
+        if (::fstat(fd, &st) != 0) [[unlikely]] {
+            ::close(fd);
+            throw std::runtime_error{"snapshot: failed to stat " + path};
+        }
+        _size = static_cast<std::size_t>(st.st_size);
+        if (_size) {
+            void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED) [[unlikely]] {
+                throw std::runtime_error{"snapshot: failed to mmap " + path};
+            }
+            // 加载时顺序读取
+            ::madvise(addr, _size, MADV_SEQUENTIAL);
+            _data = static_cast<char const*>(addr);
+        } else {
+            ::close(fd);
+        }
+#else
+        std::ifstream file{path, std::ios::binary};
+        if (!file) [[unlikely]] {
+            throw std::runtime_error{"snapshot: failed to open " + path};
+        }
+        _buf.assign(std::istreambuf_iterator<char>{file}, {});
+        _data = _buf.data();
+        _size = _buf.size();
+#endif
+    }
+
+    MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+    ~MappedFile() noexcept {
+#ifndef _WIN32
+        if (_size) {
+            ::munmap(const_cast<char*>(_data), _size);
+        }
+#endif
+    }
+
+    std::string_view view() const noexcept {
+        return {_data, _size};
+    }
+private:
+    char const* _data{};
+    std::size_t _size{};
+#ifdef _WIN32
+    std::string _buf;
+#endif
+};
+
+} // namespace internal
+
+/**
+ * @brief 把 rows 编码为表 T 在变更序号 changeSeq 时的快照, 写入 tmpPath (不重命名)
+ * @note 调用方在确认快照可以生效后再把 tmpPath 重命名为正式路径, 见 writeRowSnapshot
+ * @tparam T 表对应的类型
+ * @param tmpPath 临时文件路径
+ * @param changeSeq rows 对应的变更序号
+ * @param rows 按主键升序的 (主键, T const&) 序列
+ */
+template <typename T, typename Rows>
+void encodeRowSnapshot(std::string const& tmpPath, uint64_t changeSeq, Rows const& rows) {
+    using namespace internal;
+    std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+    if (!file) [[unlikely]] {
+        throw std::runtime_error{"snapshot: failed to create " + tmpPath};
+    }
+    SnapshotHasher hasher;
+    std::string buf;
+    uint64_t offset = SnapshotHeaderSize;
+    // 攒够一批再写出; 只写出 8 的倍数个字节, 余下的留到下一批, 以便按 8 字节计算校验和
+    auto flush = [&](bool isAll) {
+        std::size_t n = isAll ? buf.size() : buf.size() / 8 * 8;
+        hasher.update({buf.data(), n});
+        file.write(buf.data(), static_cast<std::streamsize>(n));
+        offset += n;
+        buf.erase(0, n);
+    };
+    file.write(std::string(SnapshotHeaderSize, '\0').data(), SnapshotHeaderSize);
+    std::vector<std::pair<int64_t, uint64_t>> ids;
+    for (auto&& [id, row] : rows) {
+        ids.emplace_back(static_cast<int64_t>(id), offset + buf.size());
+        auto tp = reflection::internal::getObjTie<T>(row);
+        [&] <std::size_t... Idx> (std::index_sequence<Idx...>) {
+            (encodeSnapshotField(buf, std::get<Idx>(tp)), ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(tp)>>{});
+        if (buf.size() >= (1U << 20)) {
+            flush(false);
+        }
+    }
+    buf.append((8 - (offset + buf.size()) % 8) % 8, '\0');
+    uint64_t const idTableOffset = offset + buf.size();
+    for (auto const& [id, rowOffset] : ids) {
+        appendLE(buf, id);
+        appendLE(buf, rowOffset);
+        if (buf.size() >= (1U << 20)) {
+            flush(false);
+        }
+    }
+    flush(true);
+    std::string header{SnapshotMagic, sizeof(SnapshotMagic)};
+    appendLE(header, SnapshotVersion);
+    appendLE(header, uint32_t{0});
+    appendLE(header, snapshotSchemaHash<T>());
+    appendLE(header, changeSeq);
+    appendLE(header, static_cast<uint64_t>(ids.size()));
+    appendLE(header, idTableOffset);
+    appendLE(header, offset);
+    appendLE(header, hasher.get());
+    file.seekp(0);
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.close();
+    if (!file) [[unlikely]] {
+        std::filesystem::remove(tmpPath);
+        throw std::runtime_error{"snapshot: failed to write " + tmpPath};
+    }
+}
+
+/**
+ * @brief 把 rows 写为表 T 在变更序号 changeSeq 时的快照
+ * @note 先写入 `path.tmp`, 完成后再重命名, 因此 path 上不会出现写了一半的文件
+ * @tparam T 表对应的类型
+ * @param path 快照文件路径
+ * @param changeSeq rows 对应的变更序号
+ * @param rows 按主键升序的 (主键, T const&) 序列
+ */
+template <typename T, typename Rows>
+void writeRowSnapshot(std::string const& path, uint64_t changeSeq, Rows const& rows) {
+    std::string const tmpPath = path + ".tmp";
+    encodeRowSnapshot<T>(tmpPath, changeSeq, rows);
+    std::filesystem::rename(tmpPath, path);
+}
+
+/**
+ * @brief 已映射并校验过的表 T 的快照
+ * @tparam T 表对应的类型
+ */
+template <typename T>
+class RowSnapshot {
+public:
+    /**
+     * @brief 映射并校验快照文件
+     * @param path 快照文件路径
+     * @throw std::runtime_error 无法读取, 或版本/表结构/校验和不符
+     */
+    explicit RowSnapshot(std::string const& path)
+        : _file{path}
+    {
+        using namespace internal;
+        auto data = _file.view();
+        if (data.size() < SnapshotHeaderSize
+            || data.substr(0, sizeof(SnapshotMagic)) != std::string_view{SnapshotMagic, sizeof(SnapshotMagic)}
+        ) [[unlikely]] {
+            throw std::runtime_error{"snapshot: bad magic"};
+        }
+        auto header = data.substr(sizeof(SnapshotMagic), SnapshotHeaderSize - sizeof(SnapshotMagic));
+        if (takeLE<uint32_t>(header) != SnapshotVersion) [[unlikely]] {
+            throw std::runtime_error{"snapshot: version mismatch"};
+        }
+        (void)takeLE<uint32_t>(header);
+        if (takeLE<uint64_t>(header) != snapshotSchemaHash<T>()) [[unlikely]] {
+            throw std::runtime_error{"snapshot: schema mismatch"};
+        }
+        _changeSeq = takeLE<uint64_t>(header);
+        _rowCnt = takeLE<uint64_t>(header);
+        auto idTableOffset = takeLE<uint64_t>(header);
+        auto fileSize = takeLE<uint64_t>(header);
+        auto checksum = takeLE<uint64_t>(header);
+        if (fileSize != data.size()
+            || idTableOffset > fileSize
+            || fileSize - idTableOffset != _rowCnt * 16
+        ) [[unlikely]] {
+            throw std::runtime_error{"snapshot: bad size"};
+        }
+        SnapshotHasher hasher;
+        hasher.update(data.substr(SnapshotHeaderSize));
+        if (hasher.get() != checksum) [[unlikely]] {
+            throw std::runtime_error{"snapshot: checksum mismatch"};
+        }
+        _idTable = data.substr(idTableOffset);
+    }
+
+    /**
+     * @brief 快照对应的变更序号
+     */
+    uint64_t changeSeq() const noexcept {
+        return _changeSeq;
+    }
+
+    std::size_t size() const noexcept {
+        return _rowCnt;
+    }
+
+    /**
+     * @brief 快照中是否有主键为 id 的行 (在主键表上二分, 不解码行)
+     */
+    bool contains(int64_t id) const noexcept {
+        std::size_t lo = 0, hi = _rowCnt;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            auto val = idAt(mid);
+            if (val == id) {
+                return true;
+            }
+            if (val < id) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 按主键升序解码每一行
+     * @param func 形如 `(T&&) -> void`
+     */
+    template <typename Func>
+    void forEach(Func&& func) const {
+        using namespace internal;
+        auto data = _file.view();
+        for (std::size_t i = 0; i < _rowCnt; ++i) {
+            auto offset = readLE<uint64_t>(_idTable.data() + i * 16 + 8);
+            if (offset >= data.size()) [[unlikely]] {
+                throw std::runtime_error{"snapshot: bad row offset"};
+            }
+            auto in = data.substr(offset);
+            T row{};
+            reflection::forEach(row, [&] <std::size_t Idx> (
+                std::index_sequence<Idx>, std::string_view, auto& val
+            ) {
+                val = decodeSnapshotField<meta::remove_cvref_t<decltype(val)>>(in);
+            });
+            func(std::move(row));
+        }
+    }
+private:
+    int64_t idAt(std::size_t i) const noexcept {
+        return internal::readLE<int64_t>(_idTable.data() + i * 16);
+    }
+
+    internal::MappedFile _file;
+    std::string_view _idTable;
+    uint64_t _changeSeq{};
+    uint64_t _rowCnt{};
+};
+
+} // namespace HX::db
@@ -0,0 +1,160 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include <sqlite3.h>
+
+namespace HX::db {
+
+/**
+ * @brief 在线备份的进度 (页)
+ */
+struct BackupProgress {
+    int remaining;  // 剩余页数
+    int pageCnt;    // 总页数
+};
+
+/**
+ * @brief 在线增量备份 (sqlite3_backup_*)
+ * @note 使用独立的只读连接, 并在其上一直持有一个读事务, 相当于固定了构造时刻的快照:
+ *       WAL 模式下其他连接的写入既不会被阻塞, 也不会使备份重新开始 (回滚日志模式下则会阻塞写入者提交).
+ *       先写入 `目标路径.tmp`, 完成后再重命名, 因此目标路径上不会出现写了一半的文件.
+ */
+class SQLiteBackup {
+public:
+    SQLiteBackup(std::string const& srcPath, std::string dstPath)
+        : _dstPath{std::move(dstPath)}
+        , _tmpPath{_dstPath + ".tmp"}
+    {
+        try {
+            if (::sqlite3_open_v2(srcPath.c_str(), &_src,
+                SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK
+            ) [[unlikely]] {
+                throw std::runtime_error{"Failed to open backup source: " + errMsg(_src)};
+            }
+            ::sqlite3_busy_timeout(_src, 5000);
+            // 开启读事务并真正读一次, 此刻起快照即被固定
+            if (::sqlite3_exec(_src, "BEGIN; SELECT count(*) FROM sqlite_master;",
+                nullptr, nullptr, nullptr) != SQLITE_OK
+            ) [[unlikely]] {
+                throw std::runtime_error{"Failed to begin backup snapshot: " + errMsg(_src)};
+            }
+            std::filesystem::remove(_tmpPath);
+            if (::sqlite3_open_v2(_tmpPath.c_str(), &_dst,
+                SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK
+            ) [[unlikely]] {
+                throw std::runtime_error{"Failed to open backup target: " + errMsg(_dst)};
+            }
+            _backup = ::sqlite3_backup_init(_dst, "main", _src, "main");
+            if (!_backup) [[unlikely]] {
+                throw std::runtime_error{"Failed to init backup: " + errMsg(_dst)};
+            }
+        } catch (...) {
+            close();
+            std::filesystem::remove(_tmpPath);
+            throw;
+        }
+    }
+
+    SQLiteBackup& operator=(SQLiteBackup&&) noexcept = delete;
+
+    ~SQLiteBackup() noexcept {
+        bool isDone = _isDone;
+        close();
+        if (!isDone) {
+            // 未完成就析构: 丢弃临时文件
+            std::error_code ec;
+            std::filesystem::remove(_tmpPath, ec);
+        }
+    }
+
+    /**
+     * @brief 复制至多 pages 页 (负数为全部剩余页)
+     * @return true 已完成, 目标文件已就位
+     * @throw std::runtime_error 备份失败
+     */
+    bool step(int pages) {
+        if (_isDone) {
+            return true;
+        }
+        switch (::sqlite3_backup_step(_backup, pages)) {
+            case SQLITE_OK:
+            case SQLITE_BUSY:
+            case SQLITE_LOCKED:
+                _progress = {::sqlite3_backup_remaining(_backup), ::sqlite3_backup_pagecount(_backup)};
+                return false;
+            case SQLITE_DONE:
+                break;
+            default:
+                throw std::runtime_error{"Backup step failed: " + errMsg(_dst)};
+        }
+        _progress = {0, ::sqlite3_backup_pagecount(_backup)};
+        if (::sqlite3_backup_finish(_backup) != SQLITE_OK) [[unlikely]] {
+            _backup = nullptr;
+            throw std::runtime_error{"Backup finish failed: " + errMsg(_dst)};
+        }
+        _backup = nullptr;
+        close();
+        std::filesystem::rename(_tmpPath, _dstPath);
+        _isDone = true;
+        return true;
+    }
+
+    BackupProgress getProgress() const noexcept {
+        return _progress;
+    }
+
+    std::string const& getDstPath() const noexcept {
+        return _dstPath;
+    }
+private:
+    static std::string errMsg(::sqlite3* db) {
+        return db ? ::sqlite3_errmsg(db) : "out of memory";
+    }
+
+    void close() noexcept {
+        if (_backup) {
+            ::sqlite3_backup_finish(_backup);
+            _backup = nullptr;
+        }
+        if (_src) {
+            ::sqlite3_exec(_src, "ROLLBACK;", nullptr, nullptr, nullptr);
+            ::sqlite3_close(_src);
+            _src = nullptr;
+        }
+        if (_dst) {
+            ::sqlite3_close(_dst);
+            _dst = nullptr;
+        }
+    }
+
+    std::string _dstPath;
+    std::string _tmpPath;
+    ::sqlite3* _src{};
+    ::sqlite3* _dst{};
+    ::sqlite3_backup* _backup{};
+    BackupProgress _progress{-1, -1};
+    bool _isDone = false;
+};
+
+} // namespace HX::db
@@ -0,0 +1,94 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace HX::db {
+
+/**
+ * @brief 行变更类型
+ */
+enum class ChangeOp : uint8_t {
+    Upsert,     // 新增或修改
+    Delete,     // 删除
+};
+
+/**
+ * @brief 变更日志中的一条记录; 每行只保留最后一次变更
+ */
+struct ChangeRecord {
+    uint64_t seq;       // 全库单调递增的变更序号
+    int64_t rowId;      // 该行的主键
+    ChangeOp op;
+};
+
+namespace internal {
+
+inline constexpr std::string_view ChangeLogTable = "_hx_change_log";
+
+/**
+ * @brief 生成变更日志表, 以及记录 table 上每次增删改的触发器
+ * @note 触发器中先删后插, 使每行只有一条记录 (序号为最后一次变更的), 日志大小不会超过表曾有的行数;
+ *       不使用 INSERT OR REPLACE, 以免被外层语句的冲突处理方式覆盖.
+ * @param table 表名
+ * @param pk 主键列名
+ * @return std::string
+ */
+inline std::string makeChangeLogSql(std::string_view table, std::string_view pk) {
+    std::string const tbl{table};
+    std::string const log{ChangeLogTable};
+    auto record = [&](std::string_view row, ChangeOp op) {
+        std::string res = "DELETE FROM " + log + " WHERE tbl = '" + tbl + "' AND rid = ";
+        res += row;
+        res += "; INSERT INTO " + log + " (tbl, rid, op) VALUES ('" + tbl + "', ";
+        res += row;
+        res += ", " + std::to_string(static_cast<int>(op)) + ");";
+        return res;
+    };
+    auto trigger = [&](std::string_view event, std::string const& body) {
+        std::string res = "CREATE TRIGGER IF NOT EXISTS _hx_log_" + tbl + '_';
+        res += event;
+        res += " AFTER ";
+        res += event;
+        res += " ON " + tbl + " BEGIN " + body + " END;";
+        return res;
+    };
+    std::string const newPk = "NEW." + std::string{pk};
+    std::string const oldPk = "OLD." + std::string{pk};
+    std::string sql = "CREATE TABLE IF NOT EXISTS " + log
+        + " (seq INTEGER PRIMARY KEY AUTOINCREMENT, tbl TEXT NOT NULL,"
+          " rid INTEGER NOT NULL, op INTEGER NOT NULL, UNIQUE (tbl, rid));"
+          "CREATE INDEX IF NOT EXISTS idx_" + log + "_tbl_seq ON " + log + " (tbl, seq);";
+    sql += trigger("INSERT", record(newPk, ChangeOp::Upsert));
+    // 主键被修改时, 旧主键视为删除
+    std::string updateBody = "DELETE FROM " + log + " WHERE tbl = '" + tbl + "' AND rid = " + oldPk
+        + " AND " + oldPk + " <> " + newPk + "; INSERT INTO " + log + " (tbl, rid, op) SELECT '"
+        + tbl + "', " + oldPk + ", " + std::to_string(static_cast<int>(ChangeOp::Delete))
+        + " WHERE " + oldPk + " <> " + newPk + "; " + record(newPk, ChangeOp::Upsert);
+    sql += trigger("UPDATE", updateBody);
+    sql += trigger("DELETE", record(oldPk, ChangeOp::Delete));
+    return sql;
+}
+
+} // namespace internal
+
+} // namespace HX::db
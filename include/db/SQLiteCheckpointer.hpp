@@ -0,0 +1,141 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sqlite3.h>
+
+#include <HXLibs/log/Log.hpp>
+
+namespace HX::db {
+
+/**
+ * @brief WAL 检查点统计
+ */
+struct CheckpointStats {
+    uint64_t walBytes;          // 最近一次检查点后 -wal 文件的大小 (字节)
+    int logFrames;              // 最近一次检查点时 WAL 中的帧数
+    int checkpointedFrames;     // 最近一次检查点写回数据库的帧数
+    uint64_t runCnt;            // 已执行的检查点次数
+};
+
+namespace internal {
+
+/**
+ * @brief 后台 WAL 检查点线程
+ * @note 使用独立的连接执行 `wal_checkpoint(PASSIVE)`, 不会与请求路径上的连接争用互斥锁;
+ *       PASSIVE 模式不会等待读写者, 因此也不会阻塞它们.
+ */
+class WalCheckpointer {
+public:
+    WalCheckpointer(std::string filePath, std::chrono::milliseconds interval)
+        : _filePath{std::move(filePath)}
+        , _interval{interval}
+    {
+        if (::sqlite3_open_v2(_filePath.c_str(), &_db,
+            SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK
+        ) [[unlikely]] {
+            std::string err = ::sqlite3_errmsg(_db);
+            ::sqlite3_close(_db);
+            throw std::runtime_error{"Failed to open checkpoint connection: " + err};
+        }
+        ::sqlite3_busy_timeout(_db, 1000);
+        // 让连接读取一次数据库头, 否则在首次访问前 checkpoint 会认为不是 WAL 模式
+        ::sqlite3_exec(_db, "PRAGMA journal_mode;", nullptr, nullptr, nullptr);
+        _thread = std::jthread{[this](std::stop_token token) {
+            run(token);
+        }};
+    }
+
+    WalCheckpointer& operator=(WalCheckpointer&&) noexcept = delete;
+
+    ~WalCheckpointer() noexcept {
+        _thread.request_stop();
+        _cv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        // 退出前做一次完整的检查点, 尽量让 -wal 文件归零
+        ::sqlite3_wal_checkpoint_v2(_db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+        ::sqlite3_close(_db);
+    }
+
+    CheckpointStats getStats() const noexcept {
+        return {
+            _walBytes.load(std::memory_order_relaxed),
+            _logFrames.load(std::memory_order_relaxed),
+            _checkpointedFrames.load(std::memory_order_relaxed),
+            _runCnt.load(std::memory_order_relaxed),
+        };
+    }
+private:
+    void run(std::stop_token token) {
+        std::unique_lock lck{_mtx};
+        for (;;) {
+            // 只会因超时或者请求停止而返回
+            _cv.wait_for(lck, token, _interval, [] { return false; });
+            if (token.stop_requested()) {
+                break;
+            }
+            int logFrames = 0, checkpointedFrames = 0;
+            if (::sqlite3_wal_checkpoint_v2(_db, nullptr, SQLITE_CHECKPOINT_PASSIVE,
+                &logFrames, &checkpointedFrames) != SQLITE_OK
+            ) [[unlikely]] {
+                log::hxLog.warning("wal_checkpoint 失败:", _filePath, ::sqlite3_errmsg(_db));
+                continue;
+            }
+            std::error_code ec;
+            uint64_t walBytes = std::filesystem::file_size(_filePath + "-wal", ec);
+            if (ec) {
+                walBytes = 0;
+            }
+            _walBytes.store(walBytes, std::memory_order_relaxed);
+            _checkpointedFrames.store(checkpointedFrames, std::memory_order_relaxed);
+            _runCnt.fetch_add(1, std::memory_order_relaxed);
+            if (_logFrames.exchange(logFrames, std::memory_order_relaxed) != logFrames) {
+                log::hxLog.debug("wal_checkpoint:", _filePath,
+                    "帧:", checkpointedFrames, "/", logFrames,
+                    "wal 大小:", walBytes);
+            }
+        }
+    }
+
+    std::string _filePath;
+    std::chrono::milliseconds _interval;
+    ::sqlite3* _db{};
+    std::mutex _mtx{};
+    std::condition_variable_any _cv{};
+    std::atomic_uint64_t _walBytes{0};
+    std::atomic_int _logFrames{0};
+    std::atomic_int _checkpointedFrames{0};
+    std::atomic_uint64_t _runCnt{0};
+    std::jthread _thread{};
+};
+
+} // namespace internal
+
+} // namespace HX::db
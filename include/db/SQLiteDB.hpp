@@ -18,17 +18,21 @@
  * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <string>
 #include <string_view>
 #include <stdexcept>
 #include <vector>
-#include <map>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <utility>
 
 #include <sqlite3.h>
 
 #include <meta/StaticConstexpr.hpp>
 #include <meta/MemberPtrType.hpp>
-#include <meta/TypeId.hpp>
 
 #include <HXLibs/meta/FixedString.hpp>
 #include <HXLibs/reflection/MemberName.hpp>
@@ -43,18 +47,24 @@
 #include <db/MakeSqlStr.hpp>
 #include <db/SQLiteMeta.hpp>
 #include <db/SQLiteStmt.hpp>
+#include <db/SQLiteOpenOptions.hpp>
+#include <db/SQLiteCheckpointer.hpp>
+#include <db/SQLiteProfiler.hpp>
+#include <db/SQLiteBackup.hpp>
+#include <db/SQLiteChangeLog.hpp>
 
 namespace HX::db {
 
 /**
- * @brief 字段匹配对 (成员指针, 值)
- * @tparam MemberPtr
+ * @brief 字段匹配对 (成员指针, 值), 如 `FieldPair<&UserDO::name>{name}`
+ * @note 成员指针作为模板参数, 以便在编译期生成 SQL, 并且不同字段一定对应不同的缓存语句
+ * @tparam Ptr 成员指针
  */
-template <typename MemberPtr>
-    requires (meta::IsMemberPtrVal<MemberPtr>)
+template <auto Ptr>
+    requires (meta::IsMemberPtrVal<decltype(Ptr)>)
 struct FieldPair {
-    MemberPtr ptr;                                      // 成员指针
-    meta::GetMemberPtrType<MemberPtr> const& dataView;  // 成员值
+    inline static constexpr auto ptr = Ptr;                 // 成员指针
+    meta::GetMemberPtrType<decltype(Ptr)> const& dataView;  // 成员值
 };
 
 namespace internal {
@@ -83,6 +93,8 @@ constexpr std::string_view getSqlTypeStr() {
         return "INTEGER";
     } else if constexpr (std::is_floating_point_v<T>) {
         return "REAL";
+    } else if constexpr (isSQLiteBlobVal<T>) {
+        return "BLOB";
     } else if constexpr (meta::StringType<T> || isSQLiteSqlTypeVal<T>) {
         return "TEXT";
     } else {
@@ -100,6 +112,43 @@ inline void execSql(std::string_view sql, ::sqlite3* db) {
     }
 }
 
+/**
+ * @brief 事务守卫: 构造时 BEGIN, 显式 commit() 提交; 未提交就析构则回滚.
+ * @note 如果构造时已经处于事务中, 则不会开启新的事务, 其提交/回滚交由外层事务决定.
+ */
+class [[nodiscard]] Transaction {
+public:
+    explicit Transaction(::sqlite3* db)
+        : _db{db}
+        , _isOwner{::sqlite3_get_autocommit(db) != 0}
+    {
+        if (_isOwner) {
+            // IMMEDIATE: 开始时就拿写锁, 避免读锁升级写锁时的 SQLITE_BUSY
+            execSql("BEGIN IMMEDIATE;", _db);
+        }
+    }
+
+    Transaction(Transaction const&) = delete;
+    Transaction& operator=(Transaction const&) = delete;
+
+    void commit() {
+        if (_isOwner) {
+            execSql("COMMIT;", _db);
+            _isOwner = false;
+        }
+    }
+
+    ~Transaction() noexcept {
+        if (_isOwner) [[unlikely]] {
+            // 回滚失败也没有更多可以做的了, 不能在析构中抛异常
+            ::sqlite3_exec(_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        }
+    }
+private:
+    ::sqlite3* _db;
+    bool _isOwner;
+};
+
 #if 0
 
 constexpr bool isSpace(char c) noexcept {
@@ -274,6 +323,10 @@ struct [[nodiscard]] StmtCallChain {
                     ::sqlite3_bind_int64(_stmt, _cnt, t);
                 } else if constexpr (std::is_floating_point_v<RemoveKeyT>) {
                     ::sqlite3_bind_double(_stmt, _cnt, t);
+                } else if constexpr (isSQLiteBlobVal<RemoveKeyT>) {
+                    auto bytes = SQLiteSqlType<RemoveKeyT>::bind(t);
+                    // 注意空数组也要绑定为空 BLOB 而不是 NULL, 故 data() 不能为 nullptr
+                    ::sqlite3_bind_blob(_stmt, _cnt, bytes.data(), bytes.size(), SQLITE_TRANSIENT);
                 } else if constexpr (meta::StringType<RemoveKeyT> || isSQLiteSqlTypeVal<RemoveKeyT>) {
                     if constexpr (isSQLiteSqlTypeVal<RemoveKeyT>) {
                         auto str = SQLiteSqlType<RemoveKeyT>::bind(t);
@@ -291,6 +344,14 @@ struct [[nodiscard]] StmtCallChain {
         return *this;
     }
 
+    /**
+     * @brief 获取底层的预编译语句 (用于逐行读取结果)
+     * @return SQLiteStmt&
+     */
+    SQLiteStmt& getStmt() noexcept {
+        return _stmt;
+    }
+
     // 执行
     bool exec() noexcept {
         bool res = _stmt.step() == SQLITE_DONE;
@@ -341,8 +402,137 @@ private:
     std::size_t _cnt;
 };
 
+/**
+ * @brief 把当前行按成员顺序解码到 t 中
+ * @tparam T
+ * @param stmt 已经 step 到 SQLITE_ROW 的语句
+ * @param t
+ */
+template <typename T>
+void readRow(SQLiteStmt& stmt, T& t) {
+    reflection::forEach(t, [&] <std::size_t Idx> (
+        std::index_sequence<Idx>, std::string_view, auto& val
+    ) {
+        using ValType = meta::remove_cvref_t<decltype(val)>;
+        val = stmt.getColumnByIndex<ValType>(Idx);
+    });
+}
+
+/**
+ * @brief 语句槽位: 每种 SQL (即 MakeSqlStr 的 Builder 类型) 首次使用时分配一个全局唯一的下标,
+ *        之后按下标直接访问各个 SQLiteDB 中缓存的预编译语句.
+ */
+struct StmtSlot {
+    template <typename Build>
+    static std::size_t get() noexcept {
+        static const std::size_t id = next();
+        return id;
+    }
+private:
+    static std::size_t next() noexcept {
+        static std::atomic_size_t cnt{0};
+        return cnt.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
 } // namespace internal
 
+/**
+ * @brief 预编译语句缓存的统计
+ */
+struct StmtCacheStats {
+    uint64_t prepareCnt;    // 预编译次数 (稳定运行时应不再增长)
+    uint64_t hitCnt;        // 命中缓存次数
+    std::size_t stmtCnt;    // 当前缓存的语句数
+};
+
+/**
+ * @brief 查询游标: 一次只解码一行的输入范围 (input_range).
+ * @note 持有预编译语句, 仅可遍历一次; 迭代器解引用得到的是游标内部的行对象,
+ *       可以直接 std::move 走, 下一次 ++ 时会被重新赋值.
+ * @tparam T 行类型
+ */
+template <typename T>
+class [[nodiscard]] QueryCursor {
+public:
+    class Iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(QueryCursor* cursor) noexcept
+            : _cursor{cursor}
+        {}
+
+        T& operator*() const noexcept {
+            return _cursor->_row;
+        }
+
+        T* operator->() const noexcept {
+            return std::addressof(_cursor->_row);
+        }
+
+        Iterator& operator++() {
+            _cursor->next();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return _cursor->_isDone;
+        }
+    private:
+        QueryCursor* _cursor{};
+    };
+
+    explicit QueryCursor(internal::StmtCallChain stmt)
+        : _stmt{std::move(stmt)}
+    {}
+
+    QueryCursor(QueryCursor const&) = delete;
+    QueryCursor& operator=(QueryCursor const&) = delete;
+    QueryCursor(QueryCursor&&) noexcept = default;
+    QueryCursor& operator=(QueryCursor&&) noexcept = default;
+
+    Iterator begin() {
+        if (!_isStarted) {
+            _isStarted = true;
+            next();
+        }
+        return Iterator{this};
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+private:
+    void next() {
+        auto& stmt = _stmt.getStmt();
+        switch (stmt.step()) {
+            case SQLITE_ROW:
+                internal::readRow(stmt, _row);
+                break;
+            case SQLITE_DONE:
+                _isDone = true;
+                break;
+            default:
+                _isDone = true;
+                throw std::runtime_error{"Query failed: " + stmt.getErrMsg()};
+        }
+    }
+
+    internal::StmtCallChain _stmt;
+    T _row{};
+    bool _isStarted = false;
+    bool _isDone = false;
+};
+
 class SQLiteDB {
     template <typename T>
     using PrimaryKeyType = decltype(
@@ -354,36 +544,100 @@ class SQLiteDB {
         internal::execSql(sql, _db);
     }
 
-    template <typename InitFunc>
-        requires (std::is_same_v<std::invoke_result_t<InitFunc>, internal::StmtCallChain>)
-    internal::StmtCallChain& getSqlCache(meta::TypeId::IdType typeId, InitFunc&& init) {
-        auto it = _sqlCache.find(typeId);
-        if (it == _sqlCache.end()) [[unlikely]] {
-            auto [jt, ok] = _sqlCache.emplace(typeId, init());
-            if (!ok) [[unlikely]] {
-                throw std::runtime_error{"getSqlCache: emplace err"};
+    /**
+     * @brief 建立 T 声明的索引 (`idx_表名_列名`); 全文、前缀提示、分组聚合与排序索引只在内存中维护, 跳过
+     * @note 旧数据中已有重复值时无法建立唯一索引, 此时仅告警, 唯一性由内存索引在写入时保证
+     */
+    template <typename T, typename... Idx>
+    void createIndexes(IndexList<Idx...>) const {
+        ([&] {
+            if constexpr (!(Idx::IsText || Idx::IsSuggest || Idx::IsGroup || Idx::IsSort)) {
+                constexpr std::string_view table = reflection::getTypeName<T>();
+                constexpr std::string_view col = internal::getMemberPtrName<Idx::ptr>();
+                std::string sql = Idx::IsUnique
+                    ? "CREATE UNIQUE INDEX IF NOT EXISTS idx_"
+                    : "CREATE INDEX IF NOT EXISTS idx_";
+                sql += table;
+                sql += '_';
+                sql += col;
+                sql += " ON ";
+                sql += table;
+                sql += " (";
+                sql += col;
+                sql += ");";
+                try {
+                    exec(sql);
+                } catch (std::exception const& e) {
+                    log::hxLog.warning("建立索引失败:", sql, e.what());
+                }
             }
-            return jt->second;
+        }(), ...);
+    }
+
+    /**
+     * @brief 获取 (首次则预编译) Build 对应的语句
+     * @tparam Build MakeSqlStr 中的 Builder 类型
+     * @return internal::StmtCallChain&
+     */
+    template <typename Build>
+    internal::StmtCallChain& getStmt() {
+        auto const slot = internal::StmtSlot::get<Build>();
+        if (slot < _stmtSlots.size() && _stmtSlots[slot]) [[likely]] {
+            ++_stmtHitCnt;
+            return *_stmtSlots[slot];
+        }
+        if (slot >= _stmtSlots.size()) {
+            _stmtSlots.resize(slot + 1);
+        }
+        _stmtSlots[slot] = std::make_unique<internal::StmtCallChain>(
+            MakeSqlStr::view<Build>(), _db);
+        ++_stmtPrepareCnt;
+        if (_profiler) {
+            _profiler->track(_stmtSlots[slot]->getStmt().native());
         }
-        return it->second;
+        return *_stmtSlots[slot];
     }
 public:
     SQLiteDB() : _db{} {}
 
-    SQLiteDB(std::string_view filePath)
+    SQLiteDB(std::string_view filePath, SQLiteOpenOptions const& opts = {})
         : SQLiteDB{}
     {
         log::hxLog.debug("make dbFile:", filePath); // debug
-        if (::sqlite3_open(filePath.data(), &_db) != SQLITE_OK) [[unlikely]] {
-            throw std::runtime_error{
-                "Failed to open database: " + std::string{::sqlite3_errmsg(_db)}
-            };
+        std::string path{filePath};
+        int flags = opts.isReadOnly
+            ? SQLITE_OPEN_READONLY
+            : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+        if (::sqlite3_open_v2(path.c_str(), &_db, flags, nullptr) != SQLITE_OK) [[unlikely]] {
+            std::string err = ::sqlite3_errmsg(_db);
+            ::sqlite3_close(_db);
+            _db = nullptr;
+            throw std::runtime_error{"Failed to open database: " + err};
+        }
+        bool isCheckpointByThread = opts.journalMode == JournalMode::Wal
+                                 && opts.checkpointInterval.count() > 0;
+        ::sqlite3_busy_timeout(_db, opts.busyTimeoutMs);
+        if (opts.isProfile) {
+            // 先于 PRAGMA 等语句挂上, 以便也统计到它们
+            _profiler = std::make_unique<internal::StmtProfiler>(_db);
+        }
+        if (auto sql = internal::makePragmaSql(opts, isCheckpointByThread); !sql.empty()) {
+            exec(sql);
+        }
+        if (isCheckpointByThread) {
+            _checkpointer = std::make_unique<internal::WalCheckpointer>(
+                std::move(path), opts.checkpointInterval);
         }
     }
 
     SQLiteDB(SQLiteDB const&) = delete;
     SQLiteDB(SQLiteDB&& that) noexcept
         : _db{that._db}
+        , _stmtSlots{std::move(that._stmtSlots)}
+        , _stmtPrepareCnt{that._stmtPrepareCnt}
+        , _stmtHitCnt{that._stmtHitCnt}
+        , _checkpointer{std::move(that._checkpointer)}
+        , _profiler{std::move(that._profiler)}
     {
         that._db = nullptr;
     }
@@ -391,15 +645,85 @@ public:
     SQLiteDB& operator=(SQLiteDB const&) noexcept = delete;
     SQLiteDB& operator=(SQLiteDB&& that) noexcept {
         std::swap(_db, that._db);
+        std::swap(_stmtSlots, that._stmtSlots);
+        std::swap(_stmtPrepareCnt, that._stmtPrepareCnt);
+        std::swap(_stmtHitCnt, that._stmtHitCnt);
+        std::swap(_checkpointer, that._checkpointer);
+        std::swap(_profiler, that._profiler);
         return *this;
     }
 
     ~SQLiteDB() noexcept {
+        // 先停止检查点线程, 再 finalize 所有预编译语句, 否则 sqlite3_close 会返回 SQLITE_BUSY
+        _checkpointer.reset();
+        _stmtSlots.clear();
         if (_db) {
             ::sqlite3_close(_db);
         }
     }
 
+    /**
+     * @brief 获取后台 WAL 检查点的统计信息
+     * @return std::optional<CheckpointStats> 未启用后台检查点时为空
+     */
+    std::optional<CheckpointStats> getCheckpointStats() const noexcept {
+        if (!_checkpointer) {
+            return {};
+        }
+        return _checkpointer->getStats();
+    }
+
+    /**
+     * @brief 获取预编译语句缓存的统计信息
+     * @return StmtCacheStats
+     */
+    StmtCacheStats getStmtCacheStats() const noexcept {
+        std::size_t cnt = 0;
+        for (auto const& p : _stmtSlots) {
+            cnt += static_cast<bool>(p);
+        }
+        return {_stmtPrepareCnt, _stmtHitCnt, cnt};
+    }
+
+    /**
+     * @brief 在线备份到 path: 每步复制 pagesPerStep 页, 步与步之间让出, 写入者至多被阻塞一步的时间
+     * @note 使用独立的连接读取调用时刻的快照 (见 SQLiteBackup), 不占用本连接; 阻塞直到完成,
+     *       需要在后台线程中调用, 或直接使用 SQLiteBackup 自行调度每一步.
+     * @param path 目标文件路径
+     * @param pagesPerStep 每步复制的页数
+     */
+    void backupTo(std::string path, int pagesPerStep = 64) const {
+        char const* srcPath = ::sqlite3_db_filename(_db, "main");
+        if (!srcPath || !*srcPath) [[unlikely]] {
+            throw std::runtime_error{"backupTo: database has no file"};
+        }
+        SQLiteBackup backup{srcPath, std::move(path)};
+        while (!backup.step(pagesPerStep)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief 获取每条语句的执行统计 (按总耗时降序); 未开启 SQLiteOpenOptions::isProfile 时为空
+     * @return std::vector<StmtProfile>
+     */
+    std::vector<StmtProfile> getStmtProfile() const {
+        if (!_profiler) {
+            return {};
+        }
+        return _profiler->getProfiles();
+    }
+
+    /**
+     * @brief 获取任意 SQL 的缓存语句, 需要再绑定占位符并执行
+     * @tparam Sql 拼接而成的完整 SQL
+     * @return internal::StmtCallChain&
+     */
+    template <meta::FixedString... Sql>
+    internal::StmtCallChain& sql() {
+        return getStmt<MakeSqlStr::Raw<Sql...>>();
+    }
+
     template <typename T>
     void createDatabase() const {
         // @todo 非空等属性
@@ -425,6 +749,186 @@ public:
         });
         sql += ");";
         exec(sql);
+        createIndexes<T>(GetIndexList<T>{});
+    }
+
+    /**
+     * @brief 预编译 insert 语句, 使请求路径上的第一次插入不必再 prepare
+     */
+    template <typename T, bool IsSetPrimaryKey = false>
+    void prepareInsert() {
+        (void)getStmt<MakeSqlStr::Insert<T, IsSetPrimaryKey>>();
+    }
+
+    /**
+     * @brief 预编译 update<SqlBody...> 语句
+     */
+    template <typename T, meta::FixedString... SqlBody>
+    void prepareUpdate() {
+        (void)getStmt<MakeSqlStr::Update<T, SqlBody...>>();
+    }
+
+    /**
+     * @brief 预编译 deleteBy<T, SqlBody...> 语句
+     */
+    template <typename T, meta::FixedString... SqlBody>
+    void prepareDelete() {
+        (void)getStmt<MakeSqlStr::Delete<T, SqlBody...>>();
+    }
+
+    /**
+     * @brief 把旧版以文本 (JSON) 存储的 BLOB 列就地转换为二进制
+     * @note 只处理 `typeof(列) = 'text'` 的行, 全部转换完成后再次调用不会有任何修改;
+     *       解析旧数据依赖 SQLiteSqlType<列类型>::columnTypeFromText.
+     * @tparam T 表对应的类型
+     * @return std::size_t 转换的行数
+     */
+    template <typename T>
+    std::size_t migrateTextToBlob() {
+        constexpr auto names = reflection::getMembersNames<T>();
+        constexpr auto PkIdx = GetFirstPrimaryKeyIndex<T>;
+        std::size_t res = 0;
+        auto migrate = [&] <std::size_t Idx> (std::index_sequence<Idx>) {
+            using ColType = internal::ColumnType<T, Idx>;
+            if constexpr (isSQLiteBlobVal<ColType>) {
+                std::string const table{reflection::getTypeName<T>()};
+                std::string const pk{names[PkIdx]}, col{names[Idx]};
+                std::vector<std::pair<int64_t, ColType>> rows;
+                {
+                    SQLiteStmt stmt{"SELECT " + pk + ", " + col + " FROM " + table
+                        + " WHERE typeof(" + col + ") = 'text'", _db};
+                    for (int rc = stmt.step(); rc == SQLITE_ROW; rc = stmt.step()) {
+                        rows.emplace_back(stmt.getColumnByIndex<int64_t>(0),
+                                          stmt.getColumnByIndex<ColType>(1));
+                    }
+                }
+                if (rows.empty()) {
+                    return;
+                }
+                internal::StmtCallChain upd{
+                    "UPDATE " + table + " SET " + col + " = ? WHERE " + pk + " = ?", _db};
+                transaction([&] {
+                    for (auto const& [id, val] : rows) {
+                        upd.bind<true>(val, id).execOnThrow();
+                    }
+                });
+                log::hxLog.info("migrate", table + '.' + col, "TEXT -> BLOB:", rows.size());
+                res += rows.size();
+            }
+        };
+        [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+            (migrate(std::index_sequence<Is>{}), ...);
+        }(std::make_index_sequence<names.size()>{});
+        return res;
+    }
+
+    /**
+     * @brief 建立变更日志表, 以及 T 上记录变更的触发器
+     * @note 此后对 T 的任何写入 (包括其他连接与外部工具) 都会在同一事务中记录该行的最后一次变更,
+     *       可由 getChangesSince 取得某个序号之后变更过的行.
+     * @tparam T 表对应的类型
+     */
+    template <typename T>
+    void createChangeLog() const {
+        constexpr auto names = reflection::getMembersNames<T>();
+        exec(internal::makeChangeLogSql(
+            reflection::getTypeName<T>(), names[GetFirstPrimaryKeyIndex<T>]));
+    }
+
+    /**
+     * @brief 获取变更日志当前的最大序号; 尚无任何变更时为 0
+     * @return uint64_t
+     */
+    uint64_t getChangeSeq() const {
+        SQLiteStmt stmt{"SELECT ifnull(max(seq), 0) FROM " + std::string{internal::ChangeLogTable}, _db};
+        if (stmt.step() != SQLITE_ROW) [[unlikely]] {
+            throw std::runtime_error{"getChangeSeq: " + stmt.getErrMsg()};
+        }
+        return stmt.getColumnByIndex<uint64_t>(0);
+    }
+
+    /**
+     * @brief 获取表 T 在序号 seq 之后变更过的行 (按序号升序), 每行只有最后一次变更
+     * @tparam T 表对应的类型
+     * @param seq 不包含该序号
+     * @return std::vector<ChangeRecord>
+     */
+    template <typename T>
+    std::vector<ChangeRecord> getChangesSince(uint64_t seq) const {
+        internal::StmtCallChain stmt{
+            "SELECT seq, rid, op FROM " + std::string{internal::ChangeLogTable}
+            + " WHERE tbl = ? AND seq > ? ORDER BY seq", _db};
+        (void)stmt.bind<true>(std::string{reflection::getTypeName<T>()}, seq);
+        std::vector<ChangeRecord> res;
+        auto& raw = stmt.getStmt();
+        int rc;
+        while ((rc = raw.step()) == SQLITE_ROW) {
+            res.push_back({
+                raw.getColumnByIndex<uint64_t>(0),
+                raw.getColumnByIndex<int64_t>(1),
+                static_cast<ChangeOp>(raw.getColumnByIndex<int>(2)),
+            });
+        }
+        if (rc != SQLITE_DONE) [[unlikely]] {
+            throw std::runtime_error{"getChangesSince: " + raw.getErrMsg()};
+        }
+        return res;
+    }
+
+    /**
+     * @brief 表 T 的行数
+     * @tparam T 表对应的类型
+     * @return std::size_t
+     */
+    template <typename T>
+    std::size_t count() const {
+        SQLiteStmt stmt{"SELECT count(*) FROM " + std::string{reflection::getTypeName<T>()}, _db};
+        if (stmt.step() != SQLITE_ROW) [[unlikely]] {
+            throw std::runtime_error{"count: " + stmt.getErrMsg()};
+        }
+        return stmt.getColumnByIndex<std::size_t>(0);
+    }
+
+    /**
+     * @brief 表 T 的 rowid 范围 [最小, 最大]
+     * @tparam T 表对应的类型
+     * @return std::optional<std::pair<int64_t, int64_t>> 空表为空
+     */
+    template <typename T>
+    std::optional<std::pair<int64_t, int64_t>> getRowIdRange() const {
+        SQLiteStmt stmt{"SELECT min(rowid), max(rowid) FROM " + std::string{reflection::getTypeName<T>()}, _db};
+        if (stmt.step() != SQLITE_ROW) [[unlikely]] {
+            throw std::runtime_error{"getRowIdRange: " + stmt.getErrMsg()};
+        }
+        if (::sqlite3_column_type(stmt.native(), 0) == SQLITE_NULL) {
+            return {};
+        }
+        return std::pair{stmt.getColumnByIndex<int64_t>(0), stmt.getColumnByIndex<int64_t>(1)};
+    }
+
+    /**
+     * @brief 数据库文件路径; 内存数据库或临时数据库为空
+     * @return std::string
+     */
+    std::string getFilePath() const {
+        char const* path = ::sqlite3_db_filename(_db, "main");
+        return path ? path : "";
+    }
+
+    /**
+     * @brief 把另一个数据库文件附加 (ATTACH) 到本连接上, 此后可在同一事务中读写各库的表
+     * @note 不带库名的表名按 main、各附加库的顺序取第一个同名的表, 因此各库的表名不应重复;
+     *       rollback 日志模式下跨库的提交是原子的, WAL 模式下只对每个文件各自原子.
+     * @param filePath 数据库文件路径
+     * @param schema 库名
+     * @param opts 对该库生效的设置 (journal_mode、synchronous 等), 连接级的设置会被忽略
+     */
+    void attach(std::string_view filePath, std::string_view schema, SQLiteOpenOptions const& opts = {}) {
+        internal::StmtCallChain stmt{"ATTACH DATABASE ? AS " + std::string{schema}, _db};
+        stmt.bind<true>(std::string{filePath}).execOnThrow();
+        if (auto sql = internal::makePragmaSql(opts, false, schema); !sql.empty()) {
+            exec(sql);
+        }
     }
 
     template <typename T, bool IsSetPrimaryKey = false>
@@ -432,58 +936,113 @@ public:
         using U = meta::remove_cvref_t<T>;
         auto tp = reflection::internal::getObjTie<U>(t);
         return [&] <std::size_t... Idx> (std::index_sequence<Idx...>) {
-            return getSqlCache(
-                meta::TypeId::make<&SQLiteDB::insert<U, IsSetPrimaryKey>>(),
-                [&] {
-                    return internal::StmtCallChain{MakeSqlStr::makeInsertSql<U, IsSetPrimaryKey>(), _db};
-                }
-            ).template bind<IsSetPrimaryKey>(std::get<Idx>(tp)...)
-             .template getLastInsertPrimaryKeyId<U>();
+            return getStmt<MakeSqlStr::Insert<U, IsSetPrimaryKey>>()
+                .template bind<IsSetPrimaryKey>(std::get<Idx>(tp)...)
+                .template getLastInsertPrimaryKeyId<U>();
         }(std::make_index_sequence<std::tuple_size_v<decltype(tp)>>{});
     }
 
     template <
-        typename... MemberPtr,
-        typename U = meta::GetMemberPtrsClassType<MemberPtr...>
+        auto... Ptrs,
+        typename U = meta::GetMemberPtrsClassType<decltype(Ptrs)...>
     >
-    PrimaryKeyType<U> insertBy(FieldPair<MemberPtr>... fmPair) {
-        return getSqlCache(
-            meta::TypeId::make<&SQLiteDB::insertBy<MemberPtr...>>(),
-            [&] {
-                return internal::StmtCallChain{
-                    MakeSqlStr::makeInsertSql<U, MemberPtr...>(fmPair.ptr...),
-                    _db
-                };
+    PrimaryKeyType<U> insertBy(FieldPair<Ptrs>... fmPair) {
+        return getStmt<MakeSqlStr::InsertBy<Ptrs...>>()
+            .template bind<true>(fmPair.dataView...)
+            .template getLastInsertPrimaryKeyId<U>();
+    }
+
+    /**
+     * @brief 在同一个事务中执行 lambda, 正常返回则 COMMIT, 抛出异常则 ROLLBACK (并继续抛出)
+     * @note 可嵌套调用, 内层会合并到最外层的事务中
+     * @tparam Lambda
+     * @param lambda
+     * @return lambda 的返回值
+     */
+    template <typename Lambda, typename Res = std::invoke_result_t<Lambda>>
+    Res transaction(Lambda&& lambda) {
+        internal::Transaction tx{_db};
+        if constexpr (std::is_void_v<Res>) {
+            lambda();
+            tx.commit();
+        } else {
+            Res res = lambda();
+            tx.commit();
+            return res;
+        }
+    }
+
+    /**
+     * @brief 批量插入, 全部插入在同一个事务中完成 (只需一次提交)
+     * @tparam IsSetPrimaryKey 是否指定主键
+     * @param range 待插入的数据
+     * @return std::vector<主键类型> 按顺序对应的插入后的主键
+     */
+    template <bool IsSetPrimaryKey = false, std::ranges::input_range Range,
+        typename U = meta::remove_cvref_t<std::ranges::range_value_t<Range>>>
+    std::vector<PrimaryKeyType<U>> insertMany(Range&& range) {
+        std::vector<PrimaryKeyType<U>> res;
+        if constexpr (std::ranges::sized_range<Range>) {
+            res.reserve(static_cast<std::size_t>(std::ranges::size(range)));
+        }
+        transaction([&] {
+            for (auto&& t : range) {
+                res.push_back(insert<U const&, IsSetPrimaryKey>(t));
             }
-        ).template bind<true>(fmPair.dataView...)
-         .template getLastInsertPrimaryKeyId<U>();
+        });
+        return res;
+    }
+
+    /**
+     * @brief 批量更新, 全部更新在同一个事务中完成 (只需一次提交)
+     * @tparam SqlBody 追加到 UPDATE 语句后的 SQL (如 where 子句)
+     * @param range 待更新的数据
+     * @param bindAndExec 形如 `(internal::StmtCallChain&, auto& t)` 的函数,
+     *                    用于绑定 SqlBody 中剩余的占位符并执行
+     */
+    template <meta::FixedString... SqlBody, std::ranges::input_range Range, typename Func>
+    void updateMany(Range&& range, Func&& bindAndExec) {
+        transaction([&] {
+            for (auto&& t : range) {
+                bindAndExec(update<SqlBody...>(t), t);
+            }
+        });
+    }
+
+    /**
+     * @brief 流式查询, 逐行解码, 不会一次性把结果集读入内存
+     * @tparam T 表对应的类型
+     * @tparam SqlBody 追加到 `SELECT * FROM T ` 后的 SQL (如 where / order by / limit)
+     * @param args 按顺序绑定到 SqlBody 中的占位符
+     * @return QueryCursor<T> 仅可遍历一次的输入范围
+     */
+    template <typename T, meta::FixedString... SqlBody, typename... Args>
+    QueryCursor<T> query(Args&&... args) const {
+        internal::StmtCallChain stmt{MakeSqlStr::makeSelectSql<T, SqlBody...>(), _db};
+        if constexpr (sizeof...(Args) > 0) {
+            (void)stmt.template bind<true>(std::forward<Args>(args)...);
+        }
+        return QueryCursor<T>{std::move(stmt)};
     }
 
     template <typename T>
     std::vector<T> queryAll() const {
-        std::string sql = "SELECT * FROM ";
-        sql += reflection::getTypeName<T>();
-        SQLiteStmt stmt{sql, _db};
         std::vector<T> res;
-        constexpr std::size_t N = reflection::membersCountVal<T>;
-        for (int rc = stmt.step(); rc == SQLITE_ROW; rc = stmt.step()) {
-            reflection::forEach(res.emplace_back(), [&] <std::size_t Idx> (
-                std::index_sequence<Idx>, std::string_view, auto& val
-            ) {
-                using ValType = meta::remove_cvref_t<decltype(val)>;
-                val = stmt.getColumnByIndex<ValType>(Idx);
-            });
+        for (auto&& t : query<T>()) {
+            res.push_back(std::move(t));
         }
         return res;
     }
 
-    template <typename T>
-    internal::StmtCallChain deleteBy(std::string sqlBody) {
-        std::string sql = "DELETE FROM ";
-        sql += reflection::getTypeName<T>();
-        sql += ' ';
-        sql += std::move(sqlBody);
-        return {sql, _db};
+    /**
+     * @brief 删除, 需要再绑定 SqlBody 中的占位符并执行
+     * @tparam T 表对应的类型
+     * @tparam SqlBody 追加到 `DELETE FROM T ` 后的 SQL (如 where 子句)
+     * @return internal::StmtCallChain&
+     */
+    template <typename T, meta::FixedString... SqlBody>
+    internal::StmtCallChain& deleteBy() {
+        return getStmt<MakeSqlStr::Delete<T, SqlBody...>>();
     }
 
     // 默认不修改主键, 如果需要请使用 updateBy 显示指定
@@ -492,43 +1051,33 @@ public:
         using U = meta::remove_cvref_t<T>;
         auto tp = reflection::internal::getObjTie<U>(t);
         return [&] <std::size_t... Idx> (std::index_sequence<Idx...>) -> internal::StmtCallChain& {
-            using Ptr = internal::StmtCallChain& (SQLiteDB::*) (T&&);
-            constexpr Ptr ptr = &SQLiteDB::update<SqlBody...>;
-            return getSqlCache(
-                meta::TypeId::make<ptr>(),
-                [this] {
-                    auto sql = MakeSqlStr::makeUpdateSqlFragment<U, false>();
-                    ((sql += meta::ToCharPack<SqlBody>::view()), ...);
-                    return internal::StmtCallChain{sql, _db};
-                }
-            ).template bind<false>(std::get<Idx>(tp)...);
+            return getStmt<MakeSqlStr::Update<U, SqlBody...>>()
+                .template bind<false>(std::get<Idx>(tp)...);
         } (std::make_index_sequence<std::tuple_size_v<decltype(tp)>>{});
     }
 
     template <
         meta::FixedString... SqlBody,
-        typename... MemberPtr,
-        typename U = meta::GetMemberPtrsClassType<MemberPtr...>
+        auto... Ptrs,
+        typename U = meta::GetMemberPtrsClassType<decltype(Ptrs)...>
     >
-    internal::StmtCallChain& updateBy(FieldPair<MemberPtr>... fmPair) {
-        using Ptr = internal::StmtCallChain& (SQLiteDB::*) (FieldPair<MemberPtr>...);
-        constexpr Ptr ptr = &SQLiteDB::updateBy<SqlBody...>;
-        return getSqlCache(
-            meta::TypeId::make<ptr>(),
-            [&] {
-                auto sql = MakeSqlStr::makeUpdateSqlFragment<U, MemberPtr...>(fmPair.ptr...);
-                ((sql += meta::ToCharPack<SqlBody>::view()), ...);
-                return internal::StmtCallChain{sql, _db};
-            }
-        ).template bind<true>(fmPair.dataView...);
+    internal::StmtCallChain& updateBy(FieldPair<Ptrs>... fmPair) {
+        return getStmt<MakeSqlStr::UpdateBy<internal::SqlBodyList<SqlBody...>, Ptrs...>>()
+            .template bind<true>(fmPair.dataView...);
     }
 private:
     ::sqlite3* _db{};
-    std::map<meta::TypeId::IdType, internal::StmtCallChain> _sqlCache{};
+    // 按 internal::StmtSlot 分配的下标存放预编译语句; unique_ptr 保证扩容时引用不失效
+    std::vector<std::unique_ptr<internal::StmtCallChain>> _stmtSlots{};
+    uint64_t _stmtPrepareCnt{0};
+    uint64_t _stmtHitCnt{0};
+    std::unique_ptr<internal::WalCheckpointer> _checkpointer{};
+    // 语句统计; trace 回调持有其地址, 因此放在堆上, 移动 SQLiteDB 时不会失效
+    std::unique_ptr<internal::StmtProfiler> _profiler{};
 };
 
-[[nodiscard]] inline SQLiteDB open(std::string_view filePath) {
-    return SQLiteDB{filePath};
+[[nodiscard]] inline SQLiteDB open(std::string_view filePath, SQLiteOpenOptions const& opts = {}) {
+    return SQLiteDB{filePath, opts};
 }
 
 } // namespace HX::db
\ No newline at end of file
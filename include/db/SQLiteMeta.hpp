@@ -20,6 +20,7 @@
 
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 #include <HXLibs/reflection/MemberName.hpp>
 
@@ -47,6 +48,16 @@ struct SQLiteSqlType {
 template <typename T>
 constexpr bool isSQLiteSqlTypeVal = !requires { SQLiteSqlType<T>::_hx_Val; };
 
+/**
+ * @brief 自定义序列化类型是否以 BLOB 存储
+ * @note 在 SQLiteSqlType<T> 特化中声明 `static constexpr bool IsBlob = true;` 即可;
+ *       此时 bind 的结果以 sqlite3_bind_blob 绑定, columnType 收到 sqlite3_column_blob 的字节.
+ *       若同时提供 `columnTypeFromText(std::string_view)`, 则读到旧的 TEXT 数据时会用它解析.
+ * @tparam T
+ */
+template <typename T>
+constexpr bool isSQLiteBlobVal = requires { requires SQLiteSqlType<T>::IsBlob; };
+
 /**
  * @brief 设置为主键
  * @tparam T 
@@ -157,4 +168,127 @@ inline constexpr auto& getFirstPrimaryKeyRef(T& t) noexcept {
     return std::get<GetFirstPrimaryKeyIndex<T>>(tr).val;
 }
 
+/**
+ * @brief 声明 (二级) 索引, 在 DO 中以 `using Indexes = db::IndexList<...>;` 声明.
+ *        createDatabase 会为其建立 `CREATE [UNIQUE] INDEX`, 内存 DAO 会维护对应的内存哈希索引.
+ * @tparam Ptr 成员指针
+ * @tparam IsUniqueVal 是否唯一
+ */
+template <auto Ptr, bool IsUniqueVal = false>
+    requires (std::is_member_object_pointer_v<decltype(Ptr)>)
+struct Index {
+    inline static constexpr auto ptr = Ptr;
+    inline static constexpr bool IsUnique = IsUniqueVal;
+    inline static constexpr bool IsText = false;
+    inline static constexpr bool IsSuggest = false;
+    inline static constexpr bool IsGroup = false;
+    inline static constexpr bool IsSort = false;
+};
+
+template <auto Ptr>
+using UniqueIndex = Index<Ptr, true>;
+
+/**
+ * @brief 声明全文索引, 与 Index 一同写在 `Indexes` 中.
+ *        不会建立 SQL 索引, 仅由内存 DAO 维护倒排索引 (见 utils::TextIndex), 以 DAO 的 search 检索.
+ * @note 字段按声明顺序权重递减, 词命中靠前的字段时排名更高
+ * @tparam Ptrs 参与检索的成员指针 (字符串、驻留字符串或它们的列表), 至多 8 个
+ */
+template <auto... Ptrs>
+    requires (sizeof...(Ptrs) > 0 && sizeof...(Ptrs) <= 8
+              && (std::is_member_object_pointer_v<decltype(Ptrs)> && ...))
+struct TextIndex {
+    inline static constexpr bool IsUnique = false;
+    inline static constexpr bool IsText = true;
+    inline static constexpr bool IsSuggest = false;
+    inline static constexpr bool IsGroup = false;
+    inline static constexpr bool IsSort = false;
+    inline static constexpr std::size_t FieldCnt = sizeof...(Ptrs);
+};
+
+/**
+ * @brief 声明前缀提示索引, 与 Index 一同写在 `Indexes` 中.
+ *        不会建立 SQL 索引, 仅由内存 DAO 维护前缀树 (见 utils::SuggestTrie), 以 DAO 的 suggest 查询.
+ * @note 各字段的每个取值 (列表则为每一项) 是一条提示, 权重为其出现的行数
+ * @tparam Ptrs 参与提示的成员指针 (字符串、驻留字符串或它们的列表), 至多 255 个
+ */
+template <auto... Ptrs>
+    requires (sizeof...(Ptrs) > 0 && sizeof...(Ptrs) < 256
+              && (std::is_member_object_pointer_v<decltype(Ptrs)> && ...))
+struct SuggestIndex {
+    inline static constexpr bool IsUnique = false;
+    inline static constexpr bool IsText = false;
+    inline static constexpr bool IsSuggest = true;
+    inline static constexpr bool IsGroup = false;
+    inline static constexpr bool IsSort = false;
+    inline static constexpr std::size_t FieldCnt = sizeof...(Ptrs);
+};
+
+/**
+ * @brief 声明分组聚合索引, 与 Index 一同写在 `Indexes` 中.
+ *        不会建立 SQL 索引, 仅由内存 DAO 维护 键 -> 有序主键 及行数、求和 (见 utils::GroupIndex),
+ *        以 DAO 的 selectGroups / selectGroupIds 分页查询.
+ * @note 分组字段为列表时, 每一项各是一个分组; 空串不分组
+ * @tparam KeyPtr 分组的成员指针 (字符串、驻留字符串或它们的列表)
+ * @tparam SumPtr 求和的成员指针 (整数)
+ */
+template <auto KeyPtr, auto SumPtr>
+    requires (std::is_member_object_pointer_v<decltype(KeyPtr)>
+              && std::is_member_object_pointer_v<decltype(SumPtr)>)
+struct GroupIndex {
+    inline static constexpr auto ptr = KeyPtr;
+    inline static constexpr auto sumPtr = SumPtr;
+    inline static constexpr bool IsUnique = false;
+    inline static constexpr bool IsText = false;
+    inline static constexpr bool IsSuggest = false;
+    inline static constexpr bool IsGroup = true;
+    inline static constexpr bool IsSort = false;
+};
+
+/**
+ * @brief 声明排序索引, 与 Index 一同写在 `Indexes` 中.
+ *        不会建立 SQL 索引, 仅由内存 DAO 维护顺序统计索引 (见 utils::OrderStatIndex),
+ *        以 DAO 的 selectSorted 按该字段的顺序分页, 可直接跳到任意一页.
+ * @note 数值 (包括主键) 按值排序; 文本按规范化后的形式排序 (不区分大小写与全/半角, 片假名同平假名),
+ *       列表按第一项; 相同时按主键
+ * @tparam Ptr 成员指针
+ */
+template <auto Ptr>
+    requires (std::is_member_object_pointer_v<decltype(Ptr)>)
+struct SortIndex {
+    inline static constexpr auto ptr = Ptr;
+    inline static constexpr bool IsUnique = false;
+    inline static constexpr bool IsText = false;
+    inline static constexpr bool IsSuggest = false;
+    inline static constexpr bool IsGroup = false;
+    inline static constexpr bool IsSort = true;
+};
+
+template <typename... Idx>
+struct IndexList {
+    inline static constexpr std::size_t Size = sizeof...(Idx);
+};
+
+namespace internal {
+
+template <typename T>
+struct GetIndexListImpl {
+    using Type = IndexList<>;
+};
+
+template <typename T>
+    requires requires { typename T::Indexes; }
+struct GetIndexListImpl<T> {
+    using Type = typename T::Indexes;
+};
+
+} // namespace internal
+
+/**
+ * @brief 获取 T 声明的索引列表, 未声明则为空的 IndexList
+ * @tparam T 
+ */
+template <typename T>
+using GetIndexList = internal::GetIndexListImpl<T>::Type;
+
 } // namespace HX::db
\ No newline at end of file
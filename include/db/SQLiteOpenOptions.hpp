@@ -0,0 +1,203 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <HXLibs/meta/TypeTraits.hpp>
+
+namespace HX::db {
+
+/**
+ * @brief 日志模式 (PRAGMA journal_mode)
+ */
+enum class JournalMode : uint8_t {
+    Delete,     // 默认的回滚日志
+    Truncate,
+    Persist,
+    Memory,
+    Wal,        // 预写日志, 读写互不阻塞
+    Off,
+};
+
+/**
+ * @brief 同步级别 (PRAGMA synchronous)
+ */
+enum class SynchronousMode : uint8_t {
+    Off,
+    Normal,     // WAL 下只在检查点时 fsync, 断电可能丢失最后几个事务, 但不会损坏
+    Full,       // 默认: 每次提交都 fsync
+    Extra,
+};
+
+/**
+ * @brief 临时表/索引存储位置 (PRAGMA temp_store)
+ */
+enum class TempStore : uint8_t {
+    Default,
+    File,
+    Memory,
+};
+
+/**
+ * @brief 打开 SQLite 数据库的配置
+ * @note 为空的项不会设置, 即保持 sqlite 自身的默认行为 (或数据库文件中持久化的设置)
+ */
+struct SQLiteOpenOptions {
+    std::optional<JournalMode> journalMode{};
+    std::optional<SynchronousMode> synchronous{};
+    std::optional<int64_t> mmapSize{};                  // 内存映射大小 (字节), 0 为不使用
+    std::optional<int64_t> cacheSize{};                 // 页缓存: 正数为页数, 负数为 KiB
+    int busyTimeoutMs = 0;                              // 忙等待超时 (毫秒)
+    std::optional<TempStore> tempStore{};
+    std::chrono::milliseconds checkpointInterval{0};    // 后台 WAL 检查点间隔, 0 为不启动
+    bool isProfile = false;                             // 是否统计每条语句的耗时等开销 (见 SQLiteDB::getStmtProfile)
+    bool isReadOnly = false;                            // 以只读方式打开, 文件不存在时不会创建
+
+    /**
+     * @brief 生产环境配置: WAL + NORMAL, 并由后台线程做检查点; 开启语句统计
+     * @return SQLiteOpenOptions
+     */
+    static SQLiteOpenOptions production() noexcept {
+        return {
+            JournalMode::Wal,
+            SynchronousMode::Normal,
+            256LL << 20,    // 256 MiB
+            -64000,         // 约 64 MiB
+            5000,
+            TempStore::Memory,
+            std::chrono::seconds{30},
+            true,
+            false,
+        };
+    }
+
+    /**
+     * @brief 写组 (跨库事务) 的生产环境配置: 回滚日志 (TRUNCATE) + FULL, 使跨库的提交是原子的;
+     *        WAL 下每个文件只各自原子, 因此不使用 WAL 与后台检查点. 开启语句统计
+     * @return SQLiteOpenOptions
+     */
+    static SQLiteOpenOptions productionGroup() noexcept {
+        return {
+            JournalMode::Truncate,
+            SynchronousMode::Full,
+            256LL << 20,    // 256 MiB
+            -64000,         // 约 64 MiB
+            5000,
+            TempStore::Memory,
+            std::chrono::milliseconds{0},
+            true,
+            false,
+        };
+    }
+};
+
+namespace internal {
+
+constexpr std::string_view toPragmaStr(JournalMode mode) noexcept {
+    switch (mode) {
+        case JournalMode::Delete:   return "DELETE";
+        case JournalMode::Truncate: return "TRUNCATE";
+        case JournalMode::Persist:  return "PERSIST";
+        case JournalMode::Memory:   return "MEMORY";
+        case JournalMode::Wal:      return "WAL";
+        case JournalMode::Off:      return "OFF";
+    }
+    return "DELETE";
+}
+
+constexpr std::string_view toPragmaStr(SynchronousMode mode) noexcept {
+    switch (mode) {
+        case SynchronousMode::Off:    return "OFF";
+        case SynchronousMode::Normal: return "NORMAL";
+        case SynchronousMode::Full:   return "FULL";
+        case SynchronousMode::Extra:  return "EXTRA";
+    }
+    return "FULL";
+}
+
+constexpr std::string_view toPragmaStr(TempStore store) noexcept {
+    switch (store) {
+        case TempStore::Default: return "DEFAULT";
+        case TempStore::File:    return "FILE";
+        case TempStore::Memory:  return "MEMORY";
+    }
+    return "DEFAULT";
+}
+
+/**
+ * @brief 生成应用 opts 的 PRAGMA 语句
+ * @param opts
+ * @param isCheckpointByThread 是否由后台线程做检查点 (此时关闭提交时的自动检查点)
+ * @param schema 非空时只生成对该库生效的 PRAGMA (如 ATTACH 的库), 忽略连接级的设置
+ * @return std::string
+ */
+inline std::string makePragmaSql(
+    SQLiteOpenOptions const& opts,
+    bool isCheckpointByThread,
+    std::string_view schema = {}
+) {
+    std::string sql;
+    auto add = [&](std::string_view name, auto const& val) {
+        sql += "PRAGMA ";
+        if (!schema.empty()) {
+            sql += schema;
+            sql += '.';
+        }
+        sql += name;
+        sql += '=';
+        if constexpr (std::is_integral_v<meta::remove_cvref_t<decltype(val)>>) {
+            sql += std::to_string(val);
+        } else {
+            sql += toPragmaStr(val);
+        }
+        sql += ';';
+    };
+    if (opts.journalMode) {
+        add("journal_mode", *opts.journalMode);
+    }
+    if (opts.synchronous) {
+        add("synchronous", *opts.synchronous);
+    }
+    if (opts.mmapSize) {
+        add("mmap_size", *opts.mmapSize);
+    }
+    if (opts.cacheSize) {
+        add("cache_size", *opts.cacheSize);
+    }
+    if (!schema.empty()) {
+        return sql;
+    }
+    if (opts.tempStore) {
+        add("temp_store", *opts.tempStore);
+    }
+    if (isCheckpointByThread) {
+        add("wal_autocheckpoint", 0);
+    }
+    return sql;
+}
+
+} // namespace internal
+
+} // namespace HX::db
@@ -0,0 +1,142 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <db/SQLiteDB.hpp>
+
+namespace HX::db {
+
+/**
+ * @brief 按 rowid 区间并行扫描整张表
+ * @note 把 [最小 rowid, 最大 rowid] 切成若干块, 由 threadCnt 个线程各自用独立的只读连接查询并解码;
+ *       调用线程按 rowid 升序逐块取走结果并调用 func, 因此 func 无需线程安全,
+ *       且解码与 func 的处理是重叠进行的.
+ * @tparam T 表对应的类型
+ * @param filePath 数据库文件路径
+ * @param range 见 SQLiteDB::getRowIdRange
+ * @param threadCnt 查询线程数
+ * @param func 形如 `(T&&) -> void`
+ */
+template <typename T, typename Func>
+void parallelScan(
+    std::string const& filePath,
+    std::pair<int64_t, int64_t> range,
+    std::size_t threadCnt,
+    Func&& func
+) {
+    // 每个线程分到多块, 使各线程的负载在 rowid 不均匀时也大致相当
+    constexpr std::size_t ChunksPerThread = 4;
+    auto [lo, hi] = range;
+    uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+    threadCnt = std::max<std::size_t>(threadCnt, 1);
+    uint64_t step = std::max<uint64_t>(span / (threadCnt * ChunksPerThread), 1);
+    std::size_t chunkCnt = static_cast<std::size_t>((span + step - 1) / step);
+
+    struct Chunk {
+        std::vector<T> rows{};
+        bool isDone = false;
+    };
+    std::vector<Chunk> chunks(chunkCnt);
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic_size_t next{0};
+    std::atomic_bool isStop{false};
+    std::exception_ptr err{};
+
+    auto work = [&] {
+        try {
+            SQLiteOpenOptions opts{};
+            opts.isReadOnly = true;
+            opts.busyTimeoutMs = 5000;
+            SQLiteDB db{filePath, opts};
+            for (;;) {
+                std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= chunkCnt || isStop.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                auto begin = static_cast<int64_t>(static_cast<uint64_t>(lo) + i * step);
+                auto end = i + 1 == chunkCnt
+                    ? hi
+                    : static_cast<int64_t>(static_cast<uint64_t>(begin) + step - 1);
+                std::vector<T> rows;
+                for (auto&& t : db.query<T, "where rowid between ? and ?">(begin, end)) {
+                    rows.push_back(std::move(t));
+                }
+                {
+                    std::lock_guard _{mtx};
+                    chunks[i].rows = std::move(rows);
+                    chunks[i].isDone = true;
+                }
+                cv.notify_all();
+            }
+        } catch (...) {
+            {
+                std::lock_guard _{mtx};
+                if (!err) {
+                    err = std::current_exception();
+                }
+            }
+            isStop.store(true, std::memory_order_relaxed);
+            cv.notify_all();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threadCnt);
+        for (std::size_t i = 0; i < threadCnt; ++i) {
+            workers.emplace_back(work);
+        }
+        try {
+            for (std::size_t i = 0; i < chunkCnt; ++i) {
+                std::vector<T> rows;
+                {
+                    std::unique_lock lck{mtx};
+                    cv.wait(lck, [&] { return chunks[i].isDone || err; });
+                    if (!chunks[i].isDone) {
+                        break;
+                    }
+                    rows = std::move(chunks[i].rows);
+                }
+                for (auto& t : rows) {
+                    func(std::move(t));
+                }
+            }
+        } catch (...) {
+            isStop.store(true, std::memory_order_relaxed);
+            throw;
+        }
+    } // 等待所有线程退出
+    if (err) {
+        std::rethrow_exception(err);
+    }
+}
+
+} // namespace HX::db
@@ -0,0 +1,218 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sqlite3.h>
+
+namespace HX::db {
+
+/**
+ * @brief 单条语句的执行统计
+ */
+struct StmtProfile {
+    std::string sql;
+    uint64_t callCnt;           // 执行次数
+    uint64_t totalNs;           // 总耗时 (纳秒)
+    uint64_t maxNs;             // 最大耗时 (纳秒)
+    uint64_t p99Ns;             // 99 分位耗时 (纳秒), 近似值, 相对误差不超过 1/8
+    uint64_t rowCnt;            // 返回的行数
+    uint64_t vmSteps;           // 虚拟机执行步数
+    uint64_t fullScanSteps;     // 全表扫描的步数, 非零通常意味着缺少索引
+    uint64_t sortCnt;           // 排序次数
+    uint64_t autoIndexCnt;      // 为自动建立的临时索引插入的行数
+};
+
+namespace internal {
+
+/**
+ * @brief 对数-线性分桶的耗时直方图: 每个 2 的幂区间再等分为 8 个桶
+ */
+class LatencyHistogram {
+    inline static constexpr int SubBits = 3;
+    inline static constexpr int MaxExp = 47; // 约 39 小时, 再大的值归入最后一个桶
+    inline static constexpr std::size_t BucketCnt = (MaxExp - SubBits + 2) << SubBits;
+
+    static constexpr std::size_t indexOf(uint64_t ns) noexcept {
+        if (ns < (1u << SubBits)) {
+            return static_cast<std::size_t>(ns);
+        }
+        int e = std::min(static_cast<int>(std::bit_width(ns)) - 1, MaxExp);
+        uint64_t sub = std::min<uint64_t>(ns >> (e - SubBits), (2u << SubBits) - 1) - (1u << SubBits);
+        return (static_cast<std::size_t>(e - SubBits + 1) << SubBits) + static_cast<std::size_t>(sub);
+    }
+
+    // 桶 idx 中的最大值
+    static constexpr uint64_t upperOf(std::size_t idx) noexcept {
+        if (idx < (1u << SubBits)) {
+            return idx;
+        }
+        int e = static_cast<int>(idx >> SubBits) + SubBits - 1;
+        uint64_t sub = idx & ((1u << SubBits) - 1);
+        return (((1u << SubBits) + sub + 1) << (e - SubBits)) - 1;
+    }
+public:
+    void add(uint64_t ns) noexcept {
+        ++_buckets[indexOf(ns)];
+    }
+
+    /**
+     * @brief 分位数
+     * @param q (0, 1]
+     * @param cnt 样本总数
+     */
+    uint64_t quantile(double q, uint64_t cnt) const noexcept {
+        auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(cnt)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t sum = 0;
+        for (std::size_t i = 0; i < BucketCnt; ++i) {
+            sum += _buckets[i];
+            if (sum >= rank) {
+                return upperOf(i);
+            }
+        }
+        return 0;
+    }
+private:
+    std::array<uint64_t, BucketCnt> _buckets{};
+};
+
+/**
+ * @brief 通过 sqlite3_trace_v2 (STMT | PROFILE | ROW) 与 sqlite3_stmt_status 统计每条语句的开销.
+ * @note 缓存中的预编译语句按句柄统计 (需 track), 其余 (如 exec) 按 SQL 文本统计.
+ *       回调在执行语句的线程中运行, 与连接本身一样不是线程安全的, 应在使用连接的线程中读取.
+ */
+class StmtProfiler {
+    struct Entry {
+        std::string sql;
+        uint64_t callCnt = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        uint64_t rowCnt = 0;
+        uint64_t vmSteps = 0;
+        uint64_t fullScanSteps = 0;
+        uint64_t sortCnt = 0;
+        uint64_t autoIndexCnt = 0;
+        std::chrono::steady_clock::time_point startTime{};
+        LatencyHistogram hist{};
+    };
+public:
+    explicit StmtProfiler(::sqlite3* db) {
+        ::sqlite3_trace_v2(db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW,
+            &StmtProfiler::callback, this);
+    }
+
+    StmtProfiler& operator=(StmtProfiler&&) noexcept = delete;
+
+    /**
+     * @brief 登记缓存中的预编译语句; 其生命周期需与连接一致
+     */
+    void track(::sqlite3_stmt* stmt) {
+        _tracked.try_emplace(stmt).first->second.sql = ::sqlite3_sql(stmt);
+    }
+
+    /**
+     * @brief 获取统计结果, 按总耗时降序
+     * @return std::vector<StmtProfile>
+     */
+    std::vector<StmtProfile> getProfiles() const {
+        std::vector<StmtProfile> res;
+        res.reserve(_tracked.size() + _untracked.size());
+        auto add = [&](Entry const& e) {
+            if (!e.callCnt) {
+                return;
+            }
+            res.push_back({
+                e.sql, e.callCnt, e.totalNs, e.maxNs,
+                e.hist.quantile(0.99, e.callCnt),
+                e.rowCnt, e.vmSteps, e.fullScanSteps, e.sortCnt, e.autoIndexCnt
+            });
+        };
+        for (auto const& [_, e] : _tracked) {
+            add(e);
+        }
+        for (auto const& [_, e] : _untracked) {
+            add(e);
+        }
+        std::ranges::sort(res, std::greater<>{}, &StmtProfile::totalNs);
+        return res;
+    }
+private:
+    Entry& entryOf(::sqlite3_stmt* stmt) {
+        if (auto it = _tracked.find(stmt); it != _tracked.end()) [[likely]] {
+            return it->second;
+        }
+        char const* sql = ::sqlite3_sql(stmt);
+        std::string key = sql ? sql : "";
+        auto [it, ok] = _untracked.try_emplace(key);
+        if (ok) {
+            it->second.sql = std::move(key);
+        }
+        return it->second;
+    }
+
+    static int callback(unsigned mask, void* ctx, void* p, void* x) {
+        auto* self = static_cast<StmtProfiler*>(ctx);
+        auto* stmt = static_cast<::sqlite3_stmt*>(p);
+        auto& e = self->entryOf(stmt);
+        if (mask == SQLITE_TRACE_STMT) {
+            e.startTime = std::chrono::steady_clock::now();
+            return 0;
+        }
+        if (mask == SQLITE_TRACE_ROW) {
+            ++e.rowCnt;
+            return 0;
+        }
+        // PROFILE 给出的耗时基于 VFS 时钟, 通常只有毫秒精度, 因此自己从 TRACE_STMT 开始计时
+        auto ns = e.startTime == std::chrono::steady_clock::time_point{}
+            ? static_cast<uint64_t>(*static_cast<::sqlite3_int64*>(x))
+            : static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - e.startTime).count());
+        e.startTime = {};
+        ++e.callCnt;
+        e.totalNs += ns;
+        e.maxNs = std::max(e.maxNs, ns);
+        e.hist.add(ns);
+        // 读取并清零, 使每次只累计本次执行的增量
+        auto status = [&](int op) {
+            return static_cast<uint64_t>(::sqlite3_stmt_status(stmt, op, 1));
+        };
+        e.vmSteps += status(SQLITE_STMTSTATUS_VM_STEP);
+        e.fullScanSteps += status(SQLITE_STMTSTATUS_FULLSCAN_STEP);
+        e.sortCnt += status(SQLITE_STMTSTATUS_SORT);
+        e.autoIndexCnt += status(SQLITE_STMTSTATUS_AUTOINDEX);
+        return 0;
+    }
+
+    std::unordered_map<::sqlite3_stmt*, Entry> _tracked{};
+    std::unordered_map<std::string, Entry> _untracked{};
+};
+
+} // namespace internal
+
+} // namespace HX::db
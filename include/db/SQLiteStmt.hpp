@@ -93,6 +93,13 @@ public:
         }
     }
 
+    /**
+     * @brief 获取底层的语句句柄
+     */
+    ::sqlite3_stmt* native() const noexcept {
+        return _stmt;
+    }
+
     /**
      * @brief 获取错误字符串
      * @return std::string 
@@ -108,6 +115,21 @@ public:
             return U{static_cast<T>(::sqlite3_column_int64(_stmt, static_cast<int>(index)))};
         } else if constexpr (std::is_floating_point_v<T>) {
             return static_cast<T>(::sqlite3_column_double(_stmt, static_cast<int>(index)));
+        } else if constexpr (isSQLiteBlobVal<T>) {
+            auto idx = static_cast<int>(index);
+            if constexpr (requires (std::string_view str) {
+                SQLiteSqlType<T>::columnTypeFromText(str);
+            }) {
+                // 旧数据以文本存储 (尚未迁移)
+                if (::sqlite3_column_type(_stmt, idx) == SQLITE_TEXT) [[unlikely]] {
+                    auto* str = reinterpret_cast<const char *>(::sqlite3_column_text(_stmt, idx));
+                    auto len = ::sqlite3_column_bytes(_stmt, idx);
+                    return SQLiteSqlType<T>::columnTypeFromText({str, static_cast<std::size_t>(len)});
+                }
+            }
+            auto* data = static_cast<const char *>(::sqlite3_column_blob(_stmt, idx));
+            auto len = ::sqlite3_column_bytes(_stmt, idx);
+            return SQLiteSqlType<T>::columnType({data, static_cast<std::size_t>(len)});
         } else if constexpr (meta::StringType<T> || isSQLiteSqlTypeVal<T>) {
             auto* str = reinterpret_cast<const char *>(
                 ::sqlite3_column_text(_stmt, static_cast<int>(index))
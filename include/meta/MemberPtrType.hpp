@@ -78,4 +78,18 @@ using GetMemberPtrsClassType = decltype([] <typename MP, typename... MemberPtrs>
     GetMemberPtrClassType<MemberPtr>, void> {};
 } (MemberPtrTs{}...));
 
+/**
+ * @brief 判断两个成员指针是否指向同一成员 (类型不同时为 false, 而不是编译错误)
+ * @tparam A
+ * @tparam B
+ */
+template <auto A, auto B>
+consteval bool isSameMemberPtr() noexcept {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
 } // namespace HX::meta
\ No newline at end of file
@@ -23,18 +23,36 @@
 #include <vector>
 
 #include <db/SQLiteMeta.hpp>
+#include <db/InternedColumn.hpp>
+#include <utils/StringPool.hpp>
 
 namespace HX {
 
 // 歌曲数据
 struct MusicDO {
     db::PrimaryKey<uint64_t> id;        // 歌曲唯一ID
-    std::string path;                   // 歌曲存放路径 (相对于 ~/file/music/)
+    utils::CompactPath path;            // 歌曲存放路径 (相对于 ~/file/music/), 目录部分驻留
     std::string musicName;              // 歌名
-    std::vector<std::string> singers;   // 歌手
-    std::string musicAlbum;             // 专辑
+    utils::SymbolList singers;          // 歌手 (驻留)
+    utils::Symbol musicAlbum;           // 专辑 (驻留)
     uint64_t millisecondsLen;           // 毫秒长度
     std::string coverSuffix;            // 封面图片后缀 (.png / .jpg)
+
+    using Indexes = db::IndexList<
+        db::UniqueIndex<&MusicDO::path>,
+        // 搜索: 歌名 > 歌手 > 专辑 > 路径
+        db::TextIndex<&MusicDO::musicName, &MusicDO::singers, &MusicDO::musicAlbum, &MusicDO::path>,
+        // 输入提示: 歌名、歌手、专辑
+        db::SuggestIndex<&MusicDO::musicName, &MusicDO::singers, &MusicDO::musicAlbum>,
+        // 歌手 / 专辑列表: 各自的歌曲与总时长
+        db::GroupIndex<&MusicDO::singers, &MusicDO::millisecondsLen>,
+        db::GroupIndex<&MusicDO::musicAlbum, &MusicDO::millisecondsLen>,
+        // 排序分页: id (加入顺序)、歌名、歌手、时长
+        db::SortIndex<&MusicDO::id>,
+        db::SortIndex<&MusicDO::musicName>,
+        db::SortIndex<&MusicDO::singers>,
+        db::SortIndex<&MusicDO::millisecondsLen>
+    >;
 };
 
 } // namespace HX
\ No newline at end of file
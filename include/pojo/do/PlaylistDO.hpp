@@ -27,7 +27,7 @@ struct PlaylistDO {
     db::PrimaryKey<uint64_t> id;            // 歌单id (唯一), 定义本地歌单为默认, 为 `0`
     std::string name;                       // 歌单名称
     std::string description;                // 歌单描述
-    std::vector<uint64_t> songIdList;       // 歌曲Id列表
+    std::vector<uint64_t> songIdList;       // 歌曲Id列表 (服务端已迁移至 PlaylistSongDO, 数据库中此列恒为空)
 };
 
 } // namespace HX
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+#include <db/SQLiteMeta.hpp>
+
+namespace HX {
+
+// 歌单-歌曲 关系 (一行对应歌单中的一首歌)
+struct PlaylistSongDO {
+    db::PrimaryKey<uint64_t> id;            // 行id
+    uint64_t playlistId;                    // 所属歌单id
+    double positionKey;                     // 排序键 (歌单内按其升序排列); 插入到两首歌之间时取二者中点, 无需移动其他行
+    uint64_t musicId;                       // 歌曲id
+
+    using Indexes = db::IndexList<
+        db::Index<&PlaylistSongDO::playlistId>
+    >;
+};
+
+} // namespace HX
@@ -46,6 +46,10 @@ struct UserDO {
     std::vector<uint64_t> savedPlaylist;    // 收藏的歌单
     PermissionEnum permissionLevel;         // 权限分级
     std::string loggedInUuid;               // 登录 Uuid
+
+    using Indexes = db::IndexList<
+        db::UniqueIndex<&UserDO::name>
+    >;
 };
 
 } // namespace HX
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <pojo/vo/MusicVO.hpp>
+#include <pojo/vo/PlaylistInfoVO.hpp>
+
+namespace HX {
+
+/**
+ * @brief 歌曲增量同步 VO
+ */
+struct MusicChangeListVO {
+    uint64_t version;                   // 当前版本, 下次请求时作为 since
+    bool isResync;                      // 为 true 时其余列表为空, 需要重新全量获取
+    std::vector<MusicVO> songList;      // 新增或修改过的歌曲
+    std::vector<uint64_t> delIdList;    // 删除的歌曲 id
+};
+
+/**
+ * @brief 歌单增量同步 VO
+ * @note 歌曲列表有变化的歌单也会出现在 infoList 中, 需要再通过 /playlist/select/{id} 获取
+ */
+struct PlaylistChangeListVO {
+    uint64_t version;                       // 当前版本, 下次请求时作为 since
+    bool isResync;                          // 为 true 时其余列表为空, 需要重新全量获取
+    std::vector<PlaylistInfoVO> infoList;   // 新增或修改过的歌单
+    std::vector<uint64_t> delIdList;        // 删除的歌单 id
+};
+
+} // namespace HX
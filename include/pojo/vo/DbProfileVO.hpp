@@ -0,0 +1,44 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <db/SQLiteDB.hpp>
+
+namespace HX {
+
+/**
+ * @brief 单个数据库连接的语句统计 VO
+ */
+struct DbProfileVO {
+    std::string name;                       // 数据库 (DAO) 名称
+    db::StmtCacheStats cacheStats;          // 预编译语句缓存统计
+    std::vector<db::StmtProfile> stmtList;  // 每条语句的统计, 按总耗时降序
+};
+
+/**
+ * @brief 语句统计列表 VO
+ */
+struct DbProfileListVO {
+    std::vector<DbProfileVO> dbList;
+};
+
+} // namespace HX
@@ -0,0 +1,43 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+
+namespace HX {
+
+/**
+ * @brief 分页查找分组 (歌手 / 专辑) JsonVO
+ */
+struct GroupSelectVO {
+    std::string after;  // 从名称大于它的分组开始, 空为从头开始
+    uint64_t maxCnt;    // 返回的数据的最大数量
+};
+
+/**
+ * @brief 分页查找分组内歌曲 JsonVO
+ */
+struct GroupMusicSelectVO {
+    std::string name;   // 分组名称 (歌手名 / 专辑名)
+    uint64_t beginId;   // 查找的数据起始id
+    uint64_t maxCnt;    // 返回的数据的最大数量
+};
+
+} // namespace HX
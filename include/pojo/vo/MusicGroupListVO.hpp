@@ -0,0 +1,43 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HX {
+
+/**
+ * @brief 一个分组 (歌手 / 专辑) 的统计
+ */
+struct MusicGroupVO {
+    std::string name;           // 歌手名 / 专辑名
+    uint64_t cnt;               // 歌曲数
+    uint64_t millisecondsLen;   // 总时长 (毫秒)
+};
+
+/**
+ * @brief 分组列表 VO
+ */
+struct MusicGroupListVO {
+    std::vector<MusicGroupVO> groupList;
+};
+
+} // namespace HX
@@ -19,6 +19,8 @@
  */
 
 #include <cstdint>
+#include <optional>
+#include <string>
 
 namespace HX {
 
@@ -26,8 +28,12 @@ namespace HX {
  * @brief 查找数据描述 JsonVO
  */
 struct SelectDataVO {
-    uint64_t beginId;   // 查找的数据起始id
-    uint64_t maxCnt;    // 返回的数据的最大数量
+    uint64_t beginId;       // 查找的数据起始id (不含), 排序时为上一页最后一首的id; 0 为从头开始
+    uint64_t maxCnt;        // 返回的数据的最大数量
+    std::string sortBy{};   // 排序: 空 (即 id)、title、artist、duration、recent (最近加入的在前)
+    bool isDesc = false;    // 是否反序
+    uint64_t offset = 0;    // 在起始id之后再跳过的数量, 用于直接跳页
+    std::optional<std::string> beginKey{}; // 起始id那一首的排序字段 (歌名 / 第一位歌手 / 时长); 该首已被删除时据此定位
 };
 
 } // namespace HX
\ No newline at end of file
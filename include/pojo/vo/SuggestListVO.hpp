@@ -0,0 +1,43 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace HX {
+
+/**
+ * @brief 输入提示的一项
+ */
+struct SuggestVO {
+    std::string text;   // 提示的文本
+    std::string type;   // 来源: musicName / singers / musicAlbum
+    uint32_t cnt;       // 包含该文本的歌曲数
+};
+
+/**
+ * @brief 输入提示 VO
+ */
+struct SuggestListVO {
+    std::vector<SuggestVO> suggestList;
+};
+
+} // namespace HX
@@ -0,0 +1,171 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HX::utils {
+
+/**
+ * @brief 一个分组的统计
+ */
+struct GroupStat {
+    std::string key;    // 分组的键 (如歌手名)
+    uint64_t cnt;       // 行数
+    uint64_t sum;       // 求和字段之和 (如总时长)
+};
+
+/**
+ * @brief 分组聚合索引: 键 -> 有序的主键列表, 以及行数与求和字段之和; 分组按键排序
+ * @note 分组与组内主键都可按游标分页, 代价为 O(log n + 页大小).
+ *       批量加载时 (beginBulk ~ endBulk) 主键只追加, 结束时再统一排序.
+ * @warning 本身不加锁
+ * @tparam Id 主键类型
+ */
+template <typename Id>
+class GroupIndex {
+    struct Group {
+        std::vector<Id> ids;    // 升序
+        uint64_t sum = 0;
+    };
+public:
+    void beginBulk() noexcept {
+        _isBulk = true;
+    }
+
+    void endBulk() {
+        if (!_isBulk) {
+            return;
+        }
+        _isBulk = false;
+        for (auto& [key, group] : _groups) {
+            std::sort(group.ids.begin(), group.ids.end());
+        }
+    }
+
+    /**
+     * @brief 把主键 id (求和字段的值为 val) 计入分组 key; 已在组内则忽略. 空的键不分组
+     */
+    void add(std::string_view key, Id id, uint64_t val) {
+        if (key.empty()) {
+            return;
+        }
+        auto it = _groups.find(key);
+        if (it == _groups.end()) {
+            it = _groups.emplace(std::string{key}, Group{}).first;
+        }
+        auto& ids = it->second.ids;
+        if (_isBulk) {
+            // 同一行的重复值是连续送入的
+            if (!ids.empty() && ids.back() == id) {
+                return;
+            }
+            ids.push_back(id);
+        } else {
+            auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+            if (pos != ids.end() && *pos == id) {
+                return;
+            }
+            ids.insert(pos, id);
+        }
+        it->second.sum += val;
+    }
+
+    /**
+     * @brief 把主键 id 移出分组 key, 分组为空时删除
+     */
+    void erase(std::string_view key, Id id, uint64_t val) {
+        auto it = _groups.find(key);
+        if (it == _groups.end()) {
+            return;
+        }
+        auto& ids = it->second.ids;
+        auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+        if (pos == ids.end() || *pos != id) {
+            return;
+        }
+        ids.erase(pos);
+        it->second.sum -= val;
+        if (ids.empty()) {
+            _groups.erase(it);
+        }
+    }
+
+    /**
+     * @brief 按键升序分页列出分组
+     * @param after 从大于该键的分组开始, 空为从头开始
+     * @param maxCnt 最多返回的分组数
+     */
+    std::vector<GroupStat> groups(std::string_view after, std::size_t maxCnt) const {
+        std::vector<GroupStat> res;
+        auto it = after.empty() ? _groups.begin() : _groups.upper_bound(after);
+        for (; maxCnt && it != _groups.end(); ++it, --maxCnt) {
+            res.push_back({it->first, it->second.ids.size(), it->second.sum});
+        }
+        return res;
+    }
+
+    /**
+     * @brief 分组 key 的统计, 不存在时为空
+     */
+    std::optional<GroupStat> stat(std::string_view key) const {
+        auto it = _groups.find(key);
+        if (it == _groups.end()) {
+            return {};
+        }
+        return GroupStat{it->first, it->second.ids.size(), it->second.sum};
+    }
+
+    /**
+     * @brief 按主键升序分页列出分组 key 中的主键
+     * @param beginId 从大于该主键的开始
+     * @param maxCnt 最多返回的个数
+     */
+    std::vector<Id> ids(std::string_view key, Id beginId, std::size_t maxCnt) const {
+        std::vector<Id> res;
+        auto it = _groups.find(key);
+        if (it == _groups.end()) {
+            return res;
+        }
+        auto const& ids = it->second.ids;
+        auto pos = std::upper_bound(ids.begin(), ids.end(), beginId);
+        auto cnt = std::min(maxCnt, static_cast<std::size_t>(ids.end() - pos));
+        res.assign(pos, pos + static_cast<std::ptrdiff_t>(cnt));
+        return res;
+    }
+
+    /**
+     * @brief 分组数
+     */
+    std::size_t size() const noexcept {
+        return _groups.size();
+    }
+private:
+    std::map<std::string, Group, std::less<>> _groups{};
+    bool _isBulk = false;
+};
+
+} // namespace HX::utils
@@ -0,0 +1,233 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace HX::utils {
+
+/**
+ * @brief 顺序统计索引: 按 (键, 主键) 有序, 可在 O(log n) 内求排名、按排名定位
+ * @note 以两层结构实现: 有序的块 (每块至多 BlockCap 项) 与块大小的树状数组.
+ *       增删为 O(log n + BlockCap), 块分裂 / 清空时重建树状数组 (均摊很小);
+ *       取一页为 O(log n + 页大小).
+ *       批量加载时 (beginBulk ~ endBulk) 只追加, 结束时再统一排序切块.
+ * @warning 本身不加锁
+ * @tparam Key 排序的键
+ * @tparam Id 主键类型, 键相同时按主键排序
+ */
+template <typename Key, typename Id, std::size_t BlockCap = 256>
+class OrderStatIndex {
+    static_assert(BlockCap >= 2);
+    using Entry = std::pair<Key, Id>;
+public:
+    void beginBulk() noexcept {
+        _isBulk = true;
+    }
+
+    void endBulk() {
+        if (!_isBulk) {
+            return;
+        }
+        _isBulk = false;
+        std::sort(_bulk.begin(), _bulk.end());
+        // 块只填一半, 给之后的插入留出余量
+        constexpr std::size_t Fill = BlockCap / 2;
+        for (std::size_t i = 0; i < _bulk.size(); i += Fill) {
+            auto end = std::min(_bulk.size(), i + Fill);
+            _blocks.emplace_back(
+                std::make_move_iterator(_bulk.begin() + static_cast<std::ptrdiff_t>(i)),
+                std::make_move_iterator(_bulk.begin() + static_cast<std::ptrdiff_t>(end)));
+        }
+        _size += _bulk.size();
+        std::vector<Entry>{}.swap(_bulk);
+        rebuildTree();
+    }
+
+    void insert(Key key, Id id) {
+        Entry e{std::move(key), id};
+        if (_isBulk) {
+            _bulk.push_back(std::move(e));
+            return;
+        }
+        if (_blocks.empty()) {
+            _blocks.emplace_back().push_back(std::move(e));
+            ++_size;
+            rebuildTree();
+            return;
+        }
+        // 放入第一个末项不小于 e 的块, 都小于则放入最后一块
+        auto b = std::min(blockOf(e), _blocks.size() - 1);
+        auto& block = _blocks[b];
+        block.insert(std::lower_bound(block.begin(), block.end(), e), std::move(e));
+        ++_size;
+        if (block.size() > BlockCap) {
+            std::vector<Entry> half(
+                std::make_move_iterator(block.begin() + BlockCap / 2),
+                std::make_move_iterator(block.end()));
+            block.resize(BlockCap / 2);
+            _blocks.insert(_blocks.begin() + static_cast<std::ptrdiff_t>(b + 1), std::move(half));
+            rebuildTree();
+        } else {
+            add(b, 1);
+        }
+    }
+
+    void erase(Key const& key, Id id) {
+        Entry e{key, id};
+        if (_isBulk) {
+            // 加载中一般不会删除
+            if (auto it = std::find(_bulk.begin(), _bulk.end(), e); it != _bulk.end()) {
+                _bulk.erase(it);
+            }
+            return;
+        }
+        auto b = blockOf(e);
+        if (b == _blocks.size()) {
+            return;
+        }
+        auto& block = _blocks[b];
+        auto it = std::lower_bound(block.begin(), block.end(), e);
+        if (it == block.end() || *it != e) {
+            return;
+        }
+        block.erase(it);
+        --_size;
+        if (block.empty()) {
+            _blocks.erase(_blocks.begin() + static_cast<std::ptrdiff_t>(b));
+            rebuildTree();
+        } else {
+            add(b, -1);
+        }
+    }
+
+    /**
+     * @brief 严格小于 (key, id) 的项数
+     */
+    std::size_t rankOf(Key const& key, Id id) const {
+        Entry e{key, id};
+        auto b = blockOf(e);
+        if (b == _blocks.size()) {
+            return _size;
+        }
+        auto const& block = _blocks[b];
+        return prefix(b) + static_cast<std::size_t>(
+            std::lower_bound(block.begin(), block.end(), e) - block.begin());
+    }
+
+    /**
+     * @brief 从第 rank 项 (从 0 开始) 起, 按序取至多 cnt 个主键
+     * @param isDesc 是否按降序 (此时 rank 为降序中的排名)
+     */
+    std::vector<Id> slice(std::size_t rank, std::size_t cnt, bool isDesc) const {
+        std::vector<Id> res;
+        if (rank >= _size || !cnt) {
+            return res;
+        }
+        cnt = std::min(cnt, _size - rank);
+        res.reserve(cnt);
+        auto [b, i] = locate(isDesc ? _size - 1 - rank : rank);
+        if (isDesc) {
+            for (;;) {
+                auto const& block = _blocks[b];
+                for (std::size_t j = i + 1; j-- > 0 && cnt; --cnt) {
+                    res.push_back(block[j].second);
+                }
+                if (!cnt) {
+                    break;
+                }
+                --b;
+                i = _blocks[b].size() - 1;
+            }
+        } else {
+            for (;;) {
+                auto const& block = _blocks[b];
+                for (; i < block.size() && cnt; ++i, --cnt) {
+                    res.push_back(block[i].second);
+                }
+                if (!cnt) {
+                    break;
+                }
+                ++b;
+                i = 0;
+            }
+        }
+        return res;
+    }
+
+    std::size_t size() const noexcept {
+        return _size + _bulk.size();
+    }
+private:
+    // 第一个末项不小于 e 的块, 没有则为块数
+    std::size_t blockOf(Entry const& e) const {
+        auto it = std::partition_point(_blocks.begin(), _blocks.end(),
+            [&](std::vector<Entry> const& block) { return block.back() < e; });
+        return static_cast<std::size_t>(it - _blocks.begin());
+    }
+
+    // 第 rank 项所在的 (块, 块内下标)
+    std::pair<std::size_t, std::size_t> locate(std::size_t rank) const {
+        std::size_t pos = 0;
+        for (std::size_t step = std::bit_floor(_tree.size()); step; step >>= 1) {
+            if (pos + step <= _tree.size() && _tree[pos + step - 1] <= rank) {
+                pos += step;
+                rank -= _tree[pos - 1];
+            }
+        }
+        return {pos, rank};
+    }
+
+    // 前 b 块的项数
+    std::size_t prefix(std::size_t b) const noexcept {
+        std::size_t res = 0;
+        for (; b; b &= b - 1) {
+            res += _tree[b - 1];
+        }
+        return res;
+    }
+
+    void add(std::size_t b, std::ptrdiff_t delta) noexcept {
+        for (++b; b <= _tree.size(); b += b & (~b + 1)) {
+            _tree[b - 1] = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(_tree[b - 1]) + delta);
+        }
+    }
+
+    void rebuildTree() {
+        _tree.assign(_blocks.size(), 0);
+        for (std::size_t b = 1; b <= _tree.size(); ++b) {
+            _tree[b - 1] += _blocks[b - 1].size();
+            if (auto parent = b + (b & (~b + 1)); parent <= _tree.size()) {
+                _tree[parent - 1] += _tree[b - 1];
+            }
+        }
+    }
+
+    std::vector<std::vector<Entry>> _blocks{};
+    std::vector<std::size_t> _tree{};   // 块大小的树状数组
+    std::vector<Entry> _bulk{};
+    std::size_t _size = 0;              // 块中的项数
+    bool _isBulk = false;
+};
+
+} // namespace HX::utils
@@ -0,0 +1,349 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HX::utils {
+
+/**
+ * @brief 只增不删的字符串驻留池: 相同内容只存一份, 以 32 位 id 表示
+ * @note 内容存放在分块的内存池 (arena) 中, 地址永不失效; 按 id 取内容不加锁.
+ *       适合取值集合有限的列 (歌手、专辑、目录等), 不适合唯一的字符串.
+ */
+class StringPool {
+    // 每块 4096 个 id, 最多 4096 块, 共约 1600 万个不同的字符串
+    inline static constexpr std::size_t BlockBits = 12;
+    inline static constexpr std::size_t BlockSize = std::size_t{1} << BlockBits;
+    inline static constexpr std::size_t MaxBlocks = 4096;
+    // arena 每次申请的大小; 超出的长字符串单独申请
+    inline static constexpr std::size_t ChunkSize = 64 * 1024;
+public:
+    StringPool() {
+        // id 0 固定为空串, 即默认构造的 Symbol
+        intern({});
+    }
+
+    StringPool(StringPool const&) = delete;
+    StringPool& operator=(StringPool const&) = delete;
+
+    ~StringPool() noexcept {
+        for (auto& block : _blocks) {
+            delete[] block.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 进程内共享的池
+     */
+    static StringPool& global() {
+        static StringPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief 驻留字符串, 已存在则返回原 id
+     * @param str
+     * @return uint32_t
+     * @throw std::runtime_error id 用尽
+     */
+    uint32_t intern(std::string_view str) {
+        std::lock_guard _{_mtx};
+        if (auto it = _ids.find(str); it != _ids.end()) {
+            return it->second;
+        }
+        auto id = static_cast<uint32_t>(_ids.size());
+        auto blockIdx = id >> BlockBits;
+        if (blockIdx >= MaxBlocks) [[unlikely]] {
+            throw std::runtime_error{"StringPool: too many strings"};
+        }
+        auto* block = _blocks[blockIdx].load(std::memory_order_relaxed);
+        if (!block) {
+            block = new std::string_view[BlockSize]{};
+            _blocks[blockIdx].store(block, std::memory_order_release);
+        }
+        auto view = store(str);
+        block[id & (BlockSize - 1)] = view;
+        _ids.emplace(view, id);
+        _bytes.fetch_add(str.size(), std::memory_order_relaxed);
+        return id;
+    }
+
+    /**
+     * @brief 查找已驻留的字符串, 不会新增
+     * @return id, 不存在为 -1
+     */
+    int64_t find(std::string_view str) const {
+        std::lock_guard _{_mtx};
+        auto it = _ids.find(str);
+        return it == _ids.end() ? -1 : static_cast<int64_t>(it->second);
+    }
+
+    /**
+     * @brief 按 id 取内容, 无锁
+     * @warning id 必须来自本池的 intern
+     */
+    std::string_view view(uint32_t id) const noexcept {
+        return _blocks[id >> BlockBits].load(std::memory_order_acquire)[id & (BlockSize - 1)];
+    }
+
+    /**
+     * @brief 已驻留的字符串个数
+     */
+    std::size_t size() const {
+        std::lock_guard _{_mtx};
+        return _ids.size();
+    }
+
+    /**
+     * @brief 已驻留的字符串内容总字节数
+     */
+    std::size_t byteSize() const noexcept {
+        return _bytes.load(std::memory_order_relaxed);
+    }
+private:
+    std::string_view store(std::string_view str) {
+        if (str.empty()) {
+            return {};
+        }
+        if (str.size() > ChunkSize / 4) {
+            auto& chunk = _chunks.emplace_back(std::make_unique<char[]>(str.size()));
+            std::memcpy(chunk.get(), str.data(), str.size());
+            return {chunk.get(), str.size()};
+        }
+        if (!_chunk || _chunkUsed + str.size() > ChunkSize) {
+            _chunk = _chunks.emplace_back(std::make_unique<char[]>(ChunkSize)).get();
+            _chunkUsed = 0;
+        }
+        char* dst = _chunk + _chunkUsed;
+        std::memcpy(dst, str.data(), str.size());
+        _chunkUsed += str.size();
+        return {dst, str.size()};
+    }
+
+    mutable std::mutex _mtx;
+    std::unordered_map<std::string_view, uint32_t> _ids;
+    std::array<std::atomic<std::string_view*>, MaxBlocks> _blocks{};
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char* _chunk = nullptr;
+    std::size_t _chunkUsed = 0;
+    std::atomic_size_t _bytes{0};
+};
+
+/**
+ * @brief 驻留在 StringPool::global() 中的字符串, 4 字节; 相等比较只比较 id
+ */
+class Symbol {
+public:
+    Symbol() noexcept = default;
+
+    Symbol(std::string_view str)
+        : _id{StringPool::global().intern(str)}
+    {}
+
+    Symbol(std::string const& str)
+        : Symbol{std::string_view{str}}
+    {}
+
+    Symbol(char const* str)
+        : Symbol{std::string_view{str}}
+    {}
+
+    std::string_view view() const noexcept {
+        return StringPool::global().view(_id);
+    }
+
+    operator std::string_view() const noexcept {
+        return view();
+    }
+
+    std::string str() const {
+        return std::string{view()};
+    }
+
+    uint32_t id() const noexcept {
+        return _id;
+    }
+
+    bool empty() const noexcept {
+        return _id == 0;
+    }
+
+    bool operator==(Symbol const&) const noexcept = default;
+
+    // 模板以免与 const char* -> Symbol 的隐式转换产生二义性
+    template <typename Str>
+        requires (std::is_convertible_v<Str const&, std::string_view>)
+    friend bool operator==(Symbol const& sym, Str const& str) noexcept {
+        return sym.view() == std::string_view{str};
+    }
+private:
+    uint32_t _id = 0;
+};
+
+/**
+ * @brief Symbol 数组; 可由 std::vector<std::string> 构造, 也可转换回去, 便于与 VO 互转
+ */
+class SymbolList {
+public:
+    SymbolList() noexcept = default;
+
+    SymbolList(std::initializer_list<Symbol> list)
+        : _list{list}
+    {}
+
+    SymbolList(std::vector<std::string> const& list) {
+        _list.reserve(list.size());
+        for (auto const& str : list) {
+            _list.emplace_back(str);
+        }
+    }
+
+    std::vector<std::string> toStrings() const {
+        std::vector<std::string> res;
+        res.reserve(_list.size());
+        for (auto sym : _list) {
+            res.push_back(sym.str());
+        }
+        return res;
+    }
+
+    operator std::vector<std::string>() const {
+        return toStrings();
+    }
+
+    auto begin() const noexcept { return _list.begin(); }
+    auto end() const noexcept { return _list.end(); }
+    std::size_t size() const noexcept { return _list.size(); }
+    bool empty() const noexcept { return _list.empty(); }
+    Symbol operator[](std::size_t i) const noexcept { return _list[i]; }
+
+    void push_back(Symbol sym) {
+        _list.push_back(sym);
+    }
+
+    bool operator==(SymbolList const&) const noexcept = default;
+private:
+    std::vector<Symbol> _list;
+};
+
+/**
+ * @brief 压缩存储的相对路径: 目录前缀 (含末尾的 '/') 驻留为 Symbol, 只单独存文件名.
+ *        同一目录下的文件共享同一份目录字符串.
+ */
+class CompactPath {
+public:
+    CompactPath() noexcept = default;
+
+    CompactPath(std::string_view path) {
+        auto [dir, file] = split(path);
+        _dir = Symbol{dir};
+        _file = file;
+    }
+
+    CompactPath(std::string const& path)
+        : CompactPath{std::string_view{path}}
+    {}
+
+    CompactPath(char const* path)
+        : CompactPath{std::string_view{path}}
+    {}
+
+    std::string_view dir() const noexcept {
+        return _dir.view();
+    }
+
+    std::string_view file() const noexcept {
+        return _file;
+    }
+
+    std::size_t size() const noexcept {
+        return dir().size() + _file.size();
+    }
+
+    /**
+     * @brief 拼接出完整路径
+     */
+    std::string str() const {
+        std::string res;
+        res.reserve(size());
+        res += dir();
+        res += _file;
+        return res;
+    }
+
+    operator std::string() const {
+        return str();
+    }
+
+    bool operator==(CompactPath const&) const noexcept = default;
+
+    template <typename Str>
+        requires (std::is_convertible_v<Str const&, std::string_view>)
+    friend bool operator==(CompactPath const& path, Str const& s) noexcept {
+        std::string_view str{s};
+        auto dir = path.dir();
+        return str.size() == path.size()
+            && str.starts_with(dir)
+            && str.substr(dir.size()) == path._file;
+    }
+
+    /**
+     * @brief 与完整路径的字符串一致的哈希, 供以 std::string_view 异构查找
+     */
+    static std::size_t hashOf(CompactPath const& path) noexcept {
+        return combine(std::hash<std::string_view>{}(path.dir()), std::hash<std::string_view>{}(path._file));
+    }
+
+    static std::size_t hashOf(std::string_view path) noexcept {
+        auto [dir, file] = split(path);
+        return combine(std::hash<std::string_view>{}(dir), std::hash<std::string_view>{}(file));
+    }
+private:
+    static std::pair<std::string_view, std::string_view> split(std::string_view path) noexcept {
+        auto pos = path.find_last_of('/');
+        if (pos == std::string_view::npos) {
+            return {{}, path};
+        }
+        return {path.substr(0, pos + 1), path.substr(pos + 1)};
+    }
+
+    static std::size_t combine(std::size_t a, std::size_t b) noexcept {
+        return a ^ (b + 0x9e3779b97f4a7c15ULL + (a << 6) + (a >> 2));
+    }
+
+    Symbol _dir;
+    std::string _file;
+};
+
+} // namespace HX::utils
@@ -0,0 +1,472 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <utils/TextTokenizer.hpp>
+
+namespace HX::utils {
+
+/**
+ * @brief 一条输入提示
+ */
+struct Suggestion {
+    std::string text;   // 原文
+    std::size_t field;  // 来自第几个字段
+    uint32_t cnt;       // 出现次数 (权重)
+};
+
+/**
+ * @brief 前缀提示: 压缩前缀树 (radix trie), 每个节点预先保存其子树中权重最高的 TopK 条,
+ *        因此一次查询只是一次自根向下的遍历, 不需要排序.
+ * @note 每条 (字段, 原文) 的权重为其出现次数, 由 add 增减. 除规范化后的原文外还会生成备用键:
+ *       从第二个词起的各个后缀 (输入 "day" 可提示 "Sunny Day"), 以及含假名时的罗马字.
+ *       权重上升时沿路径就地调整各节点的前 K 条; 下降时只有该条原本在前 K 条且名额已满的节点
+ *       才需要自底向上由子节点的前 K 条重算.
+ * @warning 本身不加锁; suggest 为只读, 可与其他 suggest 并发
+ * @tparam TopK 每个节点保存的条数, 即单次提示的上限
+ */
+template <std::size_t TopK = 10>
+    requires (TopK > 0 && TopK < 256)
+class SuggestTrie {
+    // 每条原文最多生成的键数 (含自身)
+    inline static constexpr std::size_t MaxKeyCnt = 4;
+    inline static constexpr uint32_t Null = static_cast<uint32_t>(-1);
+
+    struct Entry {
+        std::string text;
+        uint32_t weight;
+        uint8_t field;
+    };
+
+    struct Node {
+        uint32_t labelOff = 0;      // 边上的字节在 _labels 中的范围
+        uint32_t labelLen = 0;
+        uint32_t firstChild = Null;
+        uint32_t nextSibling = Null;
+        uint32_t terminal = Null;   // 键在此结束的条目链表 (_terminals)
+        char first = 0;             // 边上的第一个字节, 查找子节点时不必访问 _labels
+        uint8_t topCnt = 0;
+        std::array<uint32_t, TopK> top{};
+    };
+
+    struct Terminal {
+        uint32_t entry;
+        uint32_t next;
+    };
+
+    struct TextHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+public:
+    SuggestTrie()
+        : _nodes(1)
+    {}
+
+    /**
+     * @brief 调整 (字段, 原文) 的权重
+     * @param field 字段序号 (< 256)
+     * @param text 原文, 规范化后为空的不会被提示
+     * @param delta 增量, 权重最低减到 0 (此时不再被提示)
+     */
+    void add(std::size_t field, std::string_view text, int64_t delta) {
+        if (!delta || text.empty()) {
+            return;
+        }
+        if (field >= _entryOf.size()) {
+            _entryOf.resize(field + 1);
+        }
+        auto& entryOf = _entryOf[field];
+        auto it = entryOf.find(text);
+        if (it == entryOf.end()) {
+            if (delta < 0) {
+                return;
+            }
+            it = entryOf.emplace(std::string{text}, static_cast<uint32_t>(_entries.size())).first;
+            _entries.push_back({std::string{text}, 0, static_cast<uint8_t>(field)});
+        }
+        uint32_t e = it->second;
+        auto& weight = _entries[e].weight;
+        auto old = weight;
+        weight = static_cast<uint32_t>(std::clamp<int64_t>(
+            static_cast<int64_t>(old) + delta, 0, static_cast<int64_t>(Null)));
+        if (weight == old || _isBulk) {
+            return;
+        }
+        for (auto const& key : keysOf(text)) {
+            if (weight > old) {
+                auto path = insertPath(key);
+                if (!old) {
+                    addTerminal(path.back(), e);
+                }
+                for (auto node : path) {
+                    promote(node, e);
+                }
+            } else {
+                auto path = findPath(key);
+                if (path.empty()) [[unlikely]] {
+                    continue;
+                }
+                if (!weight) {
+                    removeTerminal(path.back(), e);
+                }
+                // 自底向上, 重算时子节点已是最新
+                for (auto node = path.rbegin(); node != path.rend(); ++node) {
+                    demote(*node, e);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 开始批量加载: 此后 add 只累计权重, 到 endBulk 时再一次性建树
+     * @note 加载整张表时, 热门的歌手、专辑会被累加成千上万次, 逐次沿路径调整的代价远高于最后一次建树
+     */
+    void beginBulk() noexcept {
+        _isBulk = true;
+    }
+
+    /**
+     * @brief 结束批量加载: 以各条目当前的权重重建整棵树, 自底向上计算各节点的前 K 条
+     */
+    void endBulk() {
+        if (!_isBulk) {
+            return;
+        }
+        _isBulk = false;
+        _nodes.assign(1, Node{});
+        _labels.clear();
+        _terminals.clear();
+        // 按键的顺序插入: 每次只在最右侧的路径上分裂或追加, 访问的节点大多还在缓存中
+        std::vector<std::pair<std::string, uint32_t>> keys;
+        keys.reserve(_entries.size() * 2);
+        for (uint32_t e = 0; e < _entries.size(); ++e) {
+            if (!_entries[e].weight) {
+                continue;
+            }
+            for (auto& key : keysOf(_entries[e].text)) {
+                keys.emplace_back(std::move(key), e);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        for (auto const& [key, e] : keys) {
+            addTerminal(insertPath(key).back(), e);
+        }
+        // 广度优先序的逆序中, 子节点总在父节点之前
+        std::vector<uint32_t> order{0};
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            for (auto child = _nodes[order[i]].firstChild; child != Null; child = _nodes[child].nextSibling) {
+                order.push_back(child);
+            }
+        }
+        for (auto node = order.rbegin(); node != order.rend(); ++node) {
+            recompute(*node);
+        }
+    }
+
+    /**
+     * @brief 以 prefix 为前缀的条目中权重最高的至多 k 条 (k 不超过 TopK)
+     * @param prefix 按 TextTokenizer::normalize 规范化后匹配, 末尾的空格表示词已输入完整
+     */
+    std::vector<Suggestion> suggest(std::string_view prefix, std::size_t k) const {
+        std::vector<Suggestion> res;
+        auto key = TextTokenizer::normalize(prefix, true);
+        if (key.empty()) {
+            return res;
+        }
+        uint32_t node = 0;
+        for (std::size_t pos = 0; pos < key.size(); ) {
+            node = findChild(node, key[pos]);
+            if (node == Null) {
+                return res;
+            }
+            auto label = labelOf(node);
+            auto n = std::min(label.size(), key.size() - pos);
+            if (label.substr(0, n) != std::string_view{key}.substr(pos, n)) {
+                return res;
+            }
+            pos += n;
+        }
+        auto const& top = _nodes[node];
+        k = std::min<std::size_t>(k, top.topCnt);
+        res.reserve(k);
+        for (std::size_t i = 0; i < k; ++i) {
+            auto const& entry = _entries[top.top[i]];
+            res.push_back({entry.text, entry.field, entry.weight});
+        }
+        return res;
+    }
+
+    /**
+     * @brief 节点数
+     */
+    std::size_t nodeCnt() const noexcept {
+        return _nodes.size();
+    }
+private:
+    /**
+     * @brief 原文的全部键: 规范形式、从第二个词起的后缀、含假名时的罗马字; 已去重
+     */
+    static std::vector<std::string> keysOf(std::string_view text) {
+        std::vector<std::string> keys;
+        auto key = TextTokenizer::normalize(text);
+        if (key.empty()) {
+            return keys;
+        }
+        auto addKey = [&](std::string k) {
+            if (keys.size() < MaxKeyCnt && !k.empty()
+                && std::find(keys.begin(), keys.end(), k) == keys.end()
+            ) {
+                keys.push_back(std::move(k));
+            }
+        };
+        // 罗马字排在后缀之前, 以免长标题的后缀占满名额
+        auto romaji = TextTokenizer::toRomaji(key);
+        addKey(key);
+        if (romaji != key) {
+            addKey(std::move(romaji));
+        }
+        for (auto pos = key.find(' '); pos != std::string::npos; pos = key.find(' ', pos + 1)) {
+            addKey(key.substr(pos + 1));
+        }
+        return keys;
+    }
+
+    std::string_view labelOf(uint32_t node) const noexcept {
+        auto const& n = _nodes[node];
+        return std::string_view{_labels}.substr(n.labelOff, n.labelLen);
+    }
+
+    uint32_t findChild(uint32_t node, char c) const noexcept {
+        for (auto child = _nodes[node].firstChild; child != Null; child = _nodes[child].nextSibling) {
+            if (_nodes[child].first == c) {
+                return child;
+            }
+        }
+        return Null;
+    }
+
+    /**
+     * @brief 同 findChild, 并把找到的子节点移到兄弟链表的最前面
+     * @note 写入集中在常见的前缀 (热门歌手、专辑) 上, 移到最前可缩短之后的查找
+     */
+    uint32_t findChildToFront(uint32_t node, char c) noexcept {
+        auto* link = &_nodes[node].firstChild;
+        for (; *link != Null; link = &_nodes[*link].nextSibling) {
+            auto child = *link;
+            if (_nodes[child].first == c) {
+                *link = _nodes[child].nextSibling;
+                _nodes[child].nextSibling = _nodes[node].firstChild;
+                _nodes[node].firstChild = child;
+                return child;
+            }
+        }
+        return Null;
+    }
+
+    uint32_t newNode() {
+        _nodes.emplace_back();
+        return static_cast<uint32_t>(_nodes.size() - 1);
+    }
+
+    /**
+     * @brief 自根到 key 所在节点的路径, 必要时新建或分裂节点
+     */
+    std::vector<uint32_t> insertPath(std::string_view key) {
+        std::vector<uint32_t> path{0};
+        uint32_t node = 0;
+        for (std::size_t pos = 0; pos < key.size(); ) {
+            auto child = findChildToFront(node, key[pos]);
+            if (child == Null) {
+                auto leaf = newNode();
+                _nodes[leaf].labelOff = static_cast<uint32_t>(_labels.size());
+                _nodes[leaf].labelLen = static_cast<uint32_t>(key.size() - pos);
+                _nodes[leaf].first = key[pos];
+                _labels += key.substr(pos);
+                _nodes[leaf].nextSibling = _nodes[node].firstChild;
+                _nodes[node].firstChild = leaf;
+                path.push_back(leaf);
+                break;
+            }
+            auto label = labelOf(child);
+            auto rest = key.substr(pos);
+            auto common = static_cast<std::size_t>(std::mismatch(
+                label.begin(), label.begin() + static_cast<std::ptrdiff_t>(std::min(label.size(), rest.size())),
+                rest.begin()).first - label.begin());
+            if (common < label.size()) {
+                // 分裂: node -> mid (label 的公共前缀) -> child (剩余部分); mid 的子树与 child 相同
+                auto mid = newNode();
+                auto& m = _nodes[mid];
+                auto& c = _nodes[child];
+                m.labelOff = c.labelOff;
+                m.labelLen = static_cast<uint32_t>(common);
+                m.first = c.first;
+                m.firstChild = child;
+                m.top = c.top;
+                m.topCnt = c.topCnt;
+                c.labelOff += static_cast<uint32_t>(common);
+                c.labelLen -= static_cast<uint32_t>(common);
+                c.first = _labels[c.labelOff];
+                replaceChild(node, child, mid);
+                child = mid;
+            }
+            path.push_back(child);
+            node = child;
+            pos += common;
+        }
+        return path;
+    }
+
+    void replaceChild(uint32_t node, uint32_t from, uint32_t to) {
+        auto* link = &_nodes[node].firstChild;
+        while (*link != from) {
+            link = &_nodes[*link].nextSibling;
+        }
+        *link = to;
+        _nodes[to].nextSibling = _nodes[from].nextSibling;
+        _nodes[from].nextSibling = Null;
+    }
+
+    /**
+     * @brief 自根到 key 所在节点的路径, 不存在时为空
+     */
+    std::vector<uint32_t> findPath(std::string_view key) const {
+        std::vector<uint32_t> path{0};
+        uint32_t node = 0;
+        for (std::size_t pos = 0; pos < key.size(); ) {
+            node = findChild(node, key[pos]);
+            if (node == Null || !key.substr(pos).starts_with(labelOf(node))) {
+                return {};
+            }
+            path.push_back(node);
+            pos += _nodes[node].labelLen;
+        }
+        return path;
+    }
+
+    // 同一条目的各个键互不相同, 不会在同一节点结束两次
+    void addTerminal(uint32_t node, uint32_t e) {
+        _terminals.push_back({e, _nodes[node].terminal});
+        _nodes[node].terminal = static_cast<uint32_t>(_terminals.size() - 1);
+    }
+
+    void removeTerminal(uint32_t node, uint32_t e) {
+        for (auto* link = &_nodes[node].terminal; *link != Null; link = &_terminals[*link].next) {
+            if (_terminals[*link].entry == e) {
+                *link = _terminals[*link].next;
+                return;
+            }
+        }
+    }
+
+    // 权重高者在前, 同权重时先出现的在前
+    bool isBetter(uint32_t a, uint32_t b) const noexcept {
+        auto wa = _entries[a].weight, wb = _entries[b].weight;
+        return wa != wb ? wa > wb : a < b;
+    }
+
+    /**
+     * @brief e 的权重上升后调整 node 的前 K 条
+     */
+    void promote(uint32_t node, uint32_t e) {
+        auto& n = _nodes[node];
+        std::size_t i = std::find(n.top.begin(), n.top.begin() + n.topCnt, e) - n.top.begin();
+        if (i == n.topCnt) {
+            if (n.topCnt < TopK) {
+                ++n.topCnt;
+            } else if (isBetter(e, n.top[TopK - 1])) {
+                --i;
+            } else {
+                return;
+            }
+            n.top[i] = e;
+        }
+        for (; i > 0 && isBetter(n.top[i], n.top[i - 1]); --i) {
+            std::swap(n.top[i], n.top[i - 1]);
+        }
+    }
+
+    /**
+     * @brief e 的权重下降后调整 node 的前 K 条
+     * @note 名额未满说明子树中的条目全在其中, 就地调整即可; 否则由键结束于此的条目与子节点的前 K 条重算
+     */
+    void demote(uint32_t node, uint32_t e) {
+        auto& n = _nodes[node];
+        std::size_t i = std::find(n.top.begin(), n.top.begin() + n.topCnt, e) - n.top.begin();
+        if (i == n.topCnt) {
+            return;
+        }
+        if (n.topCnt == TopK) {
+            recompute(node);
+            return;
+        }
+        if (!_entries[e].weight) {
+            std::copy(n.top.begin() + static_cast<std::ptrdiff_t>(i) + 1, n.top.begin() + n.topCnt,
+                n.top.begin() + static_cast<std::ptrdiff_t>(i));
+            --n.topCnt;
+            return;
+        }
+        for (; i + 1 < n.topCnt && isBetter(n.top[i + 1], n.top[i]); ++i) {
+            std::swap(n.top[i], n.top[i + 1]);
+        }
+    }
+
+    void recompute(uint32_t node) {
+        auto& cand = _scratch;
+        cand.clear();
+        for (auto t = _nodes[node].terminal; t != Null; t = _terminals[t].next) {
+            cand.push_back(_terminals[t].entry);
+        }
+        for (auto child = _nodes[node].firstChild; child != Null; child = _nodes[child].nextSibling) {
+            auto const& c = _nodes[child];
+            cand.insert(cand.end(), c.top.begin(), c.top.begin() + c.topCnt);
+        }
+        std::sort(cand.begin(), cand.end());
+        cand.erase(std::unique(cand.begin(), cand.end()), cand.end());
+        std::erase_if(cand, [&](uint32_t e) { return !_entries[e].weight; });
+        auto cnt = std::min(cand.size(), TopK);
+        std::partial_sort(cand.begin(), cand.begin() + static_cast<std::ptrdiff_t>(cnt), cand.end(),
+            [&](uint32_t a, uint32_t b) { return isBetter(a, b); });
+        auto& n = _nodes[node];
+        std::copy_n(cand.begin(), cnt, n.top.begin());
+        n.topCnt = static_cast<uint8_t>(cnt);
+    }
+
+    std::vector<Node> _nodes;               // _nodes[0] 为根
+    std::string _labels{};                  // 各节点边上的字节; 分裂时只调整范围, 不会复制
+    std::vector<Terminal> _terminals{};
+    std::vector<Entry> _entries{};
+    // [字段序号]: 原文 -> 条目
+    std::vector<std::unordered_map<std::string, uint32_t, TextHash, std::equal_to<>>> _entryOf{};
+    std::vector<uint32_t> _scratch{};
+    bool _isBulk = false;
+};
+
+} // namespace HX::utils
@@ -0,0 +1,447 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <utils/TextTokenizer.hpp>
+
+namespace HX::utils {
+
+/**
+ * @brief 全文检索的一条结果
+ */
+template <typename Id>
+struct TextHit {
+    Id id;
+    float score;
+};
+
+/**
+ * @brief 内存倒排索引: 词 -> 包含它的文档 (行) 列表, 按相关度返回前 k 条
+ * @note 文档以内部的连续序号 (docNo) 存储, 更新时分配新序号并把旧序号记为删除,
+ *       因此倒排表只在末尾追加, 可用差值 varint 压缩; 删除的序号累积过多时整体重建.
+ *       每个倒排项附带命中的字段位掩码, 靠前的字段权重更高 (见 db::TextIndex).
+ * @warning 本身不加锁; search 为只读, 可与其他 search 并发
+ * @tparam Id 主键类型
+ * @tparam FieldCnt 字段数 (1 ~ 8), 第 i 个字段的权重为 FieldCnt - i
+ */
+template <typename Id, std::size_t FieldCnt = 1>
+    requires (FieldCnt > 0 && FieldCnt <= 8)
+class TextIndex {
+    // 每块的倒排项数; 块首记录跳表项, 供求交时跳过整块
+    inline static constexpr uint32_t BlockSize = 64;
+    // 删除的序号超过该值且超过存活数的一半时重建
+    inline static constexpr std::size_t MinCompactCnt = 1024;
+
+    struct Skip {
+        uint32_t prevDoc;   // 块前一项的序号 (块首项的差值基准)
+        uint32_t offset;    // 块首项在 bytes 中的偏移
+        uint8_t maskOr;     // 块内各项字段掩码的并, 用于估计块内得分的上界
+    };
+
+    struct PostingList {
+        std::vector<uint8_t> bytes; // (varint 差值, 字段掩码) 序列
+        std::vector<Skip> skips;
+        uint32_t lastDoc = 0;
+        uint32_t cnt = 0;
+        uint8_t maskOr = 0;
+
+        void append(uint32_t doc, uint8_t mask) {
+            if (cnt % BlockSize == 0) {
+                skips.push_back({lastDoc, static_cast<uint32_t>(bytes.size()), 0});
+            }
+            skips.back().maskOr |= mask;
+            maskOr |= mask;
+            for (uint32_t delta = doc - lastDoc; ; delta >>= 7) {
+                if (delta < 0x80) {
+                    bytes.push_back(static_cast<uint8_t>(delta));
+                    break;
+                }
+                bytes.push_back(static_cast<uint8_t>(delta | 0x80));
+            }
+            bytes.push_back(mask);
+            lastDoc = doc;
+            ++cnt;
+        }
+    };
+
+    /**
+     * @brief 顺序遍历倒排表, 支持按跳表前进到不小于目标的序号
+     */
+    class Cursor {
+    public:
+        explicit Cursor(PostingList const* list) noexcept
+            : _list{list}
+        {}
+
+        uint32_t doc() const noexcept { return _doc; }
+        uint8_t mask() const noexcept { return _mask; }
+        uint32_t size() const noexcept { return _list->cnt; }
+        PostingList const* list() const noexcept { return _list; }
+        // 当前项所在块的字段掩码的并
+        uint8_t blockMask() const noexcept { return _list->skips[(_idx - 1) / BlockSize].maskOr; }
+
+        /**
+         * @brief 前进一项
+         * @return false 已到末尾
+         */
+        bool next() noexcept {
+            auto const& bytes = _list->bytes;
+            if (_pos >= bytes.size()) {
+                return false;
+            }
+            uint32_t delta = 0;
+            for (int shift = 0; ; shift += 7) {
+                uint8_t b = bytes[_pos++];
+                delta |= static_cast<uint32_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) {
+                    break;
+                }
+            }
+            _doc += delta;
+            _mask = bytes[_pos++];
+            ++_idx;
+            return true;
+        }
+
+        /**
+         * @brief 跳过当前块的剩余项, 前进到下一块的块首
+         * @return false 已到末尾
+         */
+        bool nextBlock() noexcept {
+            std::size_t block = _idx ? (_idx - 1) / BlockSize + 1 : 0;
+            if (block >= _list->skips.size()) {
+                _pos = _list->bytes.size();
+                return false;
+            }
+            jumpTo(block);
+            return next();
+        }
+
+        /**
+         * @brief 前进到第一个序号不小于 target 的项 (当前项已满足时不动)
+         * @return false 已到末尾
+         */
+        bool seek(uint32_t target) noexcept {
+            if (_doc >= target && _pos) {
+                return true;
+            }
+            // 最后一个 prevDoc < target 的块即 target 所在的块; 目标常在当前块内, 此时不必二分
+            auto const& skips = _list->skips;
+            std::size_t block = _idx ? (_idx - 1) / BlockSize + 1 : 0;
+            if (block < skips.size() && skips[block].prevDoc < target) {
+                auto it = std::partition_point(skips.begin() + static_cast<std::ptrdiff_t>(block), skips.end(),
+                    [&](Skip const& s) {
+                        return s.prevDoc < target;
+                    });
+                jumpTo(static_cast<std::size_t>(it - skips.begin()) - 1);
+            }
+            while (next()) {
+                if (_doc >= target) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    private:
+        void jumpTo(std::size_t block) noexcept {
+            auto const& skip = _list->skips[block];
+            _pos = skip.offset;
+            _doc = skip.prevDoc;
+            _idx = static_cast<uint32_t>(block * BlockSize);
+        }
+
+        PostingList const* _list;
+        std::size_t _pos = 0;
+        uint32_t _idx = 0;  // 已读的项数
+        uint32_t _doc = 0;
+        uint8_t _mask = 0;
+    };
+
+    struct Scored {
+        uint32_t doc;
+        float score;
+    };
+
+    // 字段掩码 -> 权重之和, 第 i 个字段的权重为 FieldCnt - i
+    inline static constexpr auto Weights = [] {
+        std::array<float, 256> res{};
+        for (std::size_t mask = 0; mask < res.size(); ++mask) {
+            for (std::size_t i = 0; i < FieldCnt; ++i) {
+                if (mask >> i & 1) {
+                    res[mask] += static_cast<float>(FieldCnt - i);
+                }
+            }
+        }
+        return res;
+    }();
+
+    struct TermHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+public:
+    /**
+     * @brief 预留文档数
+     */
+    void reserve(std::size_t n) {
+        _docIds.reserve(n);
+        _alive.reserve(n);
+        _docOf.reserve(n);
+    }
+
+    /**
+     * @brief 写入 (或覆盖) 文档 id
+     * @param fields 以 `fields(sink)` 调用, 其内对每段文本调用 `sink(std::size_t field, std::string_view text)`
+     */
+    template <typename Func>
+    void insert(Id id, Func&& fields) {
+        erase(id);
+        if (_docIds.size() >= std::numeric_limits<uint32_t>::max()) [[unlikely]] {
+            compact();
+        }
+        auto doc = static_cast<uint32_t>(_docIds.size());
+        _docIds.push_back(id);
+        _alive.push_back(true);
+        _docOf.emplace(id, doc);
+        // 同一词在文档中只记一项, 合并各字段的掩码; 每行的词不多, 线性去重即可
+        _scratch.clear();
+        fields([&](std::size_t field, std::string_view text) {
+            auto mask = static_cast<uint8_t>(1U << field);
+            TextTokenizer::tokenize<true>(text, [&](std::string_view term) {
+                auto it = _terms.find(term);
+                if (it == _terms.end()) {
+                    it = _terms.emplace(std::string{term}, PostingList{}).first;
+                }
+                for (auto& [list, m] : _scratch) {
+                    if (list == &it->second) {
+                        m |= mask;
+                        return;
+                    }
+                }
+                _scratch.emplace_back(&it->second, mask);
+            });
+        });
+        for (auto [list, mask] : _scratch) {
+            list->append(doc, mask);
+        }
+    }
+
+    /**
+     * @brief 删除文档 id, 不存在则忽略
+     */
+    void erase(Id id) {
+        auto it = _docOf.find(id);
+        if (it == _docOf.end()) {
+            return;
+        }
+        _alive[it->second] = false;
+        _docOf.erase(it);
+        if (++_deadCnt > MinCompactCnt && _deadCnt > _docOf.size() / 2) {
+            compact();
+        }
+    }
+
+    /**
+     * @brief 检索: 返回包含 query 全部词的文档, 按得分从高到低, 同分时先写入索引的在前
+     * @note 得分为各词 idf 与其命中字段权重之积的和. 前 k 条已满时,
+     *       以块内字段掩码估计上界, 整块跳过不可能进入前 k 条的倒排项, 因此常见词也不必逐项计分
+     * @param query 查询文本, 切分方式见 TextTokenizer
+     * @param k 最多返回的条数
+     * @return std::vector<TextHit<Id>>
+     */
+    std::vector<TextHit<Id>> search(std::string_view query, std::size_t k) const {
+        std::vector<TextHit<Id>> res;
+        if (!k) {
+            return res;
+        }
+        std::vector<Cursor> cursors;
+        bool isMiss = false;
+        TextTokenizer::tokenize<false>(query, [&](std::string_view term) {
+            auto it = _terms.find(term);
+            if (it == _terms.end()) {
+                isMiss = true;
+                return;
+            }
+            // 查询中重复的词只算一次
+            if (std::none_of(cursors.begin(), cursors.end(), [&](Cursor const& c) {
+                return c.list() == &it->second;
+            })) {
+                cursors.emplace_back(&it->second);
+            }
+        });
+        if (isMiss || cursors.empty()) {
+            return res;
+        }
+        // 从最短的倒排表开始求交
+        std::sort(cursors.begin(), cursors.end(), [](Cursor const& a, Cursor const& b) {
+            return a.size() < b.size();
+        });
+        // 各词的 idf 与其得分的上界
+        std::vector<float> idf, maxPart;
+        idf.reserve(cursors.size());
+        maxPart.reserve(cursors.size());
+        for (auto const& c : cursors) {
+            idf.push_back(static_cast<float>(
+                std::log(1.0 + static_cast<double>(_docIds.size()) / c.size())));
+            maxPart.push_back(idf.back() * Weights[c.list()->maskOr]);
+        }
+        // lead 当前块内文档得分的上界; 与计分按相同顺序累加, 浮点舍入下也不会低于实际得分
+        auto blockBound = [&] {
+            float bound = idf[0] * Weights[cursors.front().blockMask()];
+            for (std::size_t i = 1; i < cursors.size(); ++i) {
+                bound += maxPart[i];
+            }
+            return bound;
+        };
+        // 小顶堆: 堆顶为当前前 k 条中最差的一条
+        auto isBetter = [](Scored const& a, Scored const& b) {
+            return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+        };
+        std::priority_queue<Scored, std::vector<Scored>, decltype(isBetter)> heap{isBetter};
+        auto drain = [&] {
+            res.resize(heap.size());
+            for (auto i = res.size(); i--; heap.pop()) {
+                res[i] = {_docIds[heap.top().doc], heap.top().score};
+            }
+            return std::move(res);
+        };
+        auto& lead = cursors.front();
+        if (!lead.next()) {
+            return res;
+        }
+        for (uint32_t doc = lead.doc(); ; ) {
+            // 之后的文档序号更大, 同分也无法胜出
+            if (heap.size() == k && blockBound() <= heap.top().score) {
+                if (!lead.nextBlock()) {
+                    return drain();
+                }
+                doc = lead.doc();
+                continue;
+            }
+            bool isAll = true;
+            for (std::size_t i = 1; i < cursors.size(); ++i) {
+                if (!cursors[i].seek(doc)) {
+                    return drain();
+                }
+                if (cursors[i].doc() > doc) {
+                    isAll = false;
+                    if (!lead.seek(cursors[i].doc())) {
+                        return drain();
+                    }
+                    doc = lead.doc();
+                    break;
+                }
+            }
+            if (!isAll) {
+                continue;
+            }
+            if (_alive[doc]) {
+                float score = 0;
+                for (std::size_t i = 0; i < cursors.size(); ++i) {
+                    score += idf[i] * Weights[cursors[i].mask()];
+                }
+                if (heap.size() < k) {
+                    heap.push({doc, score});
+                } else if (isBetter({doc, score}, heap.top())) {
+                    heap.pop();
+                    heap.push({doc, score});
+                }
+            }
+            if (!lead.next()) {
+                return drain();
+            }
+            doc = lead.doc();
+        }
+    }
+
+    /**
+     * @brief 存活的文档数
+     */
+    std::size_t size() const noexcept {
+        return _docOf.size();
+    }
+
+    /**
+     * @brief 不同的词数
+     */
+    std::size_t termCnt() const noexcept {
+        return _terms.size();
+    }
+private:
+    /**
+     * @brief 去掉已删除的序号, 重新编号并重建全部倒排表
+     */
+    void compact() {
+        std::vector<uint32_t> newNo(_docIds.size());
+        std::vector<Id> docIds;
+        docIds.reserve(_docOf.size());
+        for (std::size_t doc = 0; doc < _docIds.size(); ++doc) {
+            if (_alive[doc]) {
+                newNo[doc] = static_cast<uint32_t>(docIds.size());
+                docIds.push_back(_docIds[doc]);
+            }
+        }
+        for (auto it = _terms.begin(); it != _terms.end(); ) {
+            PostingList list;
+            Cursor c{&it->second};
+            while (c.next()) {
+                if (_alive[c.doc()]) {
+                    list.append(newNo[c.doc()], c.mask());
+                }
+            }
+            if (list.cnt) {
+                list.bytes.shrink_to_fit();
+                it->second = std::move(list);
+                ++it;
+            } else {
+                it = _terms.erase(it);
+            }
+        }
+        for (auto& [id, doc] : _docOf) {
+            doc = newNo[doc];
+        }
+        _docIds = std::move(docIds);
+        _alive.assign(_docIds.size(), true);
+        _deadCnt = 0;
+    }
+
+    std::unordered_map<std::string, PostingList, TermHash, std::equal_to<>> _terms{};
+    std::vector<Id> _docIds{};      // docNo -> 主键
+    std::vector<bool> _alive{};     // docNo 是否存活
+    std::unordered_map<Id, uint32_t> _docOf{};
+    std::size_t _deadCnt = 0;
+    std::vector<std::pair<PostingList*, uint8_t>> _scratch{};
+};
+
+} // namespace HX::utils
@@ -0,0 +1,283 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace HX::utils {
+
+/**
+ * @brief 全文检索的分词: 以空格分词的文字 (拉丁、希腊、西里尔字母与数字) 按词切分并转为小写,
+ *        中日韩文字切为重叠的二元组 (bigram); 其余字符 (标点、空白等) 都作为分隔符.
+ * @note 全角字母数字按半角处理. 索引时每个中日韩字符还会作为一元词,
+ *       使查询单个字时也能命中; 查询时只有单独出现的一个字才使用一元词.
+ */
+class TextTokenizer {
+public:
+    /**
+     * @brief 切分 text, 依次以 `(std::string_view token)` 调用 func; 同一个词可能出现多次
+     * @tparam IsIndex true 为建索引时的切分, false 为查询时的切分
+     */
+    template <bool IsIndex, typename Func>
+    static void tokenize(std::string_view text, Func&& func) {
+        std::string word;
+        // 当前中日韩字符串中的前一个字符 (UTF-8), 以及该串的长度
+        std::string_view prev{};
+        std::size_t runLen = 0;
+        std::string bigram;
+        auto endWord = [&] {
+            if (!word.empty()) {
+                func(std::string_view{word});
+                word.clear();
+            }
+        };
+        auto endRun = [&] {
+            if constexpr (!IsIndex) {
+                if (runLen == 1) {
+                    func(prev);
+                }
+            }
+            prev = {};
+            runLen = 0;
+        };
+        for (std::size_t i = 0; i < text.size();) {
+            auto [cp, len] = decode(text, i);
+            std::string_view bytes = text.substr(i, len);
+            i += len;
+            switch (classOf(cp)) {
+                case CharClass::Word:
+                    endRun();
+                    appendFolded(word, cp, bytes);
+                    break;
+                case CharClass::Cjk:
+                    endWord();
+                    if constexpr (IsIndex) {
+                        func(bytes);
+                    }
+                    if (runLen) {
+                        bigram.assign(prev);
+                        bigram += bytes;
+                        func(std::string_view{bigram});
+                    }
+                    prev = bytes;
+                    ++runLen;
+                    break;
+                case CharClass::Separator:
+                    endWord();
+                    endRun();
+                    break;
+            }
+        }
+        endWord();
+        endRun();
+    }
+
+    /**
+     * @brief 前缀匹配用的规范形式: 字母数字按 tokenize 的规则折叠, 片假名转为平假名,
+     *        其余中日韩文字原样保留, 连续的分隔符合并为一个空格并去掉开头的空格
+     * @param text
+     * @param isKeepTrailingSep 是否保留末尾的一个空格 (查询时表示上一个词已输入完整)
+     * @return std::string
+     */
+    static std::string normalize(std::string_view text, bool isKeepTrailingSep = false) {
+        std::string res;
+        res.reserve(text.size());
+        bool isSep = false;
+        for (std::size_t i = 0; i < text.size();) {
+            auto [cp, len] = decode(text, i);
+            std::string_view bytes = text.substr(i, len);
+            i += len;
+            auto cls = classOf(cp);
+            if (cls == CharClass::Separator) {
+                isSep = !res.empty();
+                continue;
+            }
+            if (isSep) {
+                res += ' ';
+                isSep = false;
+            }
+            if (cls == CharClass::Word) {
+                appendFolded(res, cp, bytes);
+            } else if (cp >= 0x30A1 && cp <= 0x30F6) {
+                appendUtf8(res, cp - 0x60);
+            } else {
+                res += bytes;
+            }
+        }
+        if (isSep && isKeepTrailingSep) {
+            res += ' ';
+        }
+        return res;
+    }
+
+    /**
+     * @brief 把 text 中的平假名转写为平文式罗马字, 其余字节原样保留
+     * @note 用于为日文标题生成可以用罗马字输入匹配的备用键; 应先经 normalize 把片假名转为平假名
+     */
+    static std::string toRomaji(std::string_view text) {
+        // U+3041 ~ U+3096
+        static constexpr std::string_view Table[] = {
+            "a", "a", "i", "i", "u", "u", "e", "e", "o", "o",
+            "ka", "ga", "ki", "gi", "ku", "gu", "ke", "ge", "ko", "go",
+            "sa", "za", "shi", "ji", "su", "zu", "se", "ze", "so", "zo",
+            "ta", "da", "chi", "ji", "", "tsu", "zu", "te", "de", "to", "do",
+            "na", "ni", "nu", "ne", "no",
+            "ha", "ba", "pa", "hi", "bi", "pi", "fu", "bu", "pu",
+            "he", "be", "pe", "ho", "bo", "po",
+            "ma", "mi", "mu", "me", "mo",
+            "ya", "ya", "yu", "yu", "yo", "yo",
+            "ra", "ri", "ru", "re", "ro",
+            "wa", "wa", "i", "e", "o", "n", "vu", "ka", "ke",
+        };
+        std::string res;
+        res.reserve(text.size());
+        bool isSokuon = false;  // 前一个字是促音 (っ), 下一个辅音重复
+        for (std::size_t i = 0; i < text.size();) {
+            auto [cp, len] = decode(text, i);
+            std::string_view bytes = text.substr(i, len);
+            i += len;
+            if (cp < 0x3041 || cp > 0x3096) {
+                if (cp != 0x30FC) {     // 长音符号不转写
+                    res += bytes;
+                }
+                isSokuon = false;
+                continue;
+            }
+            if (cp == 0x3063) {
+                isSokuon = true;
+                continue;
+            }
+            std::string_view romaji = Table[cp - 0x3041];
+            bool isSmallY = cp == 0x3083 || cp == 0x3085 || cp == 0x3087;
+            bool isSmallVowel = cp <= 0x3049 && (cp & 1);
+            if (isSmallY && res.ends_with('i') && res.size() >= 2) {
+                // 拗音: きゃ -> kya, しゃ -> sha, ちゃ -> cha, じゃ -> ja
+                res.pop_back();
+                if (!res.ends_with("sh") && !res.ends_with("ch") && !res.ends_with('j')) {
+                    res += 'y';
+                }
+                res += romaji.back();
+                continue;
+            }
+            if (isSmallVowel && res.ends_with('u') && (res.ends_with("fu") || res.ends_with("vu"))) {
+                // ふぁ -> fa
+                res.pop_back();
+                res += romaji;
+                continue;
+            }
+            if (isSokuon) {
+                res += romaji.starts_with("ch") ? 't' : romaji.front();
+                isSokuon = false;
+            }
+            res += romaji;
+        }
+        return res;
+    }
+private:
+    enum class CharClass : uint8_t {
+        Word,
+        Cjk,
+        Separator,
+    };
+
+    /**
+     * @brief 解码 text[i] 起的一个 UTF-8 字符; 非法的字节作为 U+FFFD, 长度为 1
+     * @return {码点, 字节数}
+     */
+    static std::pair<char32_t, std::size_t> decode(std::string_view text, std::size_t i) noexcept {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            return {c, 1};
+        }
+        std::size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+        if (!len || i + len > text.size()) {
+            return {0xFFFD, 1};
+        }
+        char32_t cp = c & (0x7F >> len);
+        for (std::size_t k = 1; k < len; ++k) {
+            auto cc = static_cast<unsigned char>(text[i + k]);
+            if ((cc & 0xC0) != 0x80) {
+                return {0xFFFD, 1};
+            }
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        return {cp, len};
+    }
+
+    static CharClass classOf(char32_t cp) noexcept {
+        if (cp < 0x80) {
+            return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z')
+                ? CharClass::Word
+                : CharClass::Separator;
+        }
+        if ((cp >= 0xC0 && cp <= 0x24F && cp != 0xD7 && cp != 0xF7)   // 拉丁字母扩展
+            || (cp >= 0x370 && cp <= 0x52F)                             // 希腊、西里尔字母
+            || (cp >= 0xFF10 && cp <= 0xFF19)                           // 全角数字
+            || (cp >= 0xFF21 && cp <= 0xFF3A)                           // 全角大写字母
+            || (cp >= 0xFF41 && cp <= 0xFF5A)                           // 全角小写字母
+        ) {
+            return CharClass::Word;
+        }
+        if ((cp >= 0x3040 && cp <= 0x30FF)      // 平假名、片假名
+            || (cp >= 0x3400 && cp <= 0x4DBF)   // 汉字扩展 A
+            || (cp >= 0x4E00 && cp <= 0x9FFF)   // 汉字
+            || (cp >= 0xAC00 && cp <= 0xD7AF)   // 谚文
+            || (cp >= 0xF900 && cp <= 0xFAFF)   // 兼容汉字
+            || (cp >= 0x20000 && cp <= 0x3FFFF) // 汉字扩展 B 及以后
+        ) {
+            return CharClass::Cjk;
+        }
+        return CharClass::Separator;
+    }
+
+    static void appendUtf8(std::string& str, char32_t cp) {
+        if (cp < 0x80) {
+            str += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            str += static_cast<char>(0xC0 | (cp >> 6));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            str += static_cast<char>(0xE0 | (cp >> 12));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            str += static_cast<char>(0xF0 | (cp >> 18));
+            str += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // 把词中的一个字符追加到 word: ASCII 与全角字母数字转为小写的半角, 其余原样保留
+    static void appendFolded(std::string& word, char32_t cp, std::string_view bytes) {
+        if (cp >= 0xFF10) {
+            cp -= 0xFEE0;
+        }
+        if (cp < 0x80) {
+            word += static_cast<char>(cp >= 'A' && cp <= 'Z' ? cp - 'A' + 'a' : cp);
+        } else {
+            word += bytes;
+        }
+    }
+};
+
+} // namespace HX::utils
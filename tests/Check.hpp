@@ -0,0 +1,48 @@
+#pragma once
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @brief 测试用的断言: 不受 NDEBUG 影响, 失败时打印位置与表达式并终止
+ */
+#define HX_CHECK(expr)                                                      \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n",               \
+                         __FILE__, __LINE__, #expr);                        \
+            std::abort();                                                   \
+        }                                                                   \
+    } while (false)
+
+/**
+ * @brief 断言 expr 抛出 Exception
+ */
+#define HX_CHECK_THROW(expr, Exception)                                     \
+    do {                                                                    \
+        bool _isThrown = false;                                             \
+        try {                                                               \
+            (void)(expr);                                                   \
+        } catch (Exception const&) {                                        \
+            _isThrown = true;                                               \
+        }                                                                   \
+        HX_CHECK(_isThrown && #expr " throws " #Exception);                 \
+    } while (false)
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dao/DenseIdMap.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+template <typename Map>
+bool isSame(Map const& mp, std::map<uint64_t, int> const& ref) {
+    if (mp.size() != ref.size() || mp.empty() != ref.empty()) {
+        return false;
+    }
+    std::vector<std::pair<uint64_t, int>> items;
+    for (auto const& [key, val] : mp) {
+        items.emplace_back(key, val);
+    }
+    return items == std::vector<std::pair<uint64_t, int>>(ref.begin(), ref.end());
+}
+
+// 随机增删改, 与 std::map 比对; Stride > 1 时所有主键模 Stride 同余
+template <std::size_t Stride>
+void testAgainstMap(uint64_t residue) {
+    dao::internal::DenseIdMap<uint64_t, int, Stride> mp;
+    std::map<uint64_t, int> ref;
+    std::mt19937 rng{static_cast<unsigned>(Stride)};
+    for (int step = 0; step < 5000; ++step) {
+        uint64_t key = (rng() % 300) * Stride + residue;
+        int val = static_cast<int>(rng() % 1000);
+        switch (rng() % 4) {
+        case 0: {
+            auto [it, ok] = mp.emplace(key, val);
+            auto [refIt, refOk] = ref.emplace(key, val);
+            HX_CHECK(ok == refOk && it->first == key && it->second == refIt->second);
+            break;
+        }
+        case 1: {
+            auto [it, ok] = mp.insert_or_assign(key, val);
+            auto [refIt, refOk] = ref.insert_or_assign(key, val);
+            HX_CHECK(ok == refOk && it->second == val);
+            break;
+        }
+        case 2:
+            HX_CHECK(mp.erase(key) == ref.erase(key));
+            break;
+        default:
+            mp[key] += val;
+            ref[key] += val;
+            break;
+        }
+        HX_CHECK(mp.contains(key) == ref.contains(key));
+    }
+    HX_CHECK(isSame(mp, ref));
+    for (uint64_t key = 0; key < 300 * Stride + Stride; ++key) {
+        auto it = mp.lower_bound(key);
+        auto refIt = ref.lower_bound(key);
+        HX_CHECK((it == mp.end()) == (refIt == ref.end()));
+        if (refIt != ref.end()) {
+            HX_CHECK(it->first == refIt->first && it->second == refIt->second);
+        }
+        auto found = mp.find(key);
+        HX_CHECK((found == mp.end()) == !ref.contains(key));
+        if (ref.contains(key)) {
+            HX_CHECK(mp.at(key) == ref.at(key));
+        } else {
+            HX_CHECK_THROW(mp.at(key), std::out_of_range);
+        }
+    }
+    // 按迭代器删除
+    while (!ref.empty()) {
+        mp.erase(mp.find(ref.begin()->first));
+        ref.erase(ref.begin());
+    }
+    HX_CHECK(isSame(mp, ref) && mp.begin() == mp.end());
+}
+
+void testStrideMismatch() {
+    dao::internal::DenseIdMap<uint64_t, int, 16> mp;
+    mp.emplace(3, 1);
+    HX_CHECK_THROW(mp.emplace(4, 1), std::invalid_argument);
+    HX_CHECK(!mp.contains(4) && mp.find(4) == mp.end() && mp.erase(4) == 0);
+    // 清空后余数可以重新确定
+    mp.clear();
+    mp.emplace(4, 2);
+    HX_CHECK(mp.at(4) == 2 && mp.size() == 1);
+}
+
+} // namespace
+
+int main() {
+    testAgainstMap<1>(0);
+    testAgainstMap<16>(3);
+    testStrideMismatch();
+    std::puts("DenseIdMapTest ok");
+}
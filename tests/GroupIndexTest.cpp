@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <utils/GroupIndex.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+using Ids = std::vector<uint64_t>;
+
+void testStatAndPaging() {
+    utils::GroupIndex<uint64_t> idx;
+    idx.add("Bob", 3, 30);
+    idx.add("Alice", 2, 20);
+    idx.add("Bob", 1, 10);
+    idx.add("Carol", 4, 40);
+    idx.add("", 5, 50);       // 空的键不分组
+    idx.add("Bob", 3, 30);    // 已在组内
+    HX_CHECK(idx.size() == 3);
+    auto bob = idx.stat("Bob");
+    HX_CHECK(bob && bob->cnt == 2 && bob->sum == 40);
+    HX_CHECK(!idx.stat("Dave"));
+
+    auto page = idx.groups("", 2);
+    HX_CHECK(page.size() == 2 && page[0].key == "Alice" && page[1].key == "Bob");
+    page = idx.groups(page.back().key, 2);
+    HX_CHECK(page.size() == 1 && page[0].key == "Carol" && page[0].sum == 40);
+    HX_CHECK(idx.groups("Carol", 2).empty());
+    HX_CHECK(idx.groups("", 0).empty());
+
+    HX_CHECK((idx.ids("Bob", 0, 10) == Ids{1, 3}));
+    HX_CHECK((idx.ids("Bob", 1, 10) == Ids{3}));
+    HX_CHECK((idx.ids("Bob", 0, 1) == Ids{1}));
+    HX_CHECK(idx.ids("Dave", 0, 10).empty());
+}
+
+void testErase() {
+    utils::GroupIndex<uint64_t> idx;
+    idx.add("Bob", 1, 10);
+    idx.add("Bob", 2, 20);
+    idx.erase("Bob", 9, 90);  // 不在组内
+    idx.erase("Dave", 1, 10);
+    HX_CHECK(idx.stat("Bob")->sum == 30);
+    idx.erase("Bob", 1, 10);
+    HX_CHECK(idx.stat("Bob")->cnt == 1 && idx.stat("Bob")->sum == 20);
+    idx.erase("Bob", 2, 20);
+    HX_CHECK(!idx.stat("Bob") && idx.size() == 0);
+}
+
+void testBulk() {
+    utils::GroupIndex<uint64_t> bulk;
+    utils::GroupIndex<uint64_t> inc;
+    bulk.beginBulk();
+    for (uint64_t id = 100; id > 0; --id) {
+        auto key = "k" + std::to_string(id % 7);
+        bulk.add(key, id, id);
+        // 同一行的重复值是连续送入的
+        bulk.add(key, id, id);
+        inc.add(key, id, id);
+    }
+    bulk.endBulk();
+    HX_CHECK(bulk.size() == inc.size());
+    for (auto const& g : inc.groups("", 100)) {
+        auto s = bulk.stat(g.key);
+        HX_CHECK(s && s->cnt == g.cnt && s->sum == g.sum);
+        HX_CHECK(bulk.ids(g.key, 0, 100) == inc.ids(g.key, 0, 100));
+    }
+    HX_CHECK((bulk.ids("k0", 0, 3) == Ids{7, 14, 21}));
+}
+
+} // namespace
+
+int main() {
+    testStatAndPaging();
+    testErase();
+    testBulk();
+    std::puts("GroupIndexTest ok");
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <utils/OrderStatIndex.hpp>
+#include <dao/MemoryIndex.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+using Ids = std::vector<uint64_t>;
+
+// 以 std::set 为对照, 块很小以便频繁分裂与清空
+void testAgainstSet() {
+    utils::OrderStatIndex<int, uint64_t, 4> idx;
+    std::set<std::pair<int, uint64_t>> ref;
+    std::mt19937 rng{7};
+    for (int step = 0; step < 4000; ++step) {
+        int key = static_cast<int>(rng() % 50);
+        uint64_t id = rng() % 200 + 1;
+        if (rng() % 3) {
+            if (ref.emplace(key, id).second) {
+                idx.insert(key, id);
+            }
+        } else {
+            ref.erase({key, id});
+            idx.erase(key, id);
+        }
+        HX_CHECK(idx.size() == ref.size());
+    }
+    Ids asc;
+    for (auto const& [key, id] : ref) {
+        asc.push_back(id);
+    }
+    Ids desc(asc.rbegin(), asc.rend());
+    for (std::size_t rank = 0; rank <= ref.size(); rank += 3) {
+        auto cnt = std::min<std::size_t>(7, ref.size() - rank);
+        HX_CHECK(idx.slice(rank, 7, false) == Ids(asc.begin() + rank, asc.begin() + rank + cnt));
+        HX_CHECK(idx.slice(rank, 7, true) == Ids(desc.begin() + rank, desc.begin() + rank + cnt));
+    }
+    HX_CHECK(idx.slice(ref.size(), 7, false).empty());
+    HX_CHECK(idx.slice(0, 0, false).empty());
+    for (int key = -1; key <= 50; ++key) {
+        for (uint64_t id : {0, 100, 201}) {
+            auto expected = static_cast<std::size_t>(std::distance(
+                ref.begin(), ref.lower_bound({key, id})));
+            HX_CHECK(idx.rankOf(key, id) == expected);
+        }
+    }
+}
+
+void testBulk() {
+    utils::OrderStatIndex<std::string, uint64_t, 4> idx;
+    idx.beginBulk();
+    for (uint64_t id = 1; id <= 20; ++id) {
+        idx.insert(std::string(1, static_cast<char>('a' + id % 5)), id);
+    }
+    idx.erase("a", 5);
+    idx.endBulk();
+    HX_CHECK(idx.size() == 19);
+    HX_CHECK((idx.slice(0, 4, false) == Ids{10, 15, 20, 1}));
+    HX_CHECK(idx.rankOf("b", 0) == 3);
+    // 批量加载后仍可增量修改
+    idx.insert("a", 0);
+    HX_CHECK((idx.slice(0, 2, false) == Ids{0, 10}));
+    HX_CHECK((idx.slice(0, 2, true) == Ids{19, 14}));
+}
+
+struct Row {
+    db::PrimaryKey<uint64_t> id;
+    std::string name;
+    uint64_t len;
+
+    using Indexes = db::IndexList<
+        db::SortIndex<&Row::id>,
+        db::SortIndex<&Row::name>,
+        db::SortIndex<&Row::len>
+    >;
+};
+
+using RowIndexSet = dao::internal::IndexSet<Row, uint64_t, db::GetIndexList<Row>>;
+
+// IndexSet::sorted 的游标: 升序从 lower + 1 开始, 降序从 size - lower 开始;
+// 游标行已被删除时按给出的键定位
+void testSortedCursor() {
+    RowIndexSet set;
+    std::vector<Row> rows;
+    for (uint64_t id = 1; id <= 9; ++id) {
+        // 名字与 id 顺序相反, 时长有重复
+        rows.push_back(Row{{id}, "N" + std::to_string(9 - id), 100 + id / 3});
+        set.insert(rows.back(), id);
+    }
+    auto const& r4 = rows[3]; // id 4, "N5", 101
+    HX_CHECK((set.sorted<&Row::name>(nullptr, 0, std::nullopt, 0, 3, false) == Ids{9, 8, 7}));
+    HX_CHECK((set.sorted<&Row::name>(nullptr, 0, std::nullopt, 0, 3, true) == Ids{1, 2, 3}));
+    HX_CHECK((set.sorted<&Row::name>(&r4, 4, std::nullopt, 0, 2, false) == Ids{3, 2}));
+    HX_CHECK((set.sorted<&Row::name>(&r4, 4, std::nullopt, 0, 2, true) == Ids{5, 6}));
+    HX_CHECK((set.sorted<&Row::name>(&r4, 4, std::nullopt, 1, 2, false) == Ids{2, 1}));
+    HX_CHECK(set.sorted<&Row::name>(&r4, 4, std::nullopt, 100, 2, false).empty());
+    // 键相同 (时长 101: id 3, 4, 5) 时按主键排序
+    HX_CHECK((set.sorted<&Row::len>(&r4, 4, std::nullopt, 0, 2, false) == Ids{5, 6}));
+    HX_CHECK((set.sorted<&Row::len>(&r4, 4, std::nullopt, 0, 2, true) == Ids{3, 2}));
+    // 首行与末行作游标
+    HX_CHECK(set.sorted<&Row::id>(&rows[8], 9, std::nullopt, 0, 2, false).empty());
+    HX_CHECK(set.sorted<&Row::id>(&rows[0], 1, std::nullopt, 0, 2, true).empty());
+
+    set.erase(r4, 4);
+    HX_CHECK((set.sorted<&Row::name>(nullptr, 4, "n5", 0, 2, false) == Ids{3, 2}));
+    HX_CHECK((set.sorted<&Row::name>(nullptr, 4, "N5", 0, 2, true) == Ids{5, 6}));
+    HX_CHECK((set.sorted<&Row::len>(nullptr, 4, "101", 0, 2, false) == Ids{5, 6}));
+    HX_CHECK((set.sorted<&Row::len>(nullptr, 4, "101", 0, 2, true) == Ids{3, 2}));
+    HX_CHECK_THROW(set.sorted<&Row::len>(nullptr, 4, "x", 0, 2, false), std::runtime_error);
+    HX_CHECK_THROW(set.sorted<&Row::name>(nullptr, 4, std::nullopt, 0, 2, false), std::out_of_range);
+    // 按主键排序时键即主键
+    HX_CHECK((set.sorted<&Row::id>(nullptr, 4, std::nullopt, 0, 2, false) == Ids{5, 6}));
+    HX_CHECK((set.sorted<&Row::id>(nullptr, 4, std::nullopt, 0, 2, true) == Ids{3, 2}));
+}
+
+} // namespace
+
+int main() {
+    testAgainstSet();
+    testBulk();
+    testSortedCursor();
+    std::puts("OrderStatIndexTest ok");
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dao/PersistentIdMap.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+template <typename Map>
+bool isSame(Map const& mp, std::map<uint64_t, int> const& ref) {
+    if (mp.size() != ref.size() || mp.empty() != ref.empty()) {
+        return false;
+    }
+    std::vector<std::pair<uint64_t, int>> items;
+    for (auto const& [key, val] : mp) {
+        items.emplace_back(key, val);
+    }
+    return items == std::vector<std::pair<uint64_t, int>>(ref.begin(), ref.end());
+}
+
+// 随机增删改并不时复制出旧版本; 结束时每个旧版本都应保持复制时的内容
+template <std::size_t Stride>
+void testAgainstMap(uint64_t residue, uint64_t keyRange) {
+    using Map = dao::internal::PersistentIdMap<uint64_t, int, Stride>;
+    Map mp;
+    std::map<uint64_t, int> ref;
+    std::vector<std::pair<Map, std::map<uint64_t, int>>> versions;
+    std::mt19937_64 rng{Stride * 31 + keyRange};
+    for (int step = 0; step < 6000; ++step) {
+        uint64_t key = (rng() % keyRange) * Stride + residue;
+        int val = static_cast<int>(rng() % 1000);
+        switch (rng() % 3) {
+        case 0: {
+            auto [it, ok] = mp.emplace(key, val);
+            auto [refIt, refOk] = ref.emplace(key, val);
+            HX_CHECK(ok == refOk && it->first == key && it->second == refIt->second);
+            break;
+        }
+        case 1: {
+            auto [it, ok] = mp.insert_or_assign(key, val);
+            auto [refIt, refOk] = ref.insert_or_assign(key, val);
+            HX_CHECK(ok == refOk && it->second == val);
+            break;
+        }
+        default:
+            HX_CHECK(mp.erase(key) == ref.erase(key));
+            break;
+        }
+        HX_CHECK(mp.contains(key) == ref.contains(key));
+        if (step % 500 == 0) {
+            // 交替使用拷贝构造与拷贝赋值
+            if (step % 1000 == 0) {
+                versions.emplace_back(mp, ref);
+            } else {
+                Map copy;
+                copy = mp;
+                versions.emplace_back(std::move(copy), ref);
+            }
+        }
+    }
+    HX_CHECK(isSame(mp, ref));
+    for (auto const& [old, oldRef] : versions) {
+        HX_CHECK(isSame(old, oldRef));
+    }
+    for (std::size_t i = 0; i < 2000; ++i) {
+        uint64_t key = rng() % (keyRange * Stride + Stride);
+        auto it = mp.lower_bound(key);
+        auto refIt = ref.lower_bound(key);
+        HX_CHECK((it == mp.end()) == (refIt == ref.end()));
+        if (refIt != ref.end()) {
+            HX_CHECK(it->first == refIt->first && it->second == refIt->second);
+        }
+        HX_CHECK((mp.find(key) == mp.end()) == !ref.contains(key));
+        if (ref.contains(key)) {
+            HX_CHECK(mp.at(key) == ref.at(key));
+        } else {
+            HX_CHECK_THROW(mp.at(key), std::out_of_range);
+        }
+    }
+}
+
+// 修改副本不影响原对象, 修改原对象也不影响副本
+void testCopyIsolation() {
+    dao::internal::PersistentIdMap<uint64_t, int> a;
+    for (uint64_t key = 0; key < 1000; ++key) {
+        a.emplace(key, 1);
+    }
+    auto b = a;
+    b.insert_or_assign(10, 2);
+    b.erase(20);
+    a.insert_or_assign(30, 3);
+    a.emplace(5000, 4);
+    HX_CHECK(a.at(10) == 1 && a.contains(20) && a.at(30) == 3 && a.size() == 1001);
+    HX_CHECK(b.at(10) == 2 && !b.contains(20) && b.at(30) == 1 && b.size() == 999);
+    auto c = std::move(b);
+    HX_CHECK(c.size() == 999 && c.at(10) == 2);
+    c.clear();
+    HX_CHECK(c.empty() && c.begin() == c.end() && a.size() == 1001);
+}
+
+} // namespace
+
+int main() {
+    testAgainstMap<1>(0, 300);
+    // 稀疏的主键, 树会长高
+    testAgainstMap<1>(0, uint64_t{1} << 40);
+    testAgainstMap<16>(3, 5000);
+    testCopyIsolation();
+    std::puts("PersistentIdMapTest ok");
+}
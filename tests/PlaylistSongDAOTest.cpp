@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 需要先于各 DAO 引入
+#include <db/SQLiteSqlTypes.hpp>
+#include <dao/PlaylistSongDAO.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+using Model = std::map<uint64_t, std::vector<uint64_t>>;
+
+std::string tmpPath(std::string const& name) {
+    auto path = (std::filesystem::temp_directory_path() / ("HXPlaylistSongDAOTest." + name)).string();
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    return path;
+}
+
+// 数据库中歌单的歌曲顺序 (按 positionKey 升序); 同时检查排序键互不相同
+std::vector<uint64_t> dbOrder(std::string const& path, uint64_t playlistId) {
+    std::vector<PlaylistSongDO> rows;
+    for (auto& row : db::SQLiteDB{path}.queryAll<PlaylistSongDO>()) {
+        if (row.playlistId == playlistId) {
+            rows.push_back(std::move(row));
+        }
+    }
+    std::ranges::sort(rows, {}, &PlaylistSongDO::positionKey);
+    std::vector<uint64_t> res;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        HX_CHECK(i == 0 || rows[i - 1].positionKey < rows[i].positionKey);
+        res.push_back(rows[i].musicId);
+    }
+    return res;
+}
+
+void checkModel(PlaylistSongDAO const& dao, Model const& model) {
+    for (auto const& [playlistId, list] : model) {
+        HX_CHECK(dao.songIdList(playlistId) == list);
+        HX_CHECK(dao.songCnt(playlistId) == list.size());
+        for (auto musicId : list) {
+            HX_CHECK(dao.contains(playlistId, musicId));
+        }
+    }
+}
+
+void checkDb(PlaylistSongDAO& dao, std::string const& path, Model const& model) {
+    dao.flush();
+    for (auto const& [playlistId, list] : model) {
+        HX_CHECK(dbOrder(path, playlistId) == list);
+    }
+}
+
+// 随机的 追加/删除/移动 与 std::vector 模型对照, 并从数据库重新加载
+void testRandomOps(dao::WriteMode mode, std::string const& name) {
+    auto path = tmpPath(name + ".db");
+    Model model;
+    std::mt19937 rng{42};
+    {
+        PlaylistSongDAO dao{db::SQLiteDB{path}, mode};
+        for (int step = 0; step < 3000; ++step) {
+            uint64_t playlistId = rng() % 3 + 1;
+            auto& list = model[playlistId];
+            switch (rng() % 4) {
+                case 0:
+                case 1: {
+                    uint64_t musicId = rng() % 80 + 1;
+                    bool isNew = std::ranges::find(list, musicId) == list.end();
+                    HX_CHECK(dao.append(playlistId, musicId) == isNew);
+                    if (isNew) {
+                        list.push_back(musicId);
+                    }
+                    break;
+                }
+                case 2:
+                    if (!list.empty()) {
+                        auto idx = rng() % list.size();
+                        dao.removeAt(playlistId, idx);
+                        list.erase(list.begin() + static_cast<std::ptrdiff_t>(idx));
+                    }
+                    break;
+                default:
+                    if (!list.empty()) {
+                        auto from = rng() % list.size(), to = rng() % list.size();
+                        dao.move(playlistId, from, to);
+                        auto musicId = list[from];
+                        list.erase(list.begin() + static_cast<std::ptrdiff_t>(from));
+                        list.insert(list.begin() + static_cast<std::ptrdiff_t>(to), musicId);
+                    }
+                    break;
+            }
+            if (step % 500 == 0) {
+                checkModel(dao, model);
+            }
+        }
+        checkModel(dao, model);
+        HX_CHECK_THROW(dao.removeAt(1, model[1].size()), std::out_of_range);
+        HX_CHECK_THROW(dao.move(1, 0, model[1].size()), std::out_of_range);
+        checkDb(dao, path, model);
+    }
+    PlaylistSongDAO dao{db::SQLiteDB{path}, mode};
+    checkModel(dao, model);
+}
+
+// 反复移动到同一个空隙, 耗尽排序键的浮点精度后重排整个歌单
+void testRenumber() {
+    auto path = tmpPath("renumber.db");
+    std::vector<uint64_t> list;
+    {
+        PlaylistSongDAO dao{db::SQLiteDB{path}};
+        for (uint64_t musicId = 1; musicId <= 5; ++musicId) {
+            dao.append(7, musicId);
+            list.push_back(musicId);
+        }
+        // 每次把末尾的歌曲移动到第 1 个位置, 第 0 与第 1 首之间的空隙每次减半
+        for (int i = 0; i < 200; ++i) {
+            dao.move(7, list.size() - 1, 1);
+            list.insert(list.begin() + 1, list.back());
+            list.pop_back();
+            HX_CHECK(dao.songIdList(7) == list);
+        }
+        checkDb(dao, path, {{7, list}});
+        // 重排后的排序键为 1..n
+        auto keys = dao.lockSelect([](PlaylistSongDAO::MapType const& mp) {
+            std::vector<double> res;
+            for (auto const& [id, row] : mp) {
+                res.push_back(row.positionKey);
+            }
+            return res;
+        });
+        std::ranges::sort(keys);
+        HX_CHECK(keys.front() >= 1.0 && keys.back() <= 5.0);
+    }
+    PlaylistSongDAO dao{db::SQLiteDB{path}};
+    HX_CHECK(dao.songIdList(7) == list);
+}
+
+// 排序键重复的行在加载时按行 id 重排, 并写回数据库
+void testDuplicateKeyRepair() {
+    auto path = tmpPath("duplicate.db");
+    {
+        PlaylistSongDAO dao{db::SQLiteDB{path}};
+        for (uint64_t musicId : {10, 20, 30, 40}) {
+            dao.append(3, musicId);
+        }
+        dao.append(4, 50);
+        dao.append(4, 60);
+    }
+    {
+        db::SQLiteDB db{path};
+        db.sql<"UPDATE PlaylistSongDO SET positionKey = 2 WHERE playlistId = 3 AND musicId <> 10">()
+          .execOnThrow();
+    }
+    std::vector<uint64_t> const expected{10, 20, 30, 40};
+    {
+        PlaylistSongDAO dao{db::SQLiteDB{path}};
+        HX_CHECK(dao.songIdList(3) == expected);
+        HX_CHECK((dao.songIdList(4) == std::vector<uint64_t>{50, 60}));
+        checkDb(dao, path, {{3, expected}});
+        // 重排后照常移动
+        dao.move(3, 3, 1);
+        HX_CHECK((dao.songIdList(3) == std::vector<uint64_t>{10, 40, 20, 30}));
+    }
+    PlaylistSongDAO dao{db::SQLiteDB{path}};
+    HX_CHECK((dao.songIdList(3) == std::vector<uint64_t>{10, 40, 20, 30}));
+}
+
+// 事务中抛出异常时, 经由 recordUndo 登记的逆操作把歌单整体恢复
+void testUndo() {
+    auto path = tmpPath("undo.db");
+    Model model{{1, {1, 2, 3, 4}}, {2, {5, 6}}};
+    {
+        PlaylistSongDAO dao{db::SQLiteDB{path}, dao::WriteMode::WriteBehind};
+        for (auto const& [playlistId, list] : model) {
+            dao.replaceOrder(playlistId, list);
+        }
+        HX_CHECK_THROW(dao::UndoLog::run([&] {
+            dao.append(1, 9);
+            dao.move(1, 0, 3);
+            dao.removeAt(1, 1);
+            dao.replaceOrder(2, {6, 7, 8, 6});
+            dao.delPlaylist(1);
+            dao.append(3, 1);
+            throw std::runtime_error{"boom"};
+        }), std::runtime_error);
+        checkModel(dao, model);
+        HX_CHECK(dao.songCnt(3) == 0);
+        checkDb(dao, path, model);
+
+        // 重复的 id 只保留第一个
+        dao.replaceOrder(2, {6, 7, 8, 6});
+        model[2] = {6, 7, 8};
+        checkModel(dao, model);
+    }
+    PlaylistSongDAO dao{db::SQLiteDB{path}};
+    checkModel(dao, model);
+    HX_CHECK(dao.songCnt(3) == 0);
+}
+
+} // namespace
+
+int main() {
+    testRandomOps(dao::WriteMode::WriteThrough, "randomThrough");
+    testRandomOps(dao::WriteMode::WriteBehind, "randomBehind");
+    testRenumber();
+    testDuplicateKeyRepair();
+    testUndo();
+}
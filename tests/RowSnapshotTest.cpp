@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <db/RowSnapshot.hpp>
+#include <db/InternedColumn.hpp>
+#include <dao/ShardedInMemoryDAO.hpp>
+#include <dao/ThreadSafeInMemoryDAO.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+struct SnapRow {
+    db::PrimaryKey<uint64_t> id;
+    std::string name;
+    int32_t score;
+    double ratio;
+    utils::Symbol album;
+    utils::SymbolList artists;
+    utils::CompactPath path;
+};
+
+// 表结构不同 (少一列) 的同名表
+namespace other {
+
+struct SnapRow {
+    db::PrimaryKey<uint64_t> id;
+    std::string name;
+};
+
+} // namespace other
+
+bool isSame(SnapRow const& a, SnapRow const& b) {
+    return a.id.val == b.id.val && a.name == b.name && a.score == b.score && a.ratio == b.ratio
+        && a.album == b.album && a.artists == b.artists && a.path == b.path;
+}
+
+SnapRow makeRow(uint64_t id) {
+    return {
+        {id},
+        "name " + std::to_string(id) + std::string(id % 5, '\0'),
+        -static_cast<int32_t>(id) * 1000,
+        static_cast<double>(id) / 3,
+        utils::Symbol{"album" + std::to_string(id % 3)},
+        utils::SymbolList{std::vector<std::string>{"a", "歌手" + std::to_string(id % 4)}},
+        utils::CompactPath{"dir" + std::to_string(id % 2) + "/" + std::to_string(id) + ".flac"},
+    };
+}
+
+std::string tmpPath(std::string const& name) {
+    auto path = (std::filesystem::temp_directory_path() / ("HXRowSnapshotTest." + name)).string();
+    for (auto suffix : {"", "-wal", "-shm", ".SnapRow.snap"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    return path;
+}
+
+void testRoundTrip() {
+    auto path = tmpPath("roundTrip.snap");
+    std::map<uint64_t, SnapRow> rows;
+    for (uint64_t id = 1; id <= 3000; id += 1 + id % 3) {
+        rows.emplace(id, makeRow(id));
+    }
+    db::writeRowSnapshot<SnapRow>(path, 42, rows);
+    HX_CHECK(!std::filesystem::exists(path + ".tmp"));
+    db::RowSnapshot<SnapRow> snap{path};
+    HX_CHECK(snap.changeSeq() == 42 && snap.size() == rows.size());
+    HX_CHECK(snap.contains(1) && !snap.contains(2) && snap.contains(3) && !snap.contains(0) && !snap.contains(100000));
+    auto it = rows.begin();
+    snap.forEach([&](SnapRow&& row) {
+        HX_CHECK(it != rows.end() && isSame(row, it->second));
+        ++it;
+    });
+    HX_CHECK(it == rows.end());
+
+    std::map<uint64_t, SnapRow> empty;
+    db::writeRowSnapshot<SnapRow>(path, 0, empty);
+    db::RowSnapshot<SnapRow> emptySnap{path};
+    HX_CHECK(emptySnap.size() == 0 && !emptySnap.contains(1));
+    std::filesystem::remove(path);
+}
+
+// 损坏、截断、版本或表结构不符的快照都应被拒绝
+void testRejectBadFile() {
+    auto path = tmpPath("bad.snap");
+    std::map<uint64_t, SnapRow> rows{{1, makeRow(1)}, {2, makeRow(2)}};
+    auto rewrite = [&] {
+        db::writeRowSnapshot<SnapRow>(path, 1, rows);
+    };
+    auto patch = [&](std::streamoff pos, char c) {
+        std::fstream fs{path, std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(pos);
+        fs.put(c);
+    };
+    rewrite();
+    patch(80, '\x7f');
+    HX_CHECK_THROW(db::RowSnapshot<SnapRow>{path}, std::runtime_error);
+    rewrite();
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    HX_CHECK_THROW(db::RowSnapshot<SnapRow>{path}, std::runtime_error);
+    rewrite();
+    patch(8, '\x7f');
+    HX_CHECK_THROW(db::RowSnapshot<SnapRow>{path}, std::runtime_error);
+    rewrite();
+    HX_CHECK_THROW(db::RowSnapshot<other::SnapRow>{path}, std::runtime_error);
+    std::filesystem::resize_file(path, 10);
+    HX_CHECK_THROW(db::RowSnapshot<SnapRow>{path}, std::runtime_error);
+    HX_CHECK_THROW(db::RowSnapshot<SnapRow>{path + ".missing"}, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+template <typename DAO>
+void checkDAO(DAO const& dao, std::string const& dbPath) {
+    auto rows = db::SQLiteDB{dbPath}.queryAll<SnapRow>();
+    std::size_t n = 0;
+    dao.lockSelect([&](auto const& mp) {
+        for (auto const& row : rows) {
+            auto it = mp.find(row.id.val);
+            HX_CHECK(it != mp.end() && isSame((*it).second, row));
+        }
+        for (auto it = mp.begin(); it != mp.end(); ++it) {
+            ++n;
+        }
+    });
+    HX_CHECK(n == rows.size());
+}
+
+// DAO 析构时写快照, 再次启动时从快照加载, 并补上快照之后在数据库中发生的修改
+template <typename DAO>
+void testDAORoundTrip(std::string const& name) {
+    auto dbPath = tmpPath(name + ".db");
+    auto snapPath = dbPath + ".SnapRow.snap";
+    dao::SnapshotOptions opts{true, std::chrono::milliseconds{0}};
+    for (auto mode : {dao::WriteMode::WriteThrough, dao::WriteMode::WriteBehind}) {
+        tmpPath(name + ".db");
+        {
+            DAO dao{db::SQLiteDB{dbPath}, mode, opts};
+            for (uint64_t i = 1; i <= 500; ++i) {
+                auto row = makeRow(i);
+                row.id.val = 0;
+                dao.add(std::move(row));
+            }
+            dao.del(5);
+            dao.updateBy(7, db::FieldPair<&SnapRow::name>{std::string{"seven"}});
+        }
+        HX_CHECK(std::filesystem::exists(snapPath));
+        HX_CHECK(db::RowSnapshot<SnapRow>{snapPath}.size() == 499);
+        {
+            DAO dao{db::SQLiteDB{dbPath}, mode, opts};
+            checkDAO(dao, dbPath);
+            HX_CHECK(dao.at(7).name == "seven");
+        }
+        // 绕过 DAO 直接修改数据库
+        {
+            db::SQLiteDB db{dbPath};
+            db.sql<"UPDATE SnapRow SET name = 'ext' WHERE id = 10">().execOnThrow();
+            db.sql<"DELETE FROM SnapRow WHERE id = 11">().execOnThrow();
+        }
+        {
+            DAO dao{db::SQLiteDB{dbPath}, mode, opts};
+            checkDAO(dao, dbPath);
+            HX_CHECK(dao.at(10).name == "ext");
+        }
+        // 快照损坏时退回全量加载
+        {
+            db::SQLiteDB{dbPath}.sql<"UPDATE SnapRow SET score = 1 WHERE id = 12">().execOnThrow();
+            std::fstream fs{snapPath, std::ios::in | std::ios::out | std::ios::binary};
+            fs.seekp(100);
+            fs.put('\x7f');
+        }
+        {
+            DAO dao{db::SQLiteDB{dbPath}, mode, opts};
+            checkDAO(dao, dbPath);
+            HX_CHECK(dao.at(12).score == 1);
+        }
+    }
+    tmpPath(name + ".db");
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testRejectBadFile();
+    testDAORoundTrip<dao::ShardedInMemoryDAO<SnapRow>>("sharded");
+    testDAORoundTrip<dao::ThreadSafeInMemoryDAO<SnapRow>>("threadSafe");
+    std::puts("RowSnapshotTest ok");
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <utils/StringPool.hpp>
+#include <db/InternedColumn.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+void testIntern() {
+    utils::StringPool pool;
+    HX_CHECK(pool.size() == 1 && pool.view(0).empty());
+    auto a = pool.intern("Alice");
+    auto b = pool.intern("Bob");
+    HX_CHECK(a != b && a != 0 && b != 0);
+    HX_CHECK(pool.intern(std::string{"Alice"}) == a);
+    HX_CHECK(pool.intern({}) == 0);
+    HX_CHECK(pool.find("Bob") == b && pool.find("Carol") == -1);
+    HX_CHECK(pool.size() == 3 && pool.byteSize() == 8);
+    HX_CHECK(pool.view(a) == "Alice" && pool.view(b) == "Bob");
+}
+
+// 跨越 id 块与 arena 块, 以及单独申请的长字符串; 早先取得的内容不失效
+void testViewsStayValid() {
+    utils::StringPool pool;
+    std::vector<std::string_view> views;
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 10000; ++i) {
+        auto str = "s" + std::to_string(i) + std::string(static_cast<std::size_t>(i % 50), 'x');
+        ids.push_back(pool.intern(str));
+        views.push_back(pool.view(ids.back()));
+    }
+    std::string longStr(100 * 1024, 'L');
+    auto longId = pool.intern(longStr);
+    HX_CHECK(pool.view(longId) == longStr);
+    for (int i = 0; i < 10000; ++i) {
+        auto str = "s" + std::to_string(i) + std::string(static_cast<std::size_t>(i % 50), 'x');
+        HX_CHECK(views[static_cast<std::size_t>(i)] == str);
+        HX_CHECK(pool.view(ids[static_cast<std::size_t>(i)]).data() == views[static_cast<std::size_t>(i)].data());
+        HX_CHECK(pool.intern(str) == ids[static_cast<std::size_t>(i)]);
+    }
+}
+
+// 多线程同时驻留相同的字符串, 得到的 id 一致
+void testConcurrentIntern() {
+    utils::StringPool pool;
+    constexpr int ThreadCnt = 8;
+    constexpr int StrCnt = 2000;
+    std::vector<std::vector<uint32_t>> ids(ThreadCnt);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCnt; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < StrCnt; ++i) {
+                // 各线程以不同的顺序驻留
+                int k = (i * 7 + t * 131) % StrCnt;
+                auto id = pool.intern("k" + std::to_string(k));
+                HX_CHECK(pool.view(id) == "k" + std::to_string(k));
+                ids[static_cast<std::size_t>(t)].push_back(id);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    HX_CHECK(pool.size() == StrCnt + 1);
+    for (int i = 0; i < StrCnt; ++i) {
+        auto id = pool.find("k" + std::to_string(i));
+        HX_CHECK(id > 0 && pool.view(static_cast<uint32_t>(id)) == "k" + std::to_string(i));
+    }
+}
+
+void testSymbol() {
+    utils::Symbol a{"Alice"};
+    utils::Symbol b{std::string{"Alice"}};
+    utils::Symbol empty;
+    HX_CHECK(a == b && a.id() == b.id() && a == "Alice" && a == std::string_view{"Alice"});
+    HX_CHECK(!(a == "Bob") && empty.empty() && empty == "" && utils::Symbol{""}.empty());
+    HX_CHECK(sizeof(utils::Symbol) == 4);
+
+    utils::SymbolList list{std::vector<std::string>{"Alice", "Bob", "Alice"}};
+    HX_CHECK(list.size() == 3 && list[0] == list[2] && list[1] == "Bob");
+    HX_CHECK((static_cast<std::vector<std::string>>(list) == std::vector<std::string>{"Alice", "Bob", "Alice"}));
+}
+
+// 与 std::vector<std::string> 相同的 BLOB 格式, 以及迁移前的 JSON 文本
+void testSymbolListCodec() {
+    std::vector<std::string> strs{"Alice", "", "中文歌手"};
+    utils::SymbolList list{strs};
+    auto bytes = db::BlobCodec<utils::SymbolList>::encode(list);
+    HX_CHECK(bytes == db::BlobCodec<std::vector<std::string>>::encode(strs));
+    HX_CHECK(db::BlobCodec<utils::SymbolList>::decode(bytes) == list);
+    HX_CHECK(db::BlobCodec<utils::SymbolList>::decode({}).empty());
+    HX_CHECK_THROW(db::BlobCodec<utils::SymbolList>::decode(std::string_view{bytes}.substr(0, bytes.size() - 1)),
+                   std::runtime_error);
+    HX_CHECK(db::SQLiteSqlType<utils::SymbolList>::columnTypeFromText(R"(["Alice","","中文歌手"])") == list);
+}
+
+void testCompactPath() {
+    utils::CompactPath a{"歌手/专辑/01.flac"};
+    utils::CompactPath b{std::string{"歌手/专辑/02.flac"}};
+    utils::CompactPath root{"song.mp3"};
+    HX_CHECK(a.dir() == "歌手/专辑/" && a.file() == "01.flac" && a.str() == "歌手/专辑/01.flac");
+    HX_CHECK(a.dir().data() == b.dir().data());
+    HX_CHECK(root.dir().empty() && root.file() == "song.mp3" && root.str() == "song.mp3");
+    HX_CHECK(a == "歌手/专辑/01.flac" && !(a == "歌手/专辑/02.flac") && !(a == b));
+    HX_CHECK(a == utils::CompactPath{"歌手/专辑/01.flac"});
+    // 与完整路径字符串的哈希一致, 才能以 std::string_view 异构查找
+    for (std::string_view path : {"歌手/专辑/01.flac", "song.mp3", "a/", "/abs/x"}) {
+        HX_CHECK(utils::CompactPath::hashOf(utils::CompactPath{path}) == utils::CompactPath::hashOf(path));
+        HX_CHECK(db::SQLiteSqlType<utils::CompactPath>::columnType(
+            db::SQLiteSqlType<utils::CompactPath>::bind(utils::CompactPath{path})) == path);
+    }
+}
+
+} // namespace
+
+int main() {
+    testIntern();
+    testViewsStayValid();
+    testConcurrentIntern();
+    testSymbol();
+    testSymbolListCodec();
+    testCompactPath();
+    std::puts("StringPoolTest ok");
+}
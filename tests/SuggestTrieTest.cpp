@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <utils/SuggestTrie.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+std::vector<std::string> textsOf(std::vector<utils::Suggestion> const& list) {
+    std::vector<std::string> res;
+    for (auto const& s : list) {
+        res.push_back(s.text);
+    }
+    return res;
+}
+
+using Texts = std::vector<std::string>;
+
+void testRankByWeight() {
+    utils::SuggestTrie<> trie;
+    trie.add(0, "Sunny Day", 3);
+    trie.add(0, "Sunset", 1);
+    trie.add(1, "Sun", 2);
+    HX_CHECK((textsOf(trie.suggest("sun", 10)) == Texts{"Sunny Day", "Sun", "Sunset"}));
+    HX_CHECK((textsOf(trie.suggest("SUN", 2)) == Texts{"Sunny Day", "Sun"}));
+    auto top = trie.suggest("sun", 1);
+    HX_CHECK(top.size() == 1 && top[0].field == 0 && top[0].cnt == 3);
+    HX_CHECK(trie.suggest("moon", 10).empty());
+    HX_CHECK(trie.suggest("", 10).empty());
+    // 末尾的空格表示词已输入完整
+    HX_CHECK((textsOf(trie.suggest("sunny ", 10)) == Texts{"Sunny Day"}));
+}
+
+void testAlternativeKeys() {
+    utils::SuggestTrie<> trie;
+    trie.add(0, "Sunny Day", 1);
+    trie.add(0, "さくら", 1);
+    trie.add(0, "サクラ", 2);
+    // 从第二个词起的后缀
+    HX_CHECK((textsOf(trie.suggest("da", 10)) == Texts{"Sunny Day"}));
+    // 片假名按平假名处理, 也可用罗马字输入
+    HX_CHECK((textsOf(trie.suggest("さく", 10)) == Texts{"サクラ", "さくら"}));
+    HX_CHECK((textsOf(trie.suggest("saku", 10)) == Texts{"サクラ", "さくら"}));
+}
+
+void testWeightDecrease() {
+    utils::SuggestTrie<2> trie;
+    trie.add(0, "aa", 5);
+    trie.add(0, "ab", 4);
+    trie.add(0, "ac", 3);
+    HX_CHECK((textsOf(trie.suggest("a", 10)) == Texts{"aa", "ab"}));
+    // 降权后名额已满的节点要由子节点重算
+    trie.add(0, "aa", -4);
+    HX_CHECK((textsOf(trie.suggest("a", 10)) == Texts{"ab", "ac"}));
+    trie.add(0, "ab", -100);
+    HX_CHECK((textsOf(trie.suggest("a", 10)) == Texts{"ac", "aa"}));
+    HX_CHECK(trie.suggest("ab", 10).empty());
+    // 不存在的条目不能被减出来
+    trie.add(0, "zz", -1);
+    HX_CHECK(trie.suggest("z", 10).empty());
+}
+
+// 随机增减权重, 与暴力结果比对; 增量维护与批量建树的结果也应一致
+void testAgainstBruteForce() {
+    constexpr std::size_t TopK = 5;
+    std::mt19937 rng{42};
+    std::vector<std::string> words{"a", "ab", "abc", "b", "ba", "bab", "c", "ca"};
+    std::vector<std::string> texts;
+    for (int i = 0; i < 200; ++i) {
+        auto text = words[rng() % words.size()];
+        if (rng() % 2) {
+            text += " " + words[rng() % words.size()];
+        }
+        texts.push_back(text);
+    }
+    utils::SuggestTrie<TopK> trie;
+    utils::SuggestTrie<TopK> bulk;
+    bulk.beginBulk();
+    std::vector<std::string> order; // 条目首次出现的顺序, 同权重时靠前的在前
+    std::vector<int64_t> weight;
+    for (int step = 0; step < 3000; ++step) {
+        auto const& text = texts[rng() % texts.size()];
+        int64_t delta = static_cast<int64_t>(rng() % 7) - 2;
+        trie.add(0, text, delta);
+        bulk.add(0, text, delta);
+        auto it = std::find(order.begin(), order.end(), text);
+        if (it == order.end()) {
+            if (delta <= 0) {
+                continue;
+            }
+            order.push_back(text);
+            weight.push_back(0);
+            it = order.end() - 1;
+        }
+        auto& w = weight[static_cast<std::size_t>(it - order.begin())];
+        w = std::max<int64_t>(w + delta, 0);
+    }
+    bulk.endBulk();
+    for (std::string prefix : {"a", "ab", "b", "ba", "c", "ca", "abc", "bab", "x"}) {
+        std::vector<std::size_t> hits;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            auto const& text = order[i];
+            bool isMatch = weight[i] > 0 && text.starts_with(prefix);
+            if (auto pos = text.find(' '); pos != std::string::npos) {
+                isMatch |= weight[i] > 0 && std::string_view{text}.substr(pos + 1).starts_with(prefix);
+            }
+            if (isMatch) {
+                hits.push_back(i);
+            }
+        }
+        std::stable_sort(hits.begin(), hits.end(), [&](std::size_t a, std::size_t b) {
+            return weight[a] > weight[b];
+        });
+        Texts expected;
+        for (std::size_t i = 0; i < std::min(hits.size(), TopK); ++i) {
+            expected.push_back(order[hits[i]]);
+        }
+        HX_CHECK(textsOf(trie.suggest(prefix, TopK)) == expected);
+        HX_CHECK(textsOf(bulk.suggest(prefix, TopK)) == expected);
+    }
+}
+
+} // namespace
+
+int main() {
+    testRankByWeight();
+    testAlternativeKeys();
+    testWeightDecrease();
+    testAgainstBruteForce();
+    std::puts("SuggestTrieTest ok");
+}
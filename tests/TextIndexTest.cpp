@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <utils/TextIndex.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+using Index = utils::TextIndex<uint64_t, 2>;
+
+// (歌名, 歌手)
+void add(Index& idx, uint64_t id, std::string title, std::string artist) {
+    idx.insert(id, [&](auto&& sink) {
+        sink(0, title);
+        sink(1, artist);
+    });
+}
+
+std::vector<uint64_t> idsOf(std::vector<utils::TextHit<uint64_t>> const& hits) {
+    std::vector<uint64_t> res;
+    for (auto const& hit : hits) {
+        res.push_back(hit.id);
+    }
+    return res;
+}
+
+void testAllTermsMustMatch() {
+    Index idx;
+    add(idx, 1, "Sunny Day", "Alice");
+    add(idx, 2, "Rainy Day", "Bob");
+    add(idx, 3, "Sunny Night", "Carol");
+    HX_CHECK((idsOf(idx.search("sunny day", 10)) == std::vector<uint64_t>{1}));
+    HX_CHECK((idsOf(idx.search("day", 10)) == std::vector<uint64_t>{1, 2}));
+    HX_CHECK(idx.search("sunny snow", 10).empty());
+    HX_CHECK(idx.search("", 10).empty());
+    HX_CHECK(idx.search("day", 0).empty());
+}
+
+void testCaseAndWidthFolding() {
+    Index idx;
+    add(idx, 1, "Hello World", "");
+    HX_CHECK((idsOf(idx.search("HELLO", 10)) == std::vector<uint64_t>{1}));
+    // 全角字母按半角处理
+    HX_CHECK((idsOf(idx.search("ｗｏｒｌｄ", 10)) == std::vector<uint64_t>{1}));
+}
+
+void testFieldWeight() {
+    Index idx;
+    // 命中歌手字段的先写入, 命中歌名字段的得分更高, 应排在前面
+    add(idx, 1, "Other", "Moon");
+    add(idx, 2, "Moon", "Other");
+    auto hits = idx.search("moon", 10);
+    HX_CHECK((idsOf(hits) == std::vector<uint64_t>{2, 1}));
+    HX_CHECK(hits[0].score > hits[1].score);
+}
+
+void testTieKeepsInsertOrder() {
+    Index idx;
+    for (uint64_t id = 10; id > 0; --id) {
+        add(idx, id, "Same Title", "");
+    }
+    auto ids = idsOf(idx.search("same", 3));
+    HX_CHECK((ids == std::vector<uint64_t>{10, 9, 8}));
+}
+
+void testCjkBigram() {
+    Index idx;
+    add(idx, 1, "晴天娃娃", "");
+    add(idx, 2, "天气", "");
+    HX_CHECK((idsOf(idx.search("晴天", 10)) == std::vector<uint64_t>{1}));
+    HX_CHECK((idsOf(idx.search("娃娃", 10)) == std::vector<uint64_t>{1}));
+    HX_CHECK(idx.search("晴气", 10).empty());
+}
+
+void testUpdateAndErase() {
+    Index idx;
+    add(idx, 1, "Old Name", "");
+    add(idx, 1, "New Name", "");
+    HX_CHECK(idx.size() == 1);
+    HX_CHECK(idx.search("old", 10).empty());
+    HX_CHECK((idsOf(idx.search("new", 10)) == std::vector<uint64_t>{1}));
+    idx.erase(1);
+    idx.erase(42);
+    HX_CHECK(idx.size() == 0);
+    HX_CHECK(idx.search("name", 10).empty());
+}
+
+// 大量文档: 跳块与删除后的重建都不应改变结果
+void testManyDocsAndCompact() {
+    Index idx;
+    constexpr uint64_t N = 5000;
+    for (uint64_t id = 1; id <= N; ++id) {
+        // 每 7 首的歌名含 rare, 其余只在歌手字段含 common
+        add(idx, id, id % 7 == 0 ? "common rare" : "track", "common");
+    }
+    auto top = idsOf(idx.search("common", 5));
+    HX_CHECK((top == std::vector<uint64_t>{7, 14, 21, 28, 35}));
+    HX_CHECK(idx.search("common rare", N).size() == N / 7);
+    for (uint64_t id = 1; id <= N; ++id) {
+        if (id % 7 != 0) {
+            idx.erase(id);
+        }
+    }
+    // 删除过半, 期间已自动重建
+    HX_CHECK(idx.size() == N / 7);
+    HX_CHECK(idx.search("track", 10).empty());
+    HX_CHECK(idx.search("common", N).size() == N / 7);
+    HX_CHECK((idsOf(idx.search("rare", 3)) == std::vector<uint64_t>{7, 14, 21}));
+}
+
+} // namespace
+
+int main() {
+    testAllTermsMustMatch();
+    testCaseAndWidthFolding();
+    testFieldWeight();
+    testTieKeepsInsertOrder();
+    testCjkBigram();
+    testUpdateAndErase();
+    testManyDocsAndCompact();
+    std::puts("TextIndexTest ok");
+}
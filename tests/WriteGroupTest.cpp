@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2025 Heng_Xin. All rights reserved.
+ *
+ * This file is part of HX-Music.
+ *
+ * HX-Music is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HX-Music is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with HX-Music.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dao/ShardedInMemoryDAO.hpp>
+#include <dao/ThreadSafeInMemoryDAO.hpp>
+#include <dao/WriteGroup.hpp>
+
+#include <Check.hpp>
+
+using namespace HX;
+
+namespace {
+
+// 两个库中的表, 表名不能重复
+struct GroupUser {
+    db::PrimaryKey<uint64_t> id;
+    std::string name;
+    int32_t score;
+};
+
+struct GroupItem {
+    db::PrimaryKey<uint64_t> id;
+    std::string title;
+    uint64_t ownerId;
+};
+
+using UserDAO = dao::ThreadSafeInMemoryDAO<GroupUser>;
+using ItemDAO = dao::ShardedInMemoryDAO<GroupItem, 4>;
+
+std::string tmpPath(std::string const& name) {
+    auto path = (std::filesystem::temp_directory_path() / ("HXWriteGroupTest." + name)).string();
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    return path;
+}
+
+db::SQLiteOpenOptions groupOptions() {
+    db::SQLiteOpenOptions opts{};
+    opts.busyTimeoutMs = 5000;
+    return opts;
+}
+
+/**
+ * @brief 一个写组与组内的两个 DAO
+ */
+struct Fixture {
+    std::string userPath;
+    std::string itemPath;
+    std::shared_ptr<dao::WriteGroup> group;
+    UserDAO users;
+    ItemDAO items;
+
+    explicit Fixture(std::string const& name)
+        : userPath{tmpPath(name + ".user.db")}
+        , itemPath{tmpPath(name + ".item.db")}
+        , group{std::make_shared<dao::WriteGroup>(
+            std::vector<std::string>{userPath, itemPath}, groupOptions())}
+        , users{db::SQLiteDB{userPath, group->getOpenOptions()}, dao::WriteMode::WriteThrough, {}, group}
+        , items{db::SQLiteDB{itemPath, group->getOpenOptions()}, dao::WriteMode::WriteThrough, {}, group}
+    {}
+
+    ~Fixture() noexcept {
+        group->flush();
+    }
+
+    std::size_t userCnt() const {
+        return users.lockSelect([](UserDAO::MapType const& mp) {
+            return mp.size();
+        });
+    }
+
+    std::size_t itemCnt() const {
+        return items.lockSelect([](ItemDAO::MapType const& mp) {
+            return mp.size();
+        });
+    }
+
+    std::vector<GroupUser> dbUsers() const {
+        group->flush();
+        return db::SQLiteDB{userPath}.queryAll<GroupUser>();
+    }
+
+    std::vector<GroupItem> dbItems() const {
+        group->flush();
+        return db::SQLiteDB{itemPath}.queryAll<GroupItem>();
+    }
+};
+
+// 组内的库总以回滚日志模式打开, 跨库的提交才是原子的
+void testJournalMode() {
+    auto path = tmpPath("journal.db");
+    db::SQLiteOpenOptions wal{};
+    wal.journalMode = db::JournalMode::Wal;
+    HX_CHECK_THROW((dao::WriteGroup{{path}, wal}), std::runtime_error);
+    HX_CHECK_THROW((dao::WriteGroup{std::vector<std::string>{}}), std::runtime_error);
+    // 之前以 WAL 打开过的库会被切换回来
+    { db::SQLiteDB{path, wal}; }
+    dao::WriteGroup group{{path}, groupOptions()};
+    HX_CHECK(group.getOpenOptions().journalMode == db::JournalMode::Delete);
+    HX_CHECK(group.contains(path) && !group.contains(path + ".other"));
+    group.flush();
+    HX_CHECK(!std::filesystem::exists(path + "-wal"));
+}
+
+// 抛出异常的事务: 内存与数据库都保持不变
+void testThrowingTransaction() {
+    Fixture fx{"throw"};
+    auto u1 = fx.users.add(GroupUser{{}, "alice", 1}).id.val;
+    auto u2 = fx.users.add(GroupUser{{}, "bob", 2}).id.val;
+    auto i1 = fx.items.add(GroupItem{{}, "first", u1}).id.val;
+    auto i2 = fx.items.add(GroupItem{{}, "second", u2}).id.val;
+    HX_CHECK_THROW(fx.group->transaction([&] {
+        fx.users.add(GroupUser{{}, "carol", 3});
+        fx.users.addMany({GroupUser{{}, "dave", 4}, GroupUser{{}, "eve", 5}});
+        fx.users.update(GroupUser{{u1}, "alice2", 10});
+        fx.users.updateBy(u2, db::FieldPair<&GroupUser::score>{20});
+        fx.users.del(u2);
+        fx.items.add(GroupItem{{}, "third", u1});
+        fx.items.addMany({GroupItem{{}, "fourth", u1}, GroupItem{{}, "fifth", u1}});
+        fx.items.update(GroupItem{{i1}, "first2", u2});
+        fx.items.updateBy(i2, db::FieldPair<&GroupItem::title>{std::string{"second2"}});
+        fx.items.del(i1);
+        throw std::runtime_error{"boom"};
+    }), std::runtime_error);
+    HX_CHECK(!dao::UndoLog::isActive());
+
+    HX_CHECK(fx.userCnt() == 2 && fx.itemCnt() == 2);
+    HX_CHECK(fx.users.at(u1).name == "alice" && fx.users.at(u1).score == 1);
+    HX_CHECK(fx.users.at(u2).name == "bob" && fx.users.at(u2).score == 2);
+    HX_CHECK(fx.items.at(i1).title == "first" && fx.items.at(i1).ownerId == u1);
+    HX_CHECK(fx.items.at(i2).title == "second");
+
+    auto users = fx.dbUsers();
+    auto items = fx.dbItems();
+    HX_CHECK(users.size() == 2 && items.size() == 2);
+    for (auto const& row : users) {
+        auto mem = fx.users.at(row.id.val);
+        HX_CHECK(mem.name == row.name && mem.score == row.score);
+    }
+    for (auto const& row : items) {
+        auto mem = fx.items.at(row.id.val);
+        HX_CHECK(mem.title == row.title && mem.ownerId == row.ownerId);
+    }
+
+    // 成功的事务照常生效
+    fx.group->transaction([&] {
+        fx.users.updateBy(u1, db::FieldPair<&GroupUser::score>{100});
+        fx.items.del(i2);
+    });
+    HX_CHECK(fx.users.at(u1).score == 100 && fx.itemCnt() == 1);
+    HX_CHECK(fx.dbItems().size() == 1);
+}
+
+// 嵌套: 内层合并到最外层; 内层抛出而外层捕获时不回滚, 由最外层决定
+void testNested() {
+    Fixture fx{"nested"};
+    auto u1 = fx.users.add(GroupUser{{}, "alice", 1}).id.val;
+    fx.group->transaction([&] {
+        fx.users.updateBy(u1, db::FieldPair<&GroupUser::score>{2});
+        try {
+            dao::UndoLog::run([&] {
+                fx.items.add(GroupItem{{}, "inner", u1});
+                throw std::runtime_error{"inner"};
+            });
+        } catch (std::runtime_error const&) {
+        }
+        HX_CHECK(dao::UndoLog::isActive());
+    });
+    HX_CHECK(fx.users.at(u1).score == 2 && fx.itemCnt() == 1);
+
+    HX_CHECK_THROW(fx.group->transaction([&] {
+        fx.users.updateBy(u1, db::FieldPair<&GroupUser::score>{3});
+        fx.group->transaction([&] {
+            fx.items.add(GroupItem{{}, "nested", u1});
+            fx.users.del(u1);
+        });
+        dao::UndoLog::run([&] {
+            fx.items.addMany({GroupItem{{}, "a", u1}, GroupItem{{}, "b", u1}});
+        });
+        throw std::runtime_error{"outer"};
+    }), std::runtime_error);
+    HX_CHECK(fx.users.at(u1).score == 2 && fx.itemCnt() == 1);
+    HX_CHECK(fx.dbUsers().size() == 1 && fx.dbItems().size() == 1);
+    HX_CHECK(fx.dbUsers().front().score == 2);
+}
+
+// 组内任一操作在数据库中失败时, 整组回滚; 组外的操作不受影响
+void testFailingOpRollsBackGroup() {
+    Fixture fx{"fail"};
+    auto u1 = fx.users.add(GroupUser{{}, "alice", 1}).id.val;
+    auto before = fx.group->getStats().failCnt;
+    fx.group->transaction([&] {
+        fx.users.updateBy(u1, db::FieldPair<&GroupUser::score>{2});
+        fx.items.add(GroupItem{{}, "lost", u1});
+        fx.group->queue()->push([](db::SQLiteDB&) {
+            throw std::runtime_error{"constraint"};
+        });
+    });
+    fx.users.add(GroupUser{{}, "bob", 3});
+    fx.group->flush();
+    // 组内的 3 个操作都计为失败
+    HX_CHECK(fx.group->getStats().failCnt == before + 3);
+    auto users = fx.dbUsers();
+    HX_CHECK(users.size() == 2);
+    for (auto const& row : users) {
+        HX_CHECK(row.id.val != u1 || row.score == 1);
+    }
+    HX_CHECK(fx.dbItems().empty());
+}
+
+// flush 要等到未结束的事务推入结束标记、整组提交之后才返回
+void testFlushWaitsForGroupEnd() {
+    Fixture fx{"flush"};
+    std::latch inside{1};
+    std::promise<void> release;
+    std::jthread writer{[&] {
+        fx.group->transaction([&] {
+            fx.users.add(GroupUser{{}, "alice", 1});
+            inside.count_down();
+            release.get_future().wait();
+            fx.items.add(GroupItem{{}, "item", 1});
+        });
+    }};
+    inside.wait();
+    auto flushed = std::async(std::launch::async, [&] {
+        fx.group->flush();
+    });
+    HX_CHECK(flushed.wait_for(std::chrono::milliseconds{200}) == std::future_status::timeout);
+    HX_CHECK(db::SQLiteDB{fx.userPath}.queryAll<GroupUser>().empty());
+    release.set_value();
+    flushed.get();
+    HX_CHECK(db::SQLiteDB{fx.userPath}.queryAll<GroupUser>().size() == 1);
+    HX_CHECK(db::SQLiteDB{fx.itemPath}.queryAll<GroupItem>().size() == 1);
+}
+
+// 暂停期间不提交, 其他连接可以持有读事务; 恢复后照常提交
+void testPause() {
+    Fixture fx{"pause"};
+    fx.users.add(GroupUser{{}, "alice", 1});
+    fx.group->flush();
+    {
+        auto paused = fx.group->pause();
+        auto stats = fx.group->getStats();
+        fx.users.add(GroupUser{{}, "bob", 2});
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        HX_CHECK(fx.group->getStats().doneCnt == stats.doneCnt);
+        HX_CHECK(db::SQLiteDB{fx.userPath}.queryAll<GroupUser>().size() == 1);
+    }
+    HX_CHECK(fx.dbUsers().size() == 2);
+    HX_CHECK(fx.group->getStats().failCnt == 0);
+}
+
+} // namespace
+
+int main() {
+    testJournalMode();
+    testThrowingTransaction();
+    testNested();
+    testFailingOpRollsBackGroup();
+    testFlushWaitsForGroupEnd();
+    testPause();
+}